@@ -4,11 +4,13 @@
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "gpio_events.h"
 
 #define LED_HIGH_PIN GPIO_NUM_2
 #define LED_MED_PIN GPIO_NUM_4
 #define LED_LOW_PIN GPIO_NUM_5
 #define BUTTON_PIN GPIO_NUM_0
+#define BUTTON_DEBOUNCE_MS 50
 
 static const char *TAG = "LAB1_PRIORITY";
 
@@ -18,6 +20,7 @@ volatile uint32_t high_task_count = 0;
 volatile uint32_t med_task_count = 0;
 volatile uint32_t low_task_count = 0;
 volatile bool shared_resource_busy = false;
+int button_slot = -1;
 
 // ---------------- HIGH PRIORITY TASK ----------------
 void high_priority_task(void *pvParameters)
@@ -89,7 +92,8 @@ void control_task(void *pvParameters)
     ESP_LOGI(TAG, "Control Task started");
     while (1)
     {
-        if (gpio_get_level(BUTTON_PIN) == 0)
+        // Sleeps until the button press is delivered by the GPIO event handler
+        if (gev_wait(0, portMAX_DELAY) & GEV_BIT(button_slot))
         {
             if (!priority_test_running)
             {
@@ -115,8 +119,9 @@ void control_task(void *pvParameters)
                              (float)low_task_count / total * 100);
                 }
             }
+            // Presses made while the test ran do not start another one
+            gev_wait(0, 0);
         }
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
 
@@ -209,12 +214,17 @@ void app_main(void)
         .pull_down_en = 0};
     gpio_config(&btn_conf);
 
+    gev_init(6); // above every task in this lab
+    button_slot = gev_add_pin(BUTTON_PIN, true, BUTTON_DEBOUNCE_MS);
+
     // Create tasks
     TaskHandle_t low_handle = NULL;
     xTaskCreate(high_priority_task, "High", 3072, NULL, 5, NULL);
     xTaskCreate(medium_priority_task, "Med", 3072, NULL, 3, NULL);
     xTaskCreate(low_priority_task, "Low", 3072, NULL, 1, &low_handle);
-    xTaskCreate(control_task, "Control", 3072, NULL, 4, NULL);
+    TaskHandle_t control_handle = NULL;
+    xTaskCreate(control_task, "Control", 3072, NULL, 4, &control_handle);
+    gev_subscribe_task(button_slot, GEV_PRESS, control_handle, 0);
 
     // Round robin test
     xTaskCreate(equal_priority_task, "Equal1", 2048, (void *)1, 2, NULL);
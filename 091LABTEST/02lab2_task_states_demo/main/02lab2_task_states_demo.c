@@ -4,6 +4,8 @@
 #include "freertos/semphr.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "fast_signal.h"
+#include "gpio_events.h"
 
 #define LED_RUNNING GPIO_NUM_2
 #define LED_READY GPIO_NUM_4
@@ -12,12 +14,15 @@
 
 #define BUTTON1_PIN GPIO_NUM_0
 #define BUTTON2_PIN GPIO_NUM_35
+#define BUTTON_DEBOUNCE_MS 50
 
 static const char *TAG = "TASK_STATES";
 
 TaskHandle_t state_demo_task_handle = NULL;
 TaskHandle_t control_task_handle = NULL;
-SemaphoreHandle_t demo_semaphore = NULL;
+fsig_t demo_signal;  // single waiter (StateDemo) -> task notification
+int button1_slot = -1;
+int button2_slot = -1;
 
 // สำหรับนับจำนวนการเปลี่ยนสถานะ
 volatile uint32_t state_changes[5] = {0};
@@ -93,16 +98,16 @@ void state_demo_task(void *pvParameters) {
         update_state_display(current_state);
         taskYIELD();
 
-        ESP_LOGI(TAG, "Task entering Blocked state (waiting semaphore)");
+        ESP_LOGI(TAG, "Task entering Blocked state (waiting for signal)");
         current_state = eBlocked;
         count_state_change(prev_state, current_state);
         prev_state = current_state;
         update_state_display(current_state);
 
-        if (xSemaphoreTake(demo_semaphore, pdMS_TO_TICKS(2000)) == pdTRUE) {
-            ESP_LOGI(TAG, "Semaphore received!");
+        if (fsig_wait(&demo_signal, pdMS_TO_TICKS(2000))) {
+            ESP_LOGI(TAG, "Signal received (%s)!", fsig_mode_name(&demo_signal));
         } else {
-            ESP_LOGI(TAG, "Timeout waiting semaphore");
+            ESP_LOGI(TAG, "Timeout waiting for signal");
         }
 
         vTaskDelay(pdMS_TO_TICKS(1000));
@@ -119,15 +124,19 @@ void ready_state_demo_task(void *pvParameters) {
 void control_task(void *pvParameters) {
     ESP_LOGI(TAG, "Control Task started");
     bool suspended = false;
-    int control_cycle = 0;
     static bool external_deleted = false;
+    const TickType_t report_period = pdMS_TO_TICKS(3000);
+    TickType_t started = xTaskGetTickCount();
+    TickType_t next_report = started + report_period;
 
     while (1) {
-        control_cycle++;
+        // Button presses wake us straight away; the timeout drives the housekeeping below
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = (TickType_t)(next_report - now) <= report_period ? next_report - now : 0;
+        uint32_t fired = gev_wait(0, wait);
 
         // Button1: Suspend/Resume
-        if (gpio_get_level(BUTTON1_PIN) == 0) {
-            vTaskDelay(pdMS_TO_TICKS(50));
+        if (fired & GEV_BIT(button1_slot)) {
             if (!suspended) {
                 ESP_LOGW(TAG, "Suspending demo task");
                 vTaskSuspend(state_demo_task_handle);
@@ -139,32 +148,29 @@ void control_task(void *pvParameters) {
                 gpio_set_level(LED_SUSPENDED, 0);
                 suspended = false;
             }
-            while (gpio_get_level(BUTTON1_PIN) == 0) vTaskDelay(pdMS_TO_TICKS(10));
         }
 
-        // Button2: Give semaphore
-        if (gpio_get_level(BUTTON2_PIN) == 0) {
-            vTaskDelay(pdMS_TO_TICKS(50));
-            ESP_LOGW(TAG, "GIVING SEMAPHORE");
-            xSemaphoreGive(demo_semaphore);
-            while (gpio_get_level(BUTTON2_PIN) == 0) vTaskDelay(pdMS_TO_TICKS(10));
+        // Button2: Give the signal
+        if (fired & GEV_BIT(button2_slot)) {
+            ESP_LOGW(TAG, "GIVING SIGNAL");
+            fsig_give(&demo_signal);
         }
 
         // Delete external task after 15 sec
         extern TaskHandle_t external_delete_handle;
-        if (control_cycle == 150 && !external_deleted) {
+        now = xTaskGetTickCount();
+        if (!external_deleted && now - started >= pdMS_TO_TICKS(15000)) {
             ESP_LOGW(TAG, "Deleting external task");
             vTaskDelete(external_delete_handle);
             external_deleted = true;
         }
 
         // Report
-        if (control_cycle % 30 == 0) {
+        if ((TickType_t)(now - next_report) < report_period) {
             eTaskState st = eTaskGetState(state_demo_task_handle);
             ESP_LOGI(TAG, "StateDemo Task = %s", get_state_name(st));
+            next_report += report_period;
         }
-
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
 
@@ -221,11 +227,17 @@ void app_main(void) {
     };
     gpio_config(&btn_conf);
 
-    demo_semaphore = xSemaphoreCreateBinary();
+    gev_init(5); // above every task in this lab
+    button1_slot = gev_add_pin(BUTTON1_PIN, true, BUTTON_DEBOUNCE_MS);
+    button2_slot = gev_add_pin(BUTTON2_PIN, true, BUTTON_DEBOUNCE_MS);
+
+    fsig_create(&demo_signal, 1, 0);
 
     xTaskCreate(state_demo_task, "StateDemo", 4096, NULL, 3, &state_demo_task_handle);
     xTaskCreate(ready_state_demo_task, "ReadyDemo", 2048, NULL, 3, NULL);
     xTaskCreate(control_task, "Control", 3072, NULL, 4, &control_task_handle);
+    gev_subscribe_task(button1_slot, GEV_PRESS, control_task_handle, 0);
+    gev_subscribe_task(button2_slot, GEV_PRESS, control_task_handle, 0);
     xTaskCreate(system_monitor_task, "Monitor", 4096, NULL, 1, NULL);
 
     static int self_delete_time = 10;
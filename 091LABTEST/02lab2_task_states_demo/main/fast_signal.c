@@ -0,0 +1,83 @@
+#include <string.h>
+#include "esp_attr.h"
+#include "fast_signal.h"
+
+bool fsig_create(fsig_t *s, int max_waiters, UBaseType_t channel) {
+    memset(s, 0, sizeof(*s));
+    s->channel = channel;
+
+    if (max_waiters == 1 && channel < configTASK_NOTIFICATION_ARRAY_ENTRIES) {
+        s->mode = FSIG_NOTIFY;
+        return true;
+    }
+    s->mode = FSIG_SEMAPHORE;
+    s->sem = xSemaphoreCreateBinary();
+    return s->sem != NULL;
+}
+
+void fsig_delete(fsig_t *s) {
+    if (s->sem)
+        vSemaphoreDelete(s->sem);
+    memset(s, 0, sizeof(*s));
+}
+
+// Before the waiter is bound a give only sets `early`. The waiter may bind
+// itself and check `early` in between, so look at the owner again: if it is
+// bound now and `early` is still there, take it back and notify instead.
+// Both sides store then load with SEQ_CST, so at least one sees the other.
+static TaskHandle_t IRAM_ATTR give_early(fsig_t *s) {
+    __atomic_store_n(&s->early, 1, __ATOMIC_SEQ_CST);
+    TaskHandle_t owner = __atomic_load_n(&s->owner, __ATOMIC_SEQ_CST);
+    if (owner && __atomic_exchange_n(&s->early, 0, __ATOMIC_ACQ_REL))
+        return owner;
+    return NULL;
+}
+
+bool fsig_give(fsig_t *s) {
+    if (s->mode == FSIG_SEMAPHORE)
+        return xSemaphoreGive(s->sem) == pdTRUE;
+
+    TaskHandle_t owner = __atomic_load_n(&s->owner, __ATOMIC_ACQUIRE);
+    if (!owner)
+        owner = give_early(s);
+    if (owner)
+        xTaskNotifyGiveIndexed(owner, s->channel);
+    return true;
+}
+
+void IRAM_ATTR fsig_give_from_isr(fsig_t *s, BaseType_t *woken) {
+    if (s->mode == FSIG_SEMAPHORE) {
+        xSemaphoreGiveFromISR(s->sem, woken);
+        return;
+    }
+
+    TaskHandle_t owner = __atomic_load_n(&s->owner, __ATOMIC_ACQUIRE);
+    if (!owner)
+        owner = give_early(s);
+    if (owner)
+        vTaskNotifyGiveIndexedFromISR(owner, s->channel, woken);
+}
+
+// Taking with clear-on-exit keeps binary semantics: several gives before
+// a wait still count as one event
+bool fsig_wait(fsig_t *s, TickType_t timeout) {
+    if (s->mode == FSIG_SEMAPHORE)
+        return xSemaphoreTake(s->sem, timeout) == pdTRUE;
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (s->owner == NULL)
+        __atomic_store_n(&s->owner, self, __ATOMIC_SEQ_CST);
+    configASSERT(s->owner == self);  // created for one waiter only
+
+    if (__atomic_exchange_n(&s->early, 0, __ATOMIC_ACQ_REL))
+        return true;
+    return ulTaskNotifyTakeIndexed(s->channel, pdTRUE, timeout) > 0;
+}
+
+const char *fsig_mode_name(const fsig_t *s) {
+    return s->mode == FSIG_NOTIFY ? "notify" : "semaphore";
+}
+
+size_t fsig_kernel_bytes(const fsig_t *s) {
+    return s->mode == FSIG_SEMAPHORE ? sizeof(StaticSemaphore_t) : 0;
+}
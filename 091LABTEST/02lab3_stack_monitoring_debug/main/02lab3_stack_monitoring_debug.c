@@ -5,6 +5,7 @@
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "stack_sampler.h"
 
 #define LED_OK GPIO_NUM_2
 #define LED_WARNING GPIO_NUM_4
@@ -17,6 +18,7 @@ static const char *TAG = "STACK_MONITOR";
 TaskHandle_t light_task_handle = NULL;
 TaskHandle_t medium_task_handle = NULL;
 TaskHandle_t heavy_task_handle = NULL;
+TaskHandle_t recursion_task_handle = NULL;
 
 // ====================== TASKS ======================
 
@@ -89,6 +91,8 @@ void stack_monitor_task(void *pvParameters)
             gpio_set_level(LED_WARNING, 0);
         }
 
+        stack_sampler_report();
+
         ESP_LOGI(TAG, "Free heap: %d bytes", esp_get_free_heap_size());
         ESP_LOGI(TAG, "Min free heap: %d bytes", esp_get_minimum_free_heap_size());
 
@@ -138,6 +142,7 @@ void heavy_stack_task(void *pvParameters)
     while (1)
     {
         cycle++;
+        STACK_PROBE();
         char buf1[1024];
         int nums[200];
         char buf2[512];
@@ -162,6 +167,7 @@ void heavy_stack_task(void *pvParameters)
 // Recursive demo
 void recursive_function(int depth)
 {
+    STACK_PROBE();
     char local[100];
     snprintf(local, sizeof(local), "Recursion depth %d", depth);
     ESP_LOGI(TAG, "%s", local);
@@ -225,6 +231,18 @@ void optimized_heavy_task(void *pvParameters)
     }
 }
 
+// Early warning from the sampler, runs before the overflow hook would fire
+void stack_early_warning(const stack_slot_t *slot, uint32_t predicted_ms)
+{
+    if (predicted_ms == UINT32_MAX)
+        ESP_LOGW(TAG, "EARLY WARNING: %s at %lu/%lu bytes",
+                 slot->name, slot->depth, slot->stack_size);
+    else
+        ESP_LOGW(TAG, "EARLY WARNING: %s at %lu/%lu bytes, overflow predicted in %lu ms",
+                 slot->name, slot->depth, slot->stack_size, predicted_ms);
+    gpio_set_level(LED_WARNING, 1);
+}
+
 // Stack overflow hook
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
 {
@@ -251,10 +269,15 @@ void app_main(void)
 
     ESP_LOGI(TAG, "GPIO2 = OK, GPIO4 = Warning");
 
+    stack_sampler_init(stack_early_warning);
+
     xTaskCreate(light_stack_task, "LightTask", 1024, NULL, 2, &light_task_handle);
     xTaskCreate(medium_stack_task, "MediumTask", 2048, NULL, 2, &medium_task_handle);
     xTaskCreate(heavy_stack_task, "HeavyTask", 2048, NULL, 2, &heavy_task_handle);
-    xTaskCreate(recursion_demo_task, "RecursionDemo", 3072, NULL, 1, NULL);
+    xTaskCreate(recursion_demo_task, "RecursionDemo", 3072, NULL, 1, &recursion_task_handle);
     xTaskCreate(stack_monitor_task, "StackMonitor", 4096, NULL, 3, NULL);
     xTaskCreate(optimized_heavy_task, "OptHeavy", 3072, NULL, 2, NULL);
+
+    stack_sampler_register(heavy_task_handle, 2048);
+    stack_sampler_register(recursion_task_handle, 3072);
 }
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "stack_sampler.h"
+
+static const char *TAG = "STACK_SAMPLER";
+
+static stack_slot_t slots[STACK_SAMPLER_MAX_TASKS];
+static volatile int slot_count = 0;
+static stack_warning_cb_t warning_cb = NULL;
+
+static uint32_t probe_cost_ns = 0;
+static int64_t sampler_busy_us = 0;   // 64-bit: read and written under busy_lock
+static portMUX_TYPE busy_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t sampler_start_us = 0;
+
+// ====================== PROBE ======================
+
+// Called from the task being measured: one handle compare per slot and
+// one store, so the cost stays flat no matter how deep the task recurses.
+void stack_sampler_probe(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    int count = slot_count;
+
+    for (int i = 0; i < count; i++)
+    {
+        stack_slot_t *s = &slots[i];
+        if (s->handle == self)
+        {
+            uint32_t depth = s->stack_top - (uint8_t *)esp_cpu_get_sp();
+            if (depth > s->window_peak)
+                s->window_peak = depth;
+            s->probes++;
+            return;
+        }
+    }
+}
+
+// Worst case: every slot is scanned and the match is the last one
+static void calibrate_probe_cost(void)
+{
+    memset(slots, 0, sizeof(slots));
+    slots[STACK_SAMPLER_MAX_TASKS - 1].handle = xTaskGetCurrentTaskHandle();
+    slots[STACK_SAMPLER_MAX_TASKS - 1].stack_top = (uint8_t *)esp_cpu_get_sp() + 4096;
+    slot_count = STACK_SAMPLER_MAX_TASKS;
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < STACK_SAMPLER_CALIBRATION_RUNS; i++)
+        stack_sampler_probe();
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    probe_cost_ns = (uint32_t)(elapsed * 1000 / STACK_SAMPLER_CALIBRATION_RUNS);
+
+    slot_count = 0;
+    memset(slots, 0, sizeof(slots));
+}
+
+// ====================== SAMPLER ======================
+
+static void sample_slot(stack_slot_t *s)
+{
+    // One exchange, so a probe landing between read and reset is not lost
+    uint32_t depth = __atomic_exchange_n(&s->window_peak, 0, __ATOMIC_RELAXED);
+
+    if (depth == 0)
+        return; // task did not probe during this window
+
+    if (s->depth != 0)
+    {
+        int32_t delta = (int32_t)depth - (int32_t)s->depth;
+        s->trend += (delta - s->trend) / 4;
+    }
+    s->depth = depth;
+    if (depth > s->peak)
+        s->peak = depth;
+
+    uint32_t remaining = depth < s->stack_size ? s->stack_size - depth : 0;
+    uint32_t predicted_ms = UINT32_MAX;
+    if (s->trend > 0)
+        predicted_ms = remaining / s->trend * STACK_SAMPLER_PERIOD_MS;
+
+    bool too_deep = depth * 100 >= s->stack_size * STACK_SAMPLER_WARN_PERCENT;
+    bool too_fast = predicted_ms < STACK_SAMPLER_HORIZON_MS;
+
+    if ((too_deep || too_fast) && !s->warned)
+    {
+        s->warned = true;
+        s->warnings++;
+        if (warning_cb != NULL)
+            warning_cb(s, predicted_ms);
+    }
+    else if (!too_deep && !too_fast)
+    {
+        s->warned = false;
+    }
+}
+
+static void stack_sampler_task(void *pvParameters)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1)
+    {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(STACK_SAMPLER_PERIOD_MS));
+
+        int64_t start = esp_timer_get_time();
+        int count = slot_count;
+        for (int i = 0; i < count; i++)
+            sample_slot(&slots[i]);
+        int64_t took = esp_timer_get_time() - start;
+        taskENTER_CRITICAL(&busy_lock);
+        sampler_busy_us += took;
+        taskEXIT_CRITICAL(&busy_lock);
+    }
+}
+
+// ====================== API ======================
+
+void stack_sampler_init(stack_warning_cb_t on_warning)
+{
+    calibrate_probe_cost();
+    warning_cb = on_warning;
+    sampler_start_us = esp_timer_get_time();
+
+    xTaskCreate(stack_sampler_task, "StackSampler", 2048, NULL, STACK_SAMPLER_PRIORITY, NULL);
+    ESP_LOGI(TAG, "Sampler running every %d ms, probe cost %lu ns",
+             STACK_SAMPLER_PERIOD_MS, probe_cost_ns);
+}
+
+bool stack_sampler_register(TaskHandle_t handle, uint32_t stack_size)
+{
+    if (handle == NULL || slot_count >= STACK_SAMPLER_MAX_TASKS)
+        return false;
+
+    stack_slot_t *s = &slots[slot_count];
+    memset(s, 0, sizeof(*s));
+    s->name = pcTaskGetName(handle);
+    s->stack_top = pxTaskGetStackStart(handle) + stack_size;
+    s->stack_size = stack_size;
+    s->handle = handle; // set last so a probe never sees a half-filled slot
+    slot_count++;
+    return true;
+}
+
+// Sampler task time plus probe time, as a share of one core
+float stack_sampler_overhead_percent(void)
+{
+    int64_t elapsed = esp_timer_get_time() - sampler_start_us;
+    if (elapsed <= 0)
+        return 0.0f;
+
+    uint64_t probes = 0;
+    for (int i = 0; i < slot_count; i++)
+        probes += slots[i].probes;
+
+    taskENTER_CRITICAL(&busy_lock);
+    int64_t sampler_us = sampler_busy_us;
+    taskEXIT_CRITICAL(&busy_lock);
+
+    float busy_us = sampler_us + probes * probe_cost_ns / 1000.0f;
+    return busy_us * 100.0f / elapsed;
+}
+
+void stack_sampler_report(void)
+{
+    ESP_LOGI(TAG, "=== STACK DEPTH TREND ===");
+    for (int i = 0; i < slot_count; i++)
+    {
+        stack_slot_t *s = &slots[i];
+        ESP_LOGI(TAG, "%s: depth %lu / %lu bytes, peak %lu, trend %+ld B/period, warnings %lu",
+                 s->name, s->depth, s->stack_size, s->peak, s->trend, s->warnings);
+    }
+    ESP_LOGI(TAG, "Sampling overhead: %.3f%% CPU", stack_sampler_overhead_percent());
+}
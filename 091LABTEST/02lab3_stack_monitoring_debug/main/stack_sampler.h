@@ -0,0 +1,42 @@
+#ifndef STACK_SAMPLER_H
+#define STACK_SAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define STACK_SAMPLER_MAX_TASKS 8
+#define STACK_SAMPLER_PERIOD_MS 100
+#define STACK_SAMPLER_PRIORITY (configMAX_PRIORITIES - 2)
+#define STACK_SAMPLER_WARN_PERCENT 75   // warn when depth reaches this % of the stack
+#define STACK_SAMPLER_HORIZON_MS 3000   // warn when predicted overflow is closer than this
+#define STACK_SAMPLER_CALIBRATION_RUNS 10000
+
+typedef struct
+{
+    TaskHandle_t handle;
+    const char *name;
+    uint8_t *stack_top;            // highest address, stacks grow down
+    uint32_t stack_size;           // bytes, same value passed to xTaskCreate
+    volatile uint32_t window_peak; // deepest probe since the last sample
+    uint32_t probes;               // only written by the owning task
+    uint32_t depth;                // last sampled depth in bytes
+    uint32_t peak;                 // deepest depth ever sampled
+    int32_t trend;                 // EWMA of depth growth, bytes per period
+    uint32_t warnings;
+    bool warned;
+} stack_slot_t;
+
+typedef void (*stack_warning_cb_t)(const stack_slot_t *slot, uint32_t predicted_ms);
+
+void stack_sampler_init(stack_warning_cb_t on_warning);
+bool stack_sampler_register(TaskHandle_t handle, uint32_t stack_size);
+void stack_sampler_probe(void);
+float stack_sampler_overhead_percent(void);
+void stack_sampler_report(void);
+
+// Put at the entry of functions that should feed the sampler
+#define STACK_PROBE() stack_sampler_probe()
+
+#endif
@@ -6,6 +6,7 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
+#include "tqueue.h"
 
 static const char *TAG = "QUEUE_ADV";
 
@@ -25,8 +26,8 @@ typedef struct {
     uint32_t timestamp;
 } queue_message_t;
 
-// Queue handle
-QueueHandle_t xQueue;
+// Queue handle (instrumented, see tqueue.h)
+tqueue_t *xQueue;
 
 // Statistics
 typedef struct {
@@ -60,7 +61,7 @@ void sender_task(void *pvParameters) {
                  "Sender%d -> MSG#%d (P%d)", sender_id, msg.id, msg.priority);
         msg.timestamp = xTaskGetTickCount();
 
-        BaseType_t xStatus = xQueueSend(xQueue, &msg, pdMS_TO_TICKS(500));
+        BaseType_t xStatus = tqueue_send(xQueue, &msg);
 
         if (xStatus == pdPASS) {
             global_stats.sent++;
@@ -84,10 +85,10 @@ void receiver_task(void *pvParameters) {
     while (1) {
         int received_count = 0;
         // อ่านข้อความทั้งหมดที่อยู่ในคิวตอนนี้
-        while (uxQueueMessagesWaiting(xQueue) > 0 &&
+        while (tqueue_messages_waiting(xQueue) > 0 &&
                received_count < QUEUE_LENGTH) {
-            if (xQueueReceive(xQueue, &received[received_count],
-                              pdMS_TO_TICKS(200)) == pdPASS) {
+            if (tqueue_receive(xQueue, &received[received_count],
+                               pdMS_TO_TICKS(200)) == pdPASS) {
                 received_count++;
             }
         }
@@ -113,10 +114,14 @@ void receiver_task(void *pvParameters) {
 }
 
 // -------- Queue Monitor Task -------
+// Depth is only a point sample; the high-water mark and sojourn
+// histogram from tqueue_report_all() cover what happened in between.
 void queue_monitor_task(void *pvParameters) {
     while (1) {
-        UBaseType_t used = uxQueueMessagesWaiting(xQueue);
-        UBaseType_t free = uxQueueSpacesAvailable(xQueue);
+        UBaseType_t used = tqueue_messages_waiting(xQueue);
+        UBaseType_t free = QUEUE_LENGTH - used;
+        tqueue_stats_t qs;
+        tqueue_read_stats(xQueue, &qs);
 
         ESP_LOGI(TAG,
                  "\n📊 Queue Status → Used: %d / Free: %d\nSent=%lu | Received=%lu | Dropped=%lu",
@@ -125,11 +130,13 @@ void queue_monitor_task(void *pvParameters) {
                  global_stats.received,
                  global_stats.dropped);
 
+        // ■ = used now, ▣ = reached since boot (high-water), □ = never used
         printf("Queue Visualization: [");
         for (int i = 0; i < QUEUE_LENGTH; i++) {
-            printf(i < used ? "■" : "□");
+            printf(i < used ? "■" : (i < qs.high_water ? "▣" : "□"));
         }
         printf("]\n");
+        tqueue_report_all();
 
         vTaskDelay(pdMS_TO_TICKS(4000));
     }
@@ -147,11 +154,13 @@ void app_main(void) {
     gpio_set_level(LED_RECEIVER, 0);
 
     // ✅ Create Queue
-    xQueue = xQueueCreate(QUEUE_LENGTH, sizeof(queue_message_t));
+    xQueue = tqueue_create("Messages", QUEUE_LENGTH, sizeof(queue_message_t));
     if (xQueue == NULL) {
         ESP_LOGE(TAG, "❌ Failed to create queue!");
         return;
     }
+    // Senders wait up to 500 ms for space
+    tqueue_set_policy(xQueue, &(tqueue_policy_t){.kind = TQUEUE_BLOCK, .max_block = pdMS_TO_TICKS(500)});
 
     // ✅ Create Tasks
     xTaskCreate(sender_task, "Sender1", 4096, (void *)1, 2, NULL);
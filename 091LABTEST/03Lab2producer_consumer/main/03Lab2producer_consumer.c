@@ -8,6 +8,8 @@
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "esp_random.h"
+#include "tqueue.h"
+#include "shard_counter.h"
 
 static const char *TAG = "LAB2_PROD_CONS";
 
@@ -16,22 +18,42 @@ static const char *TAG = "LAB2_PROD_CONS";
 #define LED_CONSUMER GPIO_NUM_4
 #define LED_QC GPIO_NUM_5
 
-// Queue handles (แบ่งเป็นหมวดสินค้า)
-QueueHandle_t xQueueFood;
-QueueHandle_t xQueueDrink;
+// Queue handles (แบ่งเป็นหมวดสินค้า), instrumented via tqueue
+tqueue_t *xQueueFood;
+tqueue_t *xQueueDrink;
+
+// Load balancer thresholds on measured p99 sojourn time
+#define LB_ADD_SOJOURN_MS    4096
+#define LB_REMOVE_SOJOURN_MS 1024
+
+// What producers do when a category queue is full (see tqueue.h).
+// Food producers slow down while consumers lag, drinks keep the freshest.
+static const tqueue_policy_t food_policy = {
+    .kind = TQUEUE_RATE_LIMIT,
+    .max_block = pdMS_TO_TICKS(200),
+    .max_interval_us = 2000000,
+};
+static const tqueue_policy_t drink_policy = {
+    .kind = TQUEUE_DROP_OLDEST,
+};
+
+// Overflow benchmark: consumer drains every 2 ticks, producer offers every tick
+#define BENCH_QUEUE_LENGTH 8
+#define BENCH_DURATION_MS  2000
 
 // Mutex
 SemaphoreHandle_t xPrintMutex;
 
-// Stats
+// Stats: bumped by producers, QC and consumers on both cores, so each is a
+// sharded counter (shard_counter.h) rather than a plain ++
 typedef struct {
-    uint32_t produced;
-    uint32_t consumed;
-    uint32_t dropped;
-    uint32_t qc_failed;
+    sc_counter_t produced;
+    sc_counter_t consumed;
+    sc_counter_t dropped;
+    sc_counter_t qc_failed;
 } stats_t;
 
-stats_t global_stats = {0, 0, 0, 0};
+stats_t global_stats;
 
 // Product structure
 typedef struct {
@@ -67,17 +89,18 @@ void producer_task(void *pvParams) {
         strcpy(item.category, (item.id % 2 == 0) ? "Food" : "Drink");
         item.timestamp = xTaskGetTickCount();
 
-        QueueHandle_t targetQueue = (strcmp(item.category, "Food") == 0) ? xQueueFood : xQueueDrink;
+        tqueue_t *targetQueue = (strcmp(item.category, "Food") == 0) ? xQueueFood : xQueueDrink;
 
-        if (xQueueSend(targetQueue, &item, pdMS_TO_TICKS(200)) == pdPASS) {
-            global_stats.produced++;
+        if (tqueue_send(targetQueue, &item) == pdPASS) {
+            sc_inc(&global_stats.produced);
             safe_printf("✅ P%d Produced: %s (%s)\n", producer_id, item.name, item.category);
             gpio_set_level(LED_PRODUCER, 1);
             vTaskDelay(pdMS_TO_TICKS(100));
             gpio_set_level(LED_PRODUCER, 0);
         } else {
-            global_stats.dropped++;
-            safe_printf("⚠️ P%d Failed to enqueue (queue full)\n", producer_id);
+            sc_inc(&global_stats.dropped);
+            safe_printf("⚠️ P%d Failed to enqueue (queue full, %s)\n", producer_id,
+                        tqueue_policy_name(targetQueue->policy.kind));
         }
 
         vTaskDelay(pdMS_TO_TICKS(1000 + (esp_random() % 1000)));
@@ -90,12 +113,12 @@ void qc_task(void *pvParams) {
     safe_printf("🔍 QC task started\n");
 
     while (1) {
-        if (xQueueReceive(xQueueFood, &item, pdMS_TO_TICKS(1000)) == pdPASS ||
-            xQueueReceive(xQueueDrink, &item, pdMS_TO_TICKS(1000)) == pdPASS) {
+        if (tqueue_receive(xQueueFood, &item, pdMS_TO_TICKS(1000)) == pdPASS ||
+            tqueue_receive(xQueueDrink, &item, pdMS_TO_TICKS(1000)) == pdPASS) {
 
             // ตรวจคุณภาพ (20% ไม่ผ่าน)
             if (esp_random() % 5 == 0) {
-                global_stats.qc_failed++;
+                sc_inc(&global_stats.qc_failed);
                 safe_printf("❌ QC Failed: %s (%s)\n", item.name, item.category);
                 continue;
             }
@@ -103,9 +126,9 @@ void qc_task(void *pvParams) {
             safe_printf("🧪 QC Passed: %s (%s)\n", item.name, item.category);
 
             // ส่งไป Consumer ผ่านคิวรวม
-            if (xQueueSendToBack((strcmp(item.category, "Food") == 0) ? xQueueFood : xQueueDrink,
-                                 &item, pdMS_TO_TICKS(100)) != pdPASS) {
-                global_stats.dropped++;
+            if (tqueue_send((strcmp(item.category, "Food") == 0) ? xQueueFood : xQueueDrink,
+                            &item) != pdPASS) {
+                sc_inc(&global_stats.dropped);
             }
         }
         vTaskDelay(pdMS_TO_TICKS(300));
@@ -120,9 +143,9 @@ void consumer_task(void *pvParams) {
 
     while (1) {
         int count = 0;
-        QueueHandle_t sourceQueue = (consumer_id % 2 == 0) ? xQueueFood : xQueueDrink;
+        tqueue_t *sourceQueue = (consumer_id % 2 == 0) ? xQueueFood : xQueueDrink;
 
-        while (count < 3 && xQueueReceive(sourceQueue, &batch[count], pdMS_TO_TICKS(1000)) == pdPASS) {
+        while (count < 3 && tqueue_receive(sourceQueue, &batch[count], pdMS_TO_TICKS(1000)) == pdPASS) {
             count++;
         }
 
@@ -130,7 +153,7 @@ void consumer_task(void *pvParams) {
             safe_printf("📦 Consumer %d processing batch (%d items)\n", consumer_id, count);
             gpio_set_level(LED_CONSUMER, 1);
             for (int i = 0; i < count; i++) {
-                global_stats.consumed++;
+                sc_inc(&global_stats.consumed);
                 vTaskDelay(pdMS_TO_TICKS(batch[i].processing_time));
                 safe_printf("→ Consumed: %s (%s)\n", batch[i].name, batch[i].category);
             }
@@ -147,21 +170,27 @@ void consumer_task(void *pvParams) {
 }
 
 // ---------- Dynamic Load Balancer ----------
+// Decides on sojourn time and send failures measured over the whole
+// window, so bursts between two samples are not missed.
 void load_balancer_task(void *pvParams) {
     static TaskHandle_t dynamic_consumer = NULL;
-    int next_id = 3;
+    tqueue_window_t food_win = {0}, drink_win = {0};
+    tqueue_rates_t food, drink;
 
     while (1) {
-        UBaseType_t food_load = uxQueueMessagesWaiting(xQueueFood);
-        UBaseType_t drink_load = uxQueueMessagesWaiting(xQueueDrink);
-        int total = food_load + drink_load;
+        tqueue_window_update(xQueueFood, &food_win, &food);
+        tqueue_window_update(xQueueDrink, &drink_win, &drink);
 
-        if (total > 8 && dynamic_consumer == NULL) {
-            safe_printf("⚡ High load (%d items), adding extra consumer!\n", total);
+        uint32_t p99 = food.sojourn_p99_ms > drink.sojourn_p99_ms ? food.sojourn_p99_ms : drink.sojourn_p99_ms;
+        uint32_t failures = food.send_failures + drink.send_failures;
+        uint32_t stalls = food.full_stalls + drink.full_stalls;
+
+        if ((p99 >= LB_ADD_SOJOURN_MS || failures > 0) && dynamic_consumer == NULL) {
+            safe_printf("⚡ High load (p99 %lu ms, %lu drops), adding extra consumer!\n", p99, failures);
             static int cid = 3;
             xTaskCreate(consumer_task, "DynConsumer", 4096, &cid, 2, &dynamic_consumer);
-        } else if (total < 3 && dynamic_consumer != NULL) {
-            safe_printf("💤 Low load (%d items), removing dynamic consumer.\n", total);
+        } else if (p99 < LB_REMOVE_SOJOURN_MS && stalls == 0 && dynamic_consumer != NULL) {
+            safe_printf("💤 Low load (p99 %lu ms), removing dynamic consumer.\n", p99);
             vTaskDelete(dynamic_consumer);
             dynamic_consumer = NULL;
         }
@@ -173,15 +202,95 @@ void load_balancer_task(void *pvParams) {
 // ---------- Statistics ----------
 void statistics_task(void *pvParams) {
     while (1) {
-        UBaseType_t food = uxQueueMessagesWaiting(xQueueFood);
-        UBaseType_t drink = uxQueueMessagesWaiting(xQueueDrink);
+        UBaseType_t food = tqueue_messages_waiting(xQueueFood);
+        UBaseType_t drink = tqueue_messages_waiting(xQueueDrink);
         safe_printf("\n📊 Stats: Prod=%lu | Cons=%lu | Drop=%lu | QC_Fail=%lu | FoodQ=%d | DrinkQ=%d\n",
-                    global_stats.produced, global_stats.consumed, global_stats.dropped,
-                    global_stats.qc_failed, food, drink);
+                    sc_read(&global_stats.produced), sc_read(&global_stats.consumed),
+                    sc_read(&global_stats.dropped), sc_read(&global_stats.qc_failed), food, drink);
+        tqueue_report_all();
         vTaskDelay(pdMS_TO_TICKS(4000));
     }
 }
 
+// ---------- Overflow Policy Benchmark ----------
+typedef struct {
+    uint32_t seq;
+    int priority;   // 1 for every 4th item
+} bench_item_t;
+
+static uint32_t bench_high_delivered;
+
+static int bench_priority(const void *item) {
+    return ((const bench_item_t *)item)->priority;
+}
+
+static void bench_consumer_task(void *pvParams) {
+    tqueue_t *q = pvParams;
+    bench_item_t item;
+
+    while (1) {
+        if (tqueue_receive(q, &item, portMAX_DELAY) == pdPASS) {
+            if (item.priority)
+                bench_high_delivered++;
+            vTaskDelay(2);
+        }
+    }
+}
+
+// Runs each policy against the same 2x overload and prints one row per
+// policy: delivered throughput, sojourn tail and what was shed
+void overflow_benchmark(void) {
+    const tqueue_policy_t policies[] = {
+        {.kind = TQUEUE_BLOCK, .max_block = portMAX_DELAY},
+        {.kind = TQUEUE_DROP_NEWEST},
+        {.kind = TQUEUE_DROP_OLDEST},
+        {.kind = TQUEUE_PRIORITY_EVICT, .priority_of = bench_priority},
+        {.kind = TQUEUE_RATE_LIMIT, .max_block = pdMS_TO_TICKS(100), .max_interval_us = 100000},
+    };
+    tqueue_t *q = tqueue_create("Bench", BENCH_QUEUE_LENGTH, sizeof(bench_item_t));
+    if (q == NULL)
+        return;
+
+    ESP_LOGI(TAG, "🏁 Overflow benchmark: offer %d/s, drain %d/s, queue %d",
+             configTICK_RATE_HZ, configTICK_RATE_HZ / 2, BENCH_QUEUE_LENGTH);
+    ESP_LOGI(TAG, "%-12s %8s %9s %7s %7s %8s %8s %9s %7s",
+             "policy", "offered", "delivered", "p50ms", "p99ms", "rejected", "evicted", "throttled", "hi-%");
+
+    for (int p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+        bench_item_t item = {0};
+        TaskHandle_t consumer;
+        tqueue_window_t win = {0};
+        tqueue_rates_t r;
+        uint32_t offered = 0, high_offered = 0;
+
+        tqueue_set_policy(q, &policies[p]);
+        bench_high_delivered = 0;
+        tqueue_window_update(q, &win, &r);
+        xTaskCreate(bench_consumer_task, "BenchCons", 3072, q, 5, &consumer);
+
+        TickType_t end = xTaskGetTickCount() + pdMS_TO_TICKS(BENCH_DURATION_MS);
+        while (xTaskGetTickCount() < end) {
+            item.seq++;
+            item.priority = (item.seq % 4 == 0);
+            high_offered += item.priority;
+            offered++;
+            tqueue_send(q, &item);
+            vTaskDelay(1);
+        }
+
+        vTaskDelete(consumer);
+        tqueue_window_update(q, &win, &r);
+        while (tqueue_receive(q, &item, 0) == pdPASS) {
+        }
+
+        ESP_LOGI(TAG, "%-12s %6lu/s %7.1f/s %7lu %7lu %8lu %8lu %9lu %6lu%%",
+                 tqueue_policy_name(policies[p].kind),
+                 offered * 1000 / BENCH_DURATION_MS, r.dequeue_rate,
+                 r.sojourn_p50_ms, r.sojourn_p99_ms, r.rejected, r.evicted, r.throttled,
+                 high_offered ? bench_high_delivered * 100 / high_offered : 0);
+    }
+}
+
 // ---------- Main ----------
 void app_main(void) {
     ESP_LOGI(TAG, "🚀 03Lab2 Producer-Consumer with Challenges Starting...");
@@ -190,14 +299,22 @@ void app_main(void) {
     gpio_set_direction(LED_CONSUMER, GPIO_MODE_OUTPUT);
     gpio_set_direction(LED_QC, GPIO_MODE_OUTPUT);
 
-    xQueueFood = xQueueCreate(10, sizeof(product_t));
-    xQueueDrink = xQueueCreate(10, sizeof(product_t));
+    xQueueFood = tqueue_create("Food", 10, sizeof(product_t));
+    xQueueDrink = tqueue_create("Drink", 10, sizeof(product_t));
     xPrintMutex = xSemaphoreCreateMutex();
 
     if (!xQueueFood || !xQueueDrink || !xPrintMutex) {
         ESP_LOGE(TAG, "❌ Queue or Mutex creation failed!");
         return;
     }
+    sc_register(&global_stats.produced, "products_produced", "Products enqueued by producers", SC_COUNTER);
+    sc_register(&global_stats.consumed, "products_consumed", "Products finished by consumers", SC_COUNTER);
+    sc_register(&global_stats.dropped, "products_dropped", "Products that could not be enqueued", SC_COUNTER);
+    sc_register(&global_stats.qc_failed, "products_qc_failed", "Products rejected by quality control", SC_COUNTER);
+    tqueue_set_policy(xQueueFood, &food_policy);
+    tqueue_set_policy(xQueueDrink, &drink_policy);
+
+    overflow_benchmark();
 
     static int p1 = 1, p2 = 2, c1 = 1, c2 = 2;
     xTaskCreate(producer_task, "Producer1", 4096, &p1, 3, NULL);
@@ -0,0 +1,85 @@
+#ifndef SHARD_COUNTER_H
+#define SHARD_COUNTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ============================= SHARDED COUNTERS =============================
+// Statistics that many tasks bump and one task reads.
+//
+// Every counter has one cell per core, each on its own cache line. A writer
+// does a relaxed atomic add on the cell of the core it runs on, so writers on
+// different cores never touch the same word. A task preempted or migrated
+// mid-update still lands its add, because the add itself is atomic. Readers
+// sum the cells. That sum is not a snapshot of all counters at one instant,
+// but each counter only ever moves by whole updates.
+//
+// Values are 32 bits and wrap. Use sc_delta() for rates and long-running sums.
+//
+// Gauges hold a level instead of a count. sc_add()/sc_sub() may be called
+// from any task. sc_set() is only for a gauge with a single writer: it
+// replaces the whole value and must not be mixed with add/sub.
+//
+// Every counter created with sc_register() goes on a lock-free registry, so
+// reports and exporters can list them without knowing the names in advance.
+
+#ifndef SC_CACHE_LINE
+#define SC_CACHE_LINE 32
+#endif
+#define SC_SHARDS portNUM_PROCESSORS
+
+typedef enum {
+    SC_COUNTER,     // only goes up
+    SC_GAUGE,       // current level, signed
+} sc_kind_t;
+
+typedef struct {
+    uint32_t v;
+} __attribute__((aligned(SC_CACHE_LINE))) sc_cell_t;
+
+typedef struct sc_counter {
+    sc_cell_t shard[SC_SHARDS];
+    const char *name;
+    const char *help;
+    sc_kind_t kind;
+    struct sc_counter *next;
+} sc_counter_t;
+
+// c is caller-owned (usually static), so this never allocates. Name and
+// help must outlive the counter.
+void sc_register(sc_counter_t *c, const char *name, const char *help, sc_kind_t kind);
+
+static inline void sc_add(sc_counter_t *c, uint32_t n) {
+    __atomic_fetch_add(&c->shard[xPortGetCoreID()].v, n, __ATOMIC_RELAXED);
+}
+
+static inline void sc_inc(sc_counter_t *c) {
+    sc_add(c, 1);
+}
+
+static inline void sc_sub(sc_counter_t *c, uint32_t n) {
+    __atomic_fetch_sub(&c->shard[xPortGetCoreID()].v, n, __ATOMIC_RELAXED);
+}
+
+// Single-writer gauges only
+void sc_set(sc_counter_t *c, int32_t v);
+
+uint32_t sc_read(const sc_counter_t *c);
+
+static inline int32_t sc_read_gauge(const sc_counter_t *c) {
+    return (int32_t)sc_read(c);
+}
+
+// Growth since the previous call with the same *last, wrap-safe
+uint32_t sc_delta(const sc_counter_t *c, uint32_t *last);
+
+// Registry: newest first
+sc_counter_t *sc_first(void);
+sc_counter_t *sc_next(const sc_counter_t *c);
+sc_counter_t *sc_find(const char *name);
+
+void sc_report_all(void);
+
+#endif
@@ -0,0 +1,394 @@
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "tqueue.h"
+
+static const char *TAG = "TQUEUE";
+
+// Every slot is the enqueue timestamp followed by the caller's item
+typedef int64_t tqueue_stamp_t;
+#define TQUEUE_SLOT_MAX (sizeof(tqueue_stamp_t) + TQUEUE_MAX_ITEM_SIZE)
+
+// Rate limiter: start pace when lag first appears, and the fill levels
+// that slow producers down (multiplicative) or speed them up (additive)
+#define RATE_LIMIT_START_US 1000
+#define RATE_LIMIT_HIGH(q)  ((q)->length * 3 / 4)
+#define RATE_LIMIT_LOW(q)   ((q)->length / 4)
+
+static tqueue_t *registry_head = NULL;
+
+// ================ RELAXED COUNTERS ================
+
+static inline void stat_add(uint32_t *p, uint32_t v) {
+    __atomic_fetch_add(p, v, __ATOMIC_RELAXED);
+}
+
+static inline void stat_max(uint32_t *p, uint32_t v) {
+    uint32_t cur = __atomic_load_n(p, __ATOMIC_RELAXED);
+    while (v > cur &&
+           !__atomic_compare_exchange_n(p, &cur, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static inline int hist_bucket(uint32_t sojourn_us) {
+    uint32_t ms = sojourn_us / 1000;
+    if (ms == 0)
+        return 0;
+    int b = 32 - __builtin_clz(ms);
+    return b < TQUEUE_HIST_BUCKETS ? b : TQUEUE_HIST_BUCKETS - 1;
+}
+
+static void record_sojourn(tqueue_t *q, int64_t stamp) {
+    int64_t d = esp_timer_get_time() - stamp;
+    uint32_t us = d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+
+    stat_add(&q->stats.dequeued, 1);
+    stat_add(&q->stats.sojourn_sum_us, us);
+    stat_max(&q->stats.sojourn_max_us, us);
+    stat_add(&q->stats.hist[hist_bucket(us)], 1);
+}
+
+// ================ DATA PATH ================
+
+tqueue_t *tqueue_create(const char *name, UBaseType_t length, size_t item_size) {
+    if (item_size > TQUEUE_MAX_ITEM_SIZE) {
+        ESP_LOGE(TAG, "%s: item size %u exceeds %d", name, (unsigned)item_size, TQUEUE_MAX_ITEM_SIZE);
+        return NULL;
+    }
+
+    tqueue_t *q = calloc(1, sizeof(tqueue_t));
+    if (q == NULL)
+        return NULL;
+
+    q->handle = xQueueCreate(length, sizeof(tqueue_stamp_t) + item_size);
+    if (q->handle == NULL) {
+        free(q);
+        return NULL;
+    }
+    q->name = name;
+    q->length = length;
+    q->item_size = item_size;
+    q->policy = (tqueue_policy_t){.kind = TQUEUE_BLOCK, .max_block = portMAX_DELAY};
+    portMUX_INITIALIZE(&q->lock);
+    q->monitor.prev_us = esp_timer_get_time();
+
+    // Lock-free push; queues are never unregistered
+    q->next = __atomic_load_n(&registry_head, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&registry_head, &q->next, q, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    return q;
+}
+
+void tqueue_set_policy(tqueue_t *q, const tqueue_policy_t *policy) {
+    taskENTER_CRITICAL(&q->lock);
+    q->policy = *policy;
+    q->interval_us = policy->min_interval_us;
+    q->next_send_us = 0;
+    taskEXIT_CRITICAL(&q->lock);
+}
+
+const char *tqueue_policy_name(tqueue_policy_kind_t kind) {
+    switch (kind) {
+        case TQUEUE_BLOCK:          return "block";
+        case TQUEUE_DROP_NEWEST:    return "drop-newest";
+        case TQUEUE_DROP_OLDEST:    return "drop-oldest";
+        case TQUEUE_PRIORITY_EVICT: return "priority";
+        case TQUEUE_RATE_LIMIT:     return "rate-limit";
+    }
+    return "?";
+}
+
+// ---- per-policy full-queue handling, each returns pdPASS if queued ----
+
+static BaseType_t send_block(tqueue_t *q, const uint8_t *slot) {
+    if (q->policy.max_block == 0) {
+        stat_add(&q->stats.rejected, 1);
+        return errQUEUE_FULL;
+    }
+    stat_add(&q->stats.full_stalls, 1);
+    BaseType_t ok = xQueueSend(q->handle, slot, q->policy.max_block);
+    if (ok != pdPASS)
+        stat_add(&q->stats.send_failures, 1);
+    return ok;
+}
+
+// Another producer may refill the freed slot, so retry once
+static BaseType_t send_drop_oldest(tqueue_t *q, const uint8_t *slot) {
+    uint8_t victim[TQUEUE_SLOT_MAX] __attribute__((aligned(8)));
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (xQueueReceive(q->handle, victim, 0) == pdPASS)
+            stat_add(&q->stats.evicted, 1);
+        if (xQueueSend(q->handle, slot, 0) == pdPASS)
+            return pdPASS;
+    }
+    stat_add(&q->stats.rejected, 1);
+    return errQUEUE_FULL;
+}
+
+// Put a rotated item back; a concurrent producer may have taken its slot
+static void requeue(tqueue_t *q, const uint8_t *slot) {
+    if (xQueueSend(q->handle, slot, 0) != pdPASS)
+        stat_add(&q->stats.evicted, 1);
+}
+
+// A FreeRTOS queue cannot remove from the middle, so rotate it: one pass to
+// find the oldest lowest-priority item, one pass to drop it while keeping
+// the others in order. Ordering is best effort if a consumer on the other
+// core receives during the rotation. O(length), meant for short queues.
+static BaseType_t send_priority_evict(tqueue_t *q, const uint8_t *slot) {
+    uint8_t tmp[TQUEUE_SLOT_MAX] __attribute__((aligned(8)));
+    int incoming = q->policy.priority_of(slot + sizeof(tqueue_stamp_t));
+    UBaseType_t n = uxQueueMessagesWaiting(q->handle);
+    UBaseType_t victim = n;
+    int lowest = incoming;
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        if (xQueueReceive(q->handle, tmp, 0) != pdPASS) {
+            n = i;
+            break;
+        }
+        int p = q->policy.priority_of(tmp + sizeof(tqueue_stamp_t));
+        if (p < lowest) {
+            lowest = p;
+            victim = i;
+        }
+        requeue(q, tmp);
+    }
+
+    if (victim == n) {
+        // Nothing queued ranks below the new item; it may still fit if a
+        // consumer made room meanwhile
+        if (xQueueSend(q->handle, slot, 0) == pdPASS)
+            return pdPASS;
+        stat_add(&q->stats.rejected, 1);
+        return errQUEUE_FULL;
+    }
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        if (xQueueReceive(q->handle, tmp, 0) != pdPASS)
+            break;
+        if (i == victim)
+            stat_add(&q->stats.evicted, 1);
+        else
+            requeue(q, tmp);
+    }
+
+    if (xQueueSend(q->handle, slot, 0) == pdPASS)
+        return pdPASS;
+    stat_add(&q->stats.rejected, 1);
+    return errQUEUE_FULL;
+}
+
+// AIMD on the inter-send interval: double it when the consumer falls behind,
+// shrink it by 1/8 once the backlog clears
+static void rate_limit_adapt(tqueue_t *q, UBaseType_t depth, bool full) {
+    taskENTER_CRITICAL(&q->lock);
+    if (full || depth >= RATE_LIMIT_HIGH(q)) {
+        uint32_t next = q->interval_us ? q->interval_us * 2 : RATE_LIMIT_START_US;
+        q->interval_us = next < q->policy.max_interval_us ? next : q->policy.max_interval_us;
+    } else if (depth <= RATE_LIMIT_LOW(q)) {
+        uint32_t step = q->interval_us / 8;
+        q->interval_us = q->interval_us - step > q->policy.min_interval_us && step > 0
+                             ? q->interval_us - step
+                             : q->policy.min_interval_us;
+    }
+    taskEXIT_CRITICAL(&q->lock);
+}
+
+static void rate_limit_pace(tqueue_t *q) {
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&q->lock);
+    int64_t slot_us = q->next_send_us > now ? q->next_send_us : now;
+    q->next_send_us = slot_us + q->interval_us;
+    taskEXIT_CRITICAL(&q->lock);
+
+    int64_t hold_us = slot_us - now;
+    int64_t max_us = (int64_t)q->policy.max_block * portTICK_PERIOD_MS * 1000;
+    if (hold_us > max_us)
+        hold_us = max_us;
+    if (hold_us <= 0)
+        return;
+
+    TickType_t ticks = (hold_us + portTICK_PERIOD_MS * 1000 - 1) / (portTICK_PERIOD_MS * 1000);
+    stat_add(&q->stats.throttled, 1);
+    stat_add(&q->stats.throttle_ms, ticks * portTICK_PERIOD_MS);
+    vTaskDelay(ticks);
+}
+
+// Sojourn time runs from this call to the matching receive, so a producer
+// held by BLOCK counts towards the latency its item sees. Rate limiter
+// pacing happens before the stamp.
+BaseType_t tqueue_send(tqueue_t *q, const void *item) {
+    uint8_t slot[TQUEUE_SLOT_MAX] __attribute__((aligned(8)));
+
+    if (q->policy.kind == TQUEUE_RATE_LIMIT)
+        rate_limit_pace(q);
+
+    tqueue_stamp_t now = esp_timer_get_time();
+    memcpy(slot, &now, sizeof(now));
+    memcpy(slot + sizeof(now), item, q->item_size);
+
+    BaseType_t ok = xQueueSend(q->handle, slot, 0);
+    if (ok != pdPASS) {
+        switch (q->policy.kind) {
+            case TQUEUE_BLOCK:
+                ok = send_block(q, slot);
+                break;
+            case TQUEUE_DROP_OLDEST:
+                ok = send_drop_oldest(q, slot);
+                break;
+            case TQUEUE_PRIORITY_EVICT:
+                ok = send_priority_evict(q, slot);
+                break;
+            case TQUEUE_DROP_NEWEST:
+            case TQUEUE_RATE_LIMIT:
+                stat_add(&q->stats.rejected, 1);
+                break;
+        }
+    }
+
+    UBaseType_t depth = uxQueueMessagesWaiting(q->handle);
+    if (q->policy.kind == TQUEUE_RATE_LIMIT)
+        rate_limit_adapt(q, depth, ok != pdPASS);
+
+    if (ok == pdPASS) {
+        stat_add(&q->stats.enqueued, 1);
+        stat_max(&q->stats.high_water, depth);
+    }
+    return ok;
+}
+
+BaseType_t tqueue_receive(tqueue_t *q, void *item, TickType_t wait) {
+    uint8_t slot[TQUEUE_SLOT_MAX] __attribute__((aligned(8)));
+
+    BaseType_t ok = xQueueReceive(q->handle, slot, 0);
+    if (ok != pdPASS && wait > 0) {
+        stat_add(&q->stats.empty_stalls, 1);
+        ok = xQueueReceive(q->handle, slot, wait);
+    }
+
+    if (ok == pdPASS) {
+        tqueue_stamp_t stamp;
+        memcpy(&stamp, slot, sizeof(stamp));
+        memcpy(item, slot + sizeof(stamp), q->item_size);
+        record_sojourn(q, stamp);
+    }
+    return ok;
+}
+
+UBaseType_t tqueue_messages_waiting(const tqueue_t *q) {
+    return uxQueueMessagesWaiting(q->handle);
+}
+
+// ================ REGISTRY / MONITOR ================
+
+tqueue_t *tqueue_first(void) {
+    return __atomic_load_n(&registry_head, __ATOMIC_ACQUIRE);
+}
+
+tqueue_t *tqueue_next(const tqueue_t *q) {
+    return q->next;
+}
+
+// Fields are read individually, so a snapshot may be off by the one
+// operation in flight; good enough for telemetry and never blocks a sender.
+void tqueue_read_stats(const tqueue_t *q, tqueue_stats_t *out) {
+    out->enqueued = __atomic_load_n(&q->stats.enqueued, __ATOMIC_RELAXED);
+    out->dequeued = __atomic_load_n(&q->stats.dequeued, __ATOMIC_RELAXED);
+    out->full_stalls = __atomic_load_n(&q->stats.full_stalls, __ATOMIC_RELAXED);
+    out->empty_stalls = __atomic_load_n(&q->stats.empty_stalls, __ATOMIC_RELAXED);
+    out->send_failures = __atomic_load_n(&q->stats.send_failures, __ATOMIC_RELAXED);
+    out->rejected = __atomic_load_n(&q->stats.rejected, __ATOMIC_RELAXED);
+    out->evicted = __atomic_load_n(&q->stats.evicted, __ATOMIC_RELAXED);
+    out->throttled = __atomic_load_n(&q->stats.throttled, __ATOMIC_RELAXED);
+    out->throttle_ms = __atomic_load_n(&q->stats.throttle_ms, __ATOMIC_RELAXED);
+    out->high_water = __atomic_load_n(&q->stats.high_water, __ATOMIC_RELAXED);
+    out->sojourn_sum_us = __atomic_load_n(&q->stats.sojourn_sum_us, __ATOMIC_RELAXED);
+    out->sojourn_max_us = __atomic_load_n(&q->stats.sojourn_max_us, __ATOMIC_RELAXED);
+    for (int i = 0; i < TQUEUE_HIST_BUCKETS; i++)
+        out->hist[i] = __atomic_load_n(&q->stats.hist[i], __ATOMIC_RELAXED);
+}
+
+uint32_t tqueue_hist_percentile_ms(const uint32_t *hist, uint32_t permille) {
+    uint32_t total = 0;
+    for (int i = 0; i < TQUEUE_HIST_BUCKETS; i++)
+        total += hist[i];
+    if (total == 0)
+        return 0;
+
+    uint32_t target = (uint32_t)(((uint64_t)total * permille + 999) / 1000);
+    uint32_t seen = 0;
+    for (int i = 0; i < TQUEUE_HIST_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= target)
+            return 1u << i;
+    }
+    return 1u << (TQUEUE_HIST_BUCKETS - 1);
+}
+
+// Unsigned differences keep the window correct across counter wrap
+void tqueue_window_update(const tqueue_t *q, tqueue_window_t *w, tqueue_rates_t *out) {
+    tqueue_stats_t cur;
+    uint32_t hist[TQUEUE_HIST_BUCKETS];
+    int64_t now = esp_timer_get_time();
+    float dt = (now - w->prev_us) / 1e6f;
+
+    tqueue_read_stats(q, &cur);
+    for (int i = 0; i < TQUEUE_HIST_BUCKETS; i++)
+        hist[i] = cur.hist[i] - w->prev.hist[i];
+
+    uint32_t deq = cur.dequeued - w->prev.dequeued;
+    out->enqueue_rate = dt > 0 ? (cur.enqueued - w->prev.enqueued) / dt : 0;
+    out->dequeue_rate = dt > 0 ? deq / dt : 0;
+    out->samples = deq;
+    out->full_stalls = cur.full_stalls - w->prev.full_stalls;
+    out->empty_stalls = cur.empty_stalls - w->prev.empty_stalls;
+    out->send_failures = cur.send_failures - w->prev.send_failures;
+    out->rejected = cur.rejected - w->prev.rejected;
+    out->evicted = cur.evicted - w->prev.evicted;
+    out->throttled = cur.throttled - w->prev.throttled;
+    out->sojourn_mean_us = deq ? (cur.sojourn_sum_us - w->prev.sojourn_sum_us) / deq : 0;
+    out->sojourn_p50_ms = tqueue_hist_percentile_ms(hist, 500);
+    out->sojourn_p99_ms = tqueue_hist_percentile_ms(hist, 990);
+
+    w->prev = cur;
+    w->prev_us = now;
+}
+
+// Little's law: backlog = arrival rate x time in queue
+UBaseType_t tqueue_suggest_length(const tqueue_t *q, const tqueue_rates_t *r) {
+    float backlog = r->enqueue_rate * r->sojourn_p99_ms / 1000.0f;
+    UBaseType_t len = (UBaseType_t)backlog + 1;
+    uint32_t hw = __atomic_load_n(&q->stats.high_water, __ATOMIC_RELAXED);
+    return len > hw ? len : hw;
+}
+
+void tqueue_report_all(void) {
+    for (tqueue_t *q = tqueue_first(); q != NULL; q = tqueue_next(q)) {
+        tqueue_rates_t r;
+        tqueue_window_update(q, &q->monitor, &r);
+
+        ESP_LOGI(TAG, "📈 %-8s [%s] depth %u/%u hw %lu | in %.2f/s out %.2f/s | stall full %lu empty %lu | fail %lu",
+                 q->name, tqueue_policy_name(q->policy.kind), tqueue_messages_waiting(q), q->length,
+                 q->monitor.prev.high_water, r.enqueue_rate, r.dequeue_rate,
+                 r.full_stalls, r.empty_stalls, r.send_failures);
+        if (r.rejected || r.evicted || r.throttled) {
+            ESP_LOGI(TAG, "   shed: rejected %lu evicted %lu throttled %lu (pace %lu us)",
+                     r.rejected, r.evicted, r.throttled, q->interval_us);
+        }
+
+        if (r.samples > 0) {
+            ESP_LOGI(TAG, "   sojourn mean %lu us p50<%lu ms p99<%lu ms max %lu us | suggest length %u",
+                     r.sojourn_mean_us, r.sojourn_p50_ms, r.sojourn_p99_ms,
+                     q->monitor.prev.sojourn_max_us, tqueue_suggest_length(q, &r));
+        }
+        if (r.send_failures + r.rejected + r.evicted > 0 && r.enqueue_rate > r.dequeue_rate) {
+            ESP_LOGW(TAG, "   %s is consumer-bound: a longer queue only adds latency", q->name);
+        }
+    }
+}
@@ -10,6 +10,9 @@
 #include "driver/gpio.h"
 #include "esp_random.h"
 #include "esp_timer.h"
+#include "tqueue.h"
+#include "msg_codec_gen.h"
+#include "shard_counter.h"
 
 static const char *TAG = "QUEUESETS_ADV";
 
@@ -20,28 +23,43 @@ static const char *TAG = "QUEUESETS_ADV";
 #define LED_PROCESSOR GPIO_NUM_18
 #define LED_PROCESSOR2 GPIO_NUM_19
 
-// Handles
-QueueHandle_t qSensor, qUser, qNetwork;
+// Handles (sensor queue is instrumented and policy-driven, see tqueue.h)
+tqueue_t *qSensor;
+QueueHandle_t qUser, qNetwork;
+
+// The sensor queue is in a queue set, so no evicting policies: instead
+// the sensor samples slower while the processor lags
+static const tqueue_policy_t sensor_policy = {
+    .kind = TQUEUE_RATE_LIMIT,
+    .max_block = pdMS_TO_TICKS(1000),
+    .max_interval_us = 8000000,
+};
 QueueSetHandle_t qSet;
 SemaphoreHandle_t printMutex;
 
 // -----------------------------
 // 🧠 Structures
 // -----------------------------
+// Payload is a typed message from msg_schema.h (a few bytes) instead of
+// 100 bytes of preformatted text; describe_event() renders it on use
 typedef struct {
-    char type[10];
-    int priority;
     uint64_t created_time;
-    char message[100];
+    int priority;
+    msg_any_t body;
 } event_t;
 
+#define EVENT_TEXT_MAX 48
+
+// Both processors update these at once, so they are sharded counters
+// (shard_counter.h). The latency sum is 32-bit; the monitor folds its
+// growth into a 64-bit total every report.
 typedef struct {
-    uint32_t sensor_count, user_count, network_count;
-    uint64_t total_latency_us;
-    uint32_t total_events;
+    sc_counter_t sensor_count, user_count, network_count;
+    sc_counter_t latency_us;
+    sc_counter_t total_events;
 } stats_t;
 
-stats_t stats = {0};
+stats_t stats;
 
 // -----------------------------
 // 🧩 Utility Functions
@@ -56,19 +74,43 @@ void safe_log(const char *fmt, ...) {
     va_end(args);
 }
 
+static const char *network_kinds[] = {"Alert", "Sync", "Update", "Notify", "Critical"};
+
+const char *describe_event(const event_t *e, char *buf, size_t size) {
+    switch (e->body.type) {
+    case MSG_SENSOR:
+        snprintf(buf, size, "Temp: %.1f C", e->body.u.sensor.temp_dc / 10.0);
+        break;
+    case MSG_USER:
+        snprintf(buf, size, "Button %lu pressed", e->body.u.user.button);
+        break;
+    case MSG_NETWORK:
+        snprintf(buf, size, "%s message (P:%d)", network_kinds[e->body.u.network.kind % 5], e->priority);
+        break;
+    default:
+        snprintf(buf, size, "%s event", msg_type_name(e->body.type));
+        break;
+    }
+    return buf;
+}
+
 // -----------------------------
 // 🎛️ Producer Tasks
 // -----------------------------
 void sensor_task(void *pv) {
     event_t e;
+    char text[EVENT_TEXT_MAX];
     ESP_LOGI(TAG, "Sensor task started");
     while (1) {
         e.created_time = esp_timer_get_time();
         e.priority = 2;
-        strcpy(e.type, "Sensor");
-        sprintf(e.message, "Temp: %.1f C", 25 + (esp_random() % 150) / 10.0);
-        if (xQueueSend(qSensor, &e, 0) == pdPASS)
-            safe_log("📊 Sensor queued: %s\n", e.message);
+        e.body.type = MSG_SENSOR;
+        e.body.u.sensor.temp_dc = 250 + esp_random() % 150;
+        if (tqueue_send(qSensor, &e) == pdPASS)
+            safe_log("📊 Sensor queued: %s\n", describe_event(&e, text, sizeof(text)));
+        else
+            safe_log("📉 Sensor shed (%s): %s\n", tqueue_policy_name(sensor_policy.kind),
+                     describe_event(&e, text, sizeof(text)));
         gpio_set_level(LED_SENSOR, 1); vTaskDelay(pdMS_TO_TICKS(50));
         gpio_set_level(LED_SENSOR, 0);
         vTaskDelay(pdMS_TO_TICKS(2000 + (esp_random() % 2000)));
@@ -77,14 +119,15 @@ void sensor_task(void *pv) {
 
 void user_task(void *pv) {
     event_t e;
+    char text[EVENT_TEXT_MAX];
     ESP_LOGI(TAG, "User task started");
     while (1) {
         e.created_time = esp_timer_get_time();
         e.priority = 3;
-        strcpy(e.type, "User");
-        sprintf(e.message, "Button %d pressed", 1 + (esp_random() % 3));
+        e.body.type = MSG_USER;
+        e.body.u.user.button = 1 + (esp_random() % 3);
         if (xQueueSend(qUser, &e, 0) == pdPASS)
-            safe_log("🔘 User queued: %s\n", e.message);
+            safe_log("🔘 User queued: %s\n", describe_event(&e, text, sizeof(text)));
         gpio_set_level(LED_USER, 1); vTaskDelay(pdMS_TO_TICKS(100));
         gpio_set_level(LED_USER, 0);
         vTaskDelay(pdMS_TO_TICKS(4000 + (esp_random() % 2000)));
@@ -93,15 +136,15 @@ void user_task(void *pv) {
 
 void network_task(void *pv) {
     event_t e;
+    char text[EVENT_TEXT_MAX];
     ESP_LOGI(TAG, "Network task started");
-    const char *msgs[] = {"Alert", "Sync", "Update", "Notify", "Critical"};
     while (1) {
         e.created_time = esp_timer_get_time();
         e.priority = 2 + (esp_random() % 4);
-        strcpy(e.type, "Network");
-        sprintf(e.message, "%s message (P:%d)", msgs[esp_random() % 5], e.priority);
+        e.body.type = MSG_NETWORK;
+        e.body.u.network.kind = esp_random() % 5;
         if (xQueueSend(qNetwork, &e, 0) == pdPASS)
-            safe_log("🌐 Network queued: %s\n", e.message);
+            safe_log("🌐 Network queued: %s\n", describe_event(&e, text, sizeof(text)));
         gpio_set_level(LED_NETWORK, 1); vTaskDelay(pdMS_TO_TICKS(50));
         gpio_set_level(LED_NETWORK, 0);
         vTaskDelay(pdMS_TO_TICKS(1000 + (esp_random() % 2000)));
@@ -113,16 +156,17 @@ void network_task(void *pv) {
 // -----------------------------
 void processor2_task(void *pv) {
     event_t e;
+    char text[EVENT_TEXT_MAX];
     safe_log("⚙️ Processor 2 ready\n");
     while (1) {
         if (xQueueReceive(qNetwork, &e, pdMS_TO_TICKS(1000)) == pdPASS) {
             uint64_t now = esp_timer_get_time();
             uint64_t latency = now - e.created_time;
-            stats.total_latency_us += latency;
-            stats.total_events++;
+            sc_add(&stats.latency_us, (uint32_t)latency);
+            sc_inc(&stats.total_events);
             safe_log("🧠 [CPU2] handled Network: %s (lat: %.2fms)\n",
-                     e.message, latency / 1000.0);
-            stats.network_count++;
+                     describe_event(&e, text, sizeof(text)), latency / 1000.0);
+            sc_inc(&stats.network_count);
             gpio_set_level(LED_PROCESSOR2, 1);
             vTaskDelay(pdMS_TO_TICKS(150));
             gpio_set_level(LED_PROCESSOR2, 0);
@@ -136,29 +180,30 @@ void processor2_task(void *pv) {
 void processor_task(void *pv) {
     QueueSetMemberHandle_t active;
     event_t e;
+    char text[EVENT_TEXT_MAX];
     ESP_LOGI(TAG, "Processor main started");
 
     while (1) {
         active = xQueueSelectFromSet(qSet, portMAX_DELAY);
         gpio_set_level(LED_PROCESSOR, 1);
 
-        if (active == qSensor && xQueueReceive(qSensor, &e, 0) == pdPASS) {
+        if (active == tqueue_handle(qSensor) && tqueue_receive(qSensor, &e, 0) == pdPASS) {
             if (e.priority < 2) continue; // Event filtering
             uint64_t now = esp_timer_get_time();
             uint64_t latency = now - e.created_time;
-            stats.total_latency_us += latency;
-            stats.total_events++;
-            safe_log("🔬 [CPU1] Sensor processed: %s (%.2fms)\n", e.message, latency / 1000.0);
-            stats.sensor_count++;
+            sc_add(&stats.latency_us, (uint32_t)latency);
+            sc_inc(&stats.total_events);
+            safe_log("🔬 [CPU1] Sensor processed: %s (%.2fms)\n", describe_event(&e, text, sizeof(text)), latency / 1000.0);
+            sc_inc(&stats.sensor_count);
         }
 
         else if (active == qUser && xQueueReceive(qUser, &e, 0) == pdPASS) {
             uint64_t now = esp_timer_get_time();
             uint64_t latency = now - e.created_time;
-            stats.total_latency_us += latency;
-            stats.total_events++;
-            safe_log("🧍 [CPU1] User processed: %s (%.2fms)\n", e.message, latency / 1000.0);
-            stats.user_count++;
+            sc_add(&stats.latency_us, (uint32_t)latency);
+            sc_inc(&stats.total_events);
+            safe_log("🧍 [CPU1] User processed: %s (%.2fms)\n", describe_event(&e, text, sizeof(text)), latency / 1000.0);
+            sc_inc(&stats.user_count);
         }
 
         else if (active == qNetwork && xQueueReceive(qNetwork, &e, 0) == pdPASS) {
@@ -169,10 +214,10 @@ void processor_task(void *pv) {
             } else {
                 uint64_t now = esp_timer_get_time();
                 uint64_t latency = now - e.created_time;
-                stats.total_latency_us += latency;
-                stats.total_events++;
-                safe_log("🌐 [CPU1] Network processed: %s (%.2fms)\n", e.message, latency / 1000.0);
-                stats.network_count++;
+                sc_add(&stats.latency_us, (uint32_t)latency);
+                sc_inc(&stats.total_events);
+                safe_log("🌐 [CPU1] Network processed: %s (%.2fms)\n", describe_event(&e, text, sizeof(text)), latency / 1000.0);
+                sc_inc(&stats.network_count);
             }
         }
 
@@ -185,21 +230,27 @@ void processor_task(void *pv) {
 // 🧮 Dynamic Queue Management + Stats
 // -----------------------------
 void monitor_task(void *pv) {
+    uint64_t total_latency_us = 0;
+    uint32_t latency_seen = 0;
     ESP_LOGI(TAG, "System monitor running");
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(10000));
-        float avg_latency = stats.total_events ? (stats.total_latency_us / 1000.0) / stats.total_events : 0;
+        total_latency_us += sc_delta(&stats.latency_us, &latency_seen);
+        uint32_t total_events = sc_read(&stats.total_events);
+        float avg_latency = total_events ? (total_latency_us / 1000.0) / total_events : 0;
         safe_log("\n📊 SYSTEM STATS\n");
         safe_log("Sensor:%lu  User:%lu  Network:%lu  Total:%lu\n",
-                 stats.sensor_count, stats.user_count, stats.network_count, stats.total_events);
+                 sc_read(&stats.sensor_count), sc_read(&stats.user_count),
+                 sc_read(&stats.network_count), total_events);
         safe_log("Average latency: %.2f ms\n", avg_latency);
         safe_log("Queues → Sensor:%d User:%d Network:%d\n",
-                 uxQueueMessagesWaiting(qSensor),
+                 tqueue_messages_waiting(qSensor),
                  uxQueueMessagesWaiting(qUser),
                  uxQueueMessagesWaiting(qNetwork));
+        tqueue_report_all();
 
         // Dynamic queue management demo
-        if (stats.total_events > 30 && qNetwork) {
+        if (total_events > 30 && qNetwork) {
             vQueueDelete(qNetwork);
             safe_log("🧩 Removed Network Queue dynamically!\n");
             qNetwork = NULL;
@@ -212,6 +263,7 @@ void monitor_task(void *pv) {
 // -----------------------------
 void app_main(void) {
     ESP_LOGI(TAG, "Starting Advanced Queue Set System...");
+    ESP_LOGI(TAG, "Event item: %d bytes (was 128 with preformatted text)", (int)sizeof(event_t));
 
     gpio_set_direction(LED_SENSOR, GPIO_MODE_OUTPUT);
     gpio_set_direction(LED_USER, GPIO_MODE_OUTPUT);
@@ -219,13 +271,20 @@ void app_main(void) {
     gpio_set_direction(LED_PROCESSOR, GPIO_MODE_OUTPUT);
     gpio_set_direction(LED_PROCESSOR2, GPIO_MODE_OUTPUT);
 
-    qSensor = xQueueCreate(5, sizeof(event_t));
+    sc_register(&stats.sensor_count, "events_sensor", "Sensor events processed", SC_COUNTER);
+    sc_register(&stats.user_count, "events_user", "User events processed", SC_COUNTER);
+    sc_register(&stats.network_count, "events_network", "Network events processed", SC_COUNTER);
+    sc_register(&stats.latency_us, "event_latency_us", "Sum of event creation-to-processing latency", SC_COUNTER);
+    sc_register(&stats.total_events, "events_total", "Events processed by either processor", SC_COUNTER);
+
+    qSensor = tqueue_create("Sensor", 5, sizeof(event_t));
     qUser = xQueueCreate(3, sizeof(event_t));
     qNetwork = xQueueCreate(8, sizeof(event_t));
     qSet = xQueueCreateSet(5 + 3 + 8);
     printMutex = xSemaphoreCreateMutex();
 
-    xQueueAddToSet(qSensor, qSet);
+    tqueue_set_policy(qSensor, &sensor_policy);
+    xQueueAddToSet(tqueue_handle(qSensor), qSet);
     xQueueAddToSet(qUser, qSet);
     xQueueAddToSet(qNetwork, qSet);
 
@@ -0,0 +1,87 @@
+#ifndef MSG_CODEC_H
+#define MSG_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/message_buffer.h"
+
+// ============================= MESSAGE CODEC =============================
+// Variable-length, tagged messages for mixed-type channels.
+//
+// A frame is a 2-byte header followed by the payload:
+//
+//   [type:1][payload length:1][field][field]...
+//
+// Integer fields are LEB128 varints (signed ones zigzag-coded first), so
+// small values take one or two bytes. Strings are a varint length followed
+// by the bytes, without the terminator. Fields carry no tags: both ends
+// share the schema (msg_schema.h), and typed encode/decode functions are
+// generated from it by msg_codec_gen.h. Fields may only be appended; a
+// decoder reads missing trailing fields as zero/empty and ignores extra
+// ones, so old and new builds can talk to each other.
+//
+// Frames travel over a FreeRTOS message buffer (mc_channel_t), which moves
+// only the bytes of each frame plus its own length word, instead of a
+// queue copying the largest member of a union for every item.
+
+#define MC_HEADER_BYTES  2
+#define MC_MAX_PAYLOAD   255
+#define MC_MAX_FRAME     (MC_HEADER_BYTES + MC_MAX_PAYLOAD)
+
+// ================ PRIMITIVES ================
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+} mc_writer_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    bool error;             // truncated field; running out between fields is not an error
+} mc_reader_t;
+
+void mc_put_uvarint(mc_writer_t *w, uint64_t v);
+void mc_put_svarint(mc_writer_t *w, int64_t v);
+void mc_put_str(mc_writer_t *w, const char *s, size_t max);
+
+uint64_t mc_get_uvarint(mc_reader_t *r);
+int64_t mc_get_svarint(mc_reader_t *r);
+void mc_get_str(mc_reader_t *r, char *out, size_t max);
+
+// Frame: begin reserves the header, end fills in the length and returns the
+// frame size, or 0 if the payload did not fit
+void mc_begin(mc_writer_t *w, uint8_t *frame, size_t cap, uint8_t type);
+size_t mc_end(mc_writer_t *w);
+
+// Checks the header against len and positions r on the payload
+bool mc_open(mc_reader_t *r, const uint8_t *frame, size_t len, uint8_t *type);
+
+// ================ CHANNEL ================
+// Message buffers allow one writer at a time; senders serialise on tx_lock.
+// There must be a single receiving task.
+
+typedef struct {
+    MessageBufferHandle_t mb;
+    SemaphoreHandle_t tx_lock;
+    uint32_t sent;
+    uint32_t received;
+    uint32_t dropped;       // no room before the timeout
+    uint32_t bytes;         // frame bytes sent, without length words
+} mc_channel_t;
+
+bool mc_channel_create(mc_channel_t *ch, size_t buffer_bytes);
+void mc_channel_delete(mc_channel_t *ch);
+bool mc_channel_send(mc_channel_t *ch, const uint8_t *frame, size_t len, TickType_t timeout);
+size_t mc_channel_receive(mc_channel_t *ch, uint8_t *frame, size_t cap, TickType_t timeout);
+
+// What the message buffer stores per frame on top of the frame itself
+#define MC_CHANNEL_OVERHEAD sizeof(size_t)
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef MSG_CODEC_GEN_H
+#define MSG_CODEC_GEN_H
+
+#include <string.h>
+#include "msg_codec.h"
+#include "msg_schema.h"
+
+// ============================= GENERATED CODEC =============================
+// Expands MSG_SCHEMA from msg_schema.h into, for every message NAME/name:
+//
+//   MSG_NAME                       type id (enum msg_type_t)
+//   msg_name_t                     struct with the schema's fields
+//   msg_name_encode(m, frame, cap) frame size, 0 if it does not fit
+//   msg_name_decode(r, m)          payload -> struct
+//
+// plus msg_any_t (tagged union of all of them), msg_encode_any(),
+// msg_decode_any() and msg_type_name(). Field kinds: I32, U32, U64 and
+// STR (the size is the C array size, terminator included).
+
+#define MC_DECL_I32(f, n)       int32_t f;
+#define MC_DECL_U32(f, n)       uint32_t f;
+#define MC_DECL_U64(f, n)       uint64_t f;
+#define MC_DECL_STR(f, n)       char f[n];
+
+#define MC_ENC_I32(w, v, n)     mc_put_svarint(w, v)
+#define MC_ENC_U32(w, v, n)     mc_put_uvarint(w, v)
+#define MC_ENC_U64(w, v, n)     mc_put_uvarint(w, v)
+#define MC_ENC_STR(w, v, n)     mc_put_str(w, v, n)
+
+#define MC_DEC_I32(r, v, n)     v = (int32_t)mc_get_svarint(r)
+#define MC_DEC_U32(r, v, n)     v = (uint32_t)mc_get_uvarint(r)
+#define MC_DEC_U64(r, v, n)     v = mc_get_uvarint(r)
+#define MC_DEC_STR(r, v, n)     mc_get_str(r, v, n)
+
+#define MC_FIELD_DECL(kind, f, n)   MC_DECL_##kind(f, n)
+#define MC_FIELD_ENC(kind, f, n)    MC_ENC_##kind(w, m->f, n);
+#define MC_FIELD_DEC(kind, f, n)    MC_DEC_##kind(r, m->f, n);
+
+#define MC_GEN_ENUM(NAME, name, id, FIELDS)   MSG_##NAME = id,
+
+#define MC_GEN_STRUCT(NAME, name, id, FIELDS) \
+    typedef struct { FIELDS(MC_FIELD_DECL) } msg_##name##_t;
+
+#define MC_GEN_FUNCS(NAME, name, id, FIELDS) \
+    static inline size_t msg_##name##_encode(const msg_##name##_t *m, uint8_t *frame, size_t cap) { \
+        mc_writer_t wr, *w = &wr; \
+        mc_begin(w, frame, cap, id); \
+        FIELDS(MC_FIELD_ENC) \
+        return mc_end(w); \
+    } \
+    static inline bool msg_##name##_decode(mc_reader_t *r, msg_##name##_t *m) { \
+        memset(m, 0, sizeof(*m)); \
+        FIELDS(MC_FIELD_DEC) \
+        return !r->error; \
+    }
+
+#define MC_GEN_MEMBER(NAME, name, id, FIELDS)  msg_##name##_t name;
+#define MC_GEN_ENCODE_CASE(NAME, name, id, FIELDS) \
+    case id: return msg_##name##_encode(&m->u.name, frame, cap);
+#define MC_GEN_DECODE_CASE(NAME, name, id, FIELDS) \
+    case id: return msg_##name##_decode(&r, &out->u.name);
+#define MC_GEN_NAME_CASE(NAME, name, id, FIELDS) \
+    case id: return #NAME;
+
+typedef enum { MSG_SCHEMA(MC_GEN_ENUM) } msg_type_t;
+
+MSG_SCHEMA(MC_GEN_STRUCT)
+MSG_SCHEMA(MC_GEN_FUNCS)
+
+typedef struct {
+    uint8_t type;
+    union { MSG_SCHEMA(MC_GEN_MEMBER) } u;
+} msg_any_t;
+
+static inline size_t msg_encode_any(const msg_any_t *m, uint8_t *frame, size_t cap) {
+    switch (m->type) {
+    MSG_SCHEMA(MC_GEN_ENCODE_CASE)
+    default: return 0;
+    }
+}
+
+static inline bool msg_decode_any(const uint8_t *frame, size_t len, msg_any_t *out) {
+    mc_reader_t r;
+    if (!mc_open(&r, frame, len, &out->type))
+        return false;
+    switch (out->type) {
+    MSG_SCHEMA(MC_GEN_DECODE_CASE)
+    default: return false;
+    }
+}
+
+static inline const char *msg_type_name(uint8_t type) {
+    switch (type) {
+    MSG_SCHEMA(MC_GEN_NAME_CASE)
+    default: return "?";
+    }
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef MSG_SCHEMA_H
+#define MSG_SCHEMA_H
+
+// ============================= MESSAGE SCHEMA =============================
+// One row per message: M(NAME, name, type id, field list). A field list
+// names its fields as F(kind, field, array size); see msg_codec_gen.h.
+// Append new fields at the end only, and never reuse a type id.
+//
+// Events carry values, not text; the processor renders the text.
+
+#define MSG_SENSOR_FIELDS(F)    F(I32, temp_dc, 0)      /* 0.1 °C */
+#define MSG_USER_FIELDS(F)      F(U32, button, 0)
+#define MSG_NETWORK_FIELDS(F)   F(U32, kind, 0)         /* index into network_kinds */
+
+#define MSG_SCHEMA(M) \
+    M(SENSOR,  sensor,  1, MSG_SENSOR_FIELDS) \
+    M(USER,    user,    2, MSG_USER_FIELDS) \
+    M(NETWORK, network, 3, MSG_NETWORK_FIELDS)
+
+#endif
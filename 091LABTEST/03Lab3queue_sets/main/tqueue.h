@@ -0,0 +1,128 @@
+#ifndef TQUEUE_H
+#define TQUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// ================ TELEMETRY QUEUE ================
+// Thin wrapper around a FreeRTOS queue that stamps every item with its
+// enqueue time and keeps counters the data path updates with relaxed
+// atomics only. Every queue links itself into a global registry so one
+// monitor can walk all of them without taking any lock the senders or
+// receivers use.
+//
+// What a send does when the queue is full is a property of the queue, not
+// of each call site; see tqueue_policy_t.
+
+#define TQUEUE_MAX_ITEM_SIZE 128
+#define TQUEUE_HIST_BUCKETS  16   // bucket 0: <1 ms, bucket i: [2^(i-1), 2^i) ms
+
+// ================ OVERFLOW POLICIES ================
+
+typedef enum {
+    TQUEUE_BLOCK,           // wait up to max_block, then fail
+    TQUEUE_DROP_NEWEST,     // never wait, reject the new item
+    TQUEUE_DROP_OLDEST,     // evict the head to make room
+    TQUEUE_PRIORITY_EVICT,  // evict the lowest-priority item if lower than the new one
+    TQUEUE_RATE_LIMIT,      // pace producers, slowing down while the consumer lags
+} tqueue_policy_kind_t;
+
+// Higher value survives eviction
+typedef int (*tqueue_priority_fn)(const void *item);
+
+typedef struct {
+    tqueue_policy_kind_t kind;
+    TickType_t max_block;            // BLOCK, RATE_LIMIT: longest a producer is held
+    tqueue_priority_fn priority_of;  // PRIORITY_EVICT
+    uint32_t min_interval_us;        // RATE_LIMIT: fastest pace when the queue is drained
+    uint32_t max_interval_us;        // RATE_LIMIT: slowest pace under sustained lag, > 0
+} tqueue_policy_t;
+
+// DROP_OLDEST and PRIORITY_EVICT receive from the queue inside a send, which
+// breaks the one-entry-per-item accounting of a queue set; only use BLOCK,
+// DROP_NEWEST or RATE_LIMIT on queues added to a set.
+
+// ================ TELEMETRY ================
+
+typedef struct {
+    uint32_t enqueued;
+    uint32_t dequeued;
+    uint32_t full_stalls;     // send found the queue full and had to wait
+    uint32_t empty_stalls;    // receive found the queue empty and had to wait
+    uint32_t send_failures;   // send gave up after its timeout
+    uint32_t rejected;        // new item dropped by the policy
+    uint32_t evicted;         // queued item dropped to make room
+    uint32_t throttled;       // sends delayed by the rate limiter
+    uint32_t throttle_ms;     // total time producers were held by it
+    uint32_t high_water;      // deepest fill level ever seen after a send
+    uint32_t sojourn_sum_us;  // wraps; only deltas are meaningful
+    uint32_t sojourn_max_us;
+    uint32_t hist[TQUEUE_HIST_BUCKETS];
+} tqueue_stats_t;
+
+// Rates and latency over the interval between two observations
+typedef struct {
+    float enqueue_rate;       // items/s
+    float dequeue_rate;       // items/s
+    uint32_t samples;         // items dequeued in the window
+    uint32_t full_stalls;
+    uint32_t empty_stalls;
+    uint32_t send_failures;
+    uint32_t rejected;
+    uint32_t evicted;
+    uint32_t throttled;
+    uint32_t sojourn_mean_us;
+    uint32_t sojourn_p50_ms;  // bucket upper bounds
+    uint32_t sojourn_p99_ms;
+} tqueue_rates_t;
+
+// Per-observer history, so independent tasks can each keep a window
+typedef struct {
+    tqueue_stats_t prev;
+    int64_t prev_us;
+} tqueue_window_t;
+
+typedef struct tqueue {
+    const char *name;
+    QueueHandle_t handle;
+    UBaseType_t length;
+    size_t item_size;
+    tqueue_policy_t policy;
+    portMUX_TYPE lock;        // rate limiter state only
+    uint32_t interval_us;     // current RATE_LIMIT pace
+    int64_t next_send_us;
+    tqueue_stats_t stats;
+    tqueue_window_t monitor;  // owned by tqueue_report_all()
+    struct tqueue *next;
+} tqueue_t;
+
+// Starts out as TQUEUE_BLOCK with portMAX_DELAY, like a plain xQueueSend
+tqueue_t *tqueue_create(const char *name, UBaseType_t length, size_t item_size);
+void tqueue_set_policy(tqueue_t *q, const tqueue_policy_t *policy);
+const char *tqueue_policy_name(tqueue_policy_kind_t kind);
+
+// For xQueueAddToSet / xQueueSelectFromSet
+static inline QueueHandle_t tqueue_handle(const tqueue_t *q) { return q->handle; }
+
+// Applies the queue's overflow policy; pdPASS if the item was queued
+BaseType_t tqueue_send(tqueue_t *q, const void *item);
+BaseType_t tqueue_receive(tqueue_t *q, void *item, TickType_t wait);
+UBaseType_t tqueue_messages_waiting(const tqueue_t *q);
+
+// Registry iteration, safe against concurrent tqueue_create()
+tqueue_t *tqueue_first(void);
+tqueue_t *tqueue_next(const tqueue_t *q);
+
+void tqueue_read_stats(const tqueue_t *q, tqueue_stats_t *out);
+void tqueue_window_update(const tqueue_t *q, tqueue_window_t *w, tqueue_rates_t *out);
+uint32_t tqueue_hist_percentile_ms(const uint32_t *hist, uint32_t permille);
+
+// Queue length that would hold the p99 backlog at the measured arrival rate
+UBaseType_t tqueue_suggest_length(const tqueue_t *q, const tqueue_rates_t *r);
+
+// Logs every registered queue; call from a single monitor task
+void tqueue_report_all(void);
+
+#endif
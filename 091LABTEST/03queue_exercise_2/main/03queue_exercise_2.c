@@ -1,94 +1,234 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "msg_codec_gen.h"
 
 static const char *TAG = "QUEUE_EX2";
 
-typedef enum { MSG_TEXT, MSG_NUMBER, MSG_COMMAND } msg_type_t;
+// Messages are variable-length frames (msg_schema.h, msg_codec.h): a
+// NUMBER now moves a few bytes instead of the whole union
+#define CHANNEL_BYTES 512
 
-typedef struct {
-    msg_type_t type;
-    union {
-        char text[32];
-        int number;
-        char command[16];
-    } data;
-} message_t;
+mc_channel_t message_channel;
+
+static const char *texts[] = {"Hello Queue!", "OK", "Sensor online", "Battery at 87 percent"};
+static const char *commands[] = {"RESET", "START", "STOP", "CALIBRATE"};
 
-QueueHandle_t message_queue;
+void send_message(const msg_any_t *msg)
+{
+    uint8_t frame[MC_MAX_FRAME];
+    size_t len = msg_encode_any(msg, frame, sizeof(frame));
+
+    if (!mc_channel_send(&message_channel, frame, len, pdMS_TO_TICKS(100)))
+    {
+        ESP_LOGW(TAG, "Dropped %s message", msg_type_name(msg->type));
+    }
+}
 
 void producer_text_task(void *pv)
 {
-    message_t msg;
-    msg.type = MSG_TEXT;
+    msg_any_t msg = {.type = MSG_TEXT};
+    int i = 0;
     while (1)
     {
-        strcpy(msg.data.text, "Hello Queue!");
-        xQueueSend(message_queue, &msg, pdMS_TO_TICKS(100));
-        ESP_LOGI(TAG, "Sent TEXT: %s", msg.data.text);
+        snprintf(msg.u.text.text, sizeof(msg.u.text.text), "%s", texts[i++ % 4]);
+        send_message(&msg);
+        ESP_LOGI(TAG, "Sent TEXT: %s", msg.u.text.text);
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
 }
 
 void producer_number_task(void *pv)
 {
-    message_t msg;
-    msg.type = MSG_NUMBER;
+    msg_any_t msg = {.type = MSG_NUMBER};
     while (1)
     {
-        msg.data.number = rand() % 500;
-        xQueueSend(message_queue, &msg, pdMS_TO_TICKS(100));
-        ESP_LOGI(TAG, "Sent NUMBER: %d", msg.data.number);
+        msg.u.number.number = rand() % 500;
+        send_message(&msg);
+        ESP_LOGI(TAG, "Sent NUMBER: %ld", msg.u.number.number);
         vTaskDelay(pdMS_TO_TICKS(1500));
     }
 }
 
 void producer_command_task(void *pv)
 {
-    message_t msg;
-    msg.type = MSG_COMMAND;
+    msg_any_t msg = {.type = MSG_COMMAND};
+    int i = 0;
     while (1)
     {
-        strcpy(msg.data.command, "RESET");
-        xQueueSend(message_queue, &msg, pdMS_TO_TICKS(100));
-        ESP_LOGI(TAG, "Sent COMMAND: %s", msg.data.command);
+        snprintf(msg.u.command.command, sizeof(msg.u.command.command), "%s", commands[i++ % 4]);
+        send_message(&msg);
+        ESP_LOGI(TAG, "Sent COMMAND: %s", msg.u.command.command);
         vTaskDelay(pdMS_TO_TICKS(2000));
     }
 }
 
 void consumer_task(void *pv)
 {
-    message_t received;
+    uint8_t frame[MC_MAX_FRAME];
+    msg_any_t received;
     while (1)
     {
-        if (xQueueReceive(message_queue, &received, portMAX_DELAY) == pdTRUE)
+        size_t len = mc_channel_receive(&message_channel, frame, sizeof(frame), portMAX_DELAY);
+        if (!msg_decode_any(frame, len, &received))
+        {
+            ESP_LOGW(TAG, "Bad frame (%d bytes, type %d)", len, len ? frame[0] : -1);
+            continue;
+        }
+        switch (received.type)
+        {
+            case MSG_TEXT:
+                ESP_LOGI(TAG, "Processing TEXT: %s (%d B)", received.u.text.text, len);
+                break;
+            case MSG_NUMBER:
+                ESP_LOGI(TAG, "Processing NUMBER: %ld (%d B)", received.u.number.number, len);
+                break;
+            case MSG_COMMAND:
+                ESP_LOGI(TAG, "Processing COMMAND: %s (%d B)", received.u.command.command, len);
+                break;
+        }
+    }
+}
+
+// ================ CODEC BENCHMARK ================
+
+#define BENCH_MESSAGES 3000
+#define BENCH_BATCH    10
+
+// The previous fixed-size item: every message costs the largest member
+typedef struct
+{
+    msg_type_t type;
+    union
+    {
+        char text[32];
+        int number;
+        char command[16];
+    } data;
+} fixed_message_t;
+
+// Same mix the producers generate: per 6 s, 6 texts, 4 numbers, 3 commands
+static void bench_message(int i, msg_any_t *msg)
+{
+    int slot = i % 13;
+    if (slot < 6)
+    {
+        msg->type = MSG_TEXT;
+        snprintf(msg->u.text.text, sizeof(msg->u.text.text), "%s", texts[i % 4]);
+    }
+    else if (slot < 10)
+    {
+        msg->type = MSG_NUMBER;
+        msg->u.number.number = (i * 37) % 500;
+    }
+    else
+    {
+        msg->type = MSG_COMMAND;
+        snprintf(msg->u.command.command, sizeof(msg->u.command.command), "%s", commands[i % 4]);
+    }
+}
+
+static void to_fixed(const msg_any_t *msg, fixed_message_t *out)
+{
+    out->type = msg->type;
+    switch (msg->type)
+    {
+        case MSG_TEXT:    memcpy(out->data.text, msg->u.text.text, sizeof(out->data.text)); break;
+        case MSG_NUMBER:  out->data.number = msg->u.number.number; break;
+        case MSG_COMMAND: memcpy(out->data.command, msg->u.command.command, sizeof(out->data.command)); break;
+    }
+}
+
+// Both paths send and receive in batches from one task, so the numbers are
+// copy and encode cost, not context switches
+void codec_benchmark(void)
+{
+    static msg_any_t msgs[BENCH_BATCH];
+    uint32_t checksum_fixed = 0, checksum_codec = 0, frame_bytes = 0;
+
+    QueueHandle_t queue = xQueueCreate(BENCH_BATCH, sizeof(fixed_message_t));
+    mc_channel_t channel;
+    if (!queue || !mc_channel_create(&channel, BENCH_BATCH * sizeof(fixed_message_t)))
+    {
+        ESP_LOGE(TAG, "Benchmark setup failed");
+        return;
+    }
+
+    // Fixed-size queue
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_MESSAGES; i += BENCH_BATCH)
+    {
+        for (int j = 0; j < BENCH_BATCH; j++)
         {
-            switch (received.type)
+            fixed_message_t item;
+            bench_message(i + j, &msgs[j]);
+            to_fixed(&msgs[j], &item);
+            xQueueSend(queue, &item, 0);
+        }
+        for (int j = 0; j < BENCH_BATCH; j++)
+        {
+            fixed_message_t item;
+            xQueueReceive(queue, &item, 0);
+            checksum_fixed += item.type == MSG_NUMBER ? (uint32_t)item.data.number : (uint8_t)item.data.text[0];
+        }
+    }
+    int64_t fixed_us = esp_timer_get_time() - start;
+
+    // Codec over a message buffer of the same size
+    start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_MESSAGES; i += BENCH_BATCH)
+    {
+        for (int j = 0; j < BENCH_BATCH; j++)
+        {
+            uint8_t frame[MC_MAX_FRAME];
+            bench_message(i + j, &msgs[j]);
+            size_t len = msg_encode_any(&msgs[j], frame, sizeof(frame));
+            mc_channel_send(&channel, frame, len, 0);
+            frame_bytes += len;
+        }
+        for (int j = 0; j < BENCH_BATCH; j++)
+        {
+            uint8_t frame[MC_MAX_FRAME];
+            msg_any_t msg;
+            size_t len = mc_channel_receive(&channel, frame, sizeof(frame), 0);
+            if (msg_decode_any(frame, len, &msg))
             {
-                case MSG_TEXT:
-                    ESP_LOGI(TAG, "Processing TEXT: %s", received.data.text);
-                    break;
-                case MSG_NUMBER:
-                    ESP_LOGI(TAG, "Processing NUMBER: %d", received.data.number);
-                    break;
-                case MSG_COMMAND:
-                    ESP_LOGI(TAG, "Processing COMMAND: %s", received.data.command);
-                    break;
+                checksum_codec += msg.type == MSG_NUMBER ? (uint32_t)msg.u.number.number : (uint8_t)msg.u.text.text[0];
             }
         }
     }
+    int64_t codec_us = esp_timer_get_time() - start;
+
+    float avg_frame = (float)frame_bytes / BENCH_MESSAGES;
+    ESP_LOGI(TAG, "📦 Codec benchmark (%d messages, text/number/command mix 6:4:3):", BENCH_MESSAGES);
+    ESP_LOGI(TAG, "  fixed queue : %3d B/msg | %6lld ns/msg | %lu msg/s",
+             (int)sizeof(fixed_message_t), fixed_us * 1000 / BENCH_MESSAGES,
+             (uint32_t)(BENCH_MESSAGES * 1000000LL / (fixed_us ? fixed_us : 1)));
+    ESP_LOGI(TAG, "  codec + MB  : %5.1f B/msg (frame %.1f + %d length) | %6lld ns/msg | %lu msg/s",
+             avg_frame + MC_CHANNEL_OVERHEAD, avg_frame, (int)MC_CHANNEL_OVERHEAD,
+             codec_us * 1000 / BENCH_MESSAGES,
+             (uint32_t)(BENCH_MESSAGES * 1000000LL / (codec_us ? codec_us : 1)));
+    ESP_LOGI(TAG, "  %d-byte buffer holds %d fixed messages or ~%d frames; checksums %s",
+             BENCH_BATCH * (int)sizeof(fixed_message_t), BENCH_BATCH,
+             (int)(BENCH_BATCH * sizeof(fixed_message_t) / (avg_frame + MC_CHANNEL_OVERHEAD)),
+             checksum_fixed == checksum_codec ? "match" : "DIFFER");
+
+    vQueueDelete(queue);
+    mc_channel_delete(&channel);
 }
 
 void app_main(void)
 {
-    message_queue = xQueueCreate(10, sizeof(message_t));
+    codec_benchmark();
 
-    if (!message_queue)
+    if (!mc_channel_create(&message_channel, CHANNEL_BYTES))
     {
-        ESP_LOGE(TAG, "Failed to create queue!");
+        ESP_LOGE(TAG, "Failed to create message channel!");
         return;
     }
 
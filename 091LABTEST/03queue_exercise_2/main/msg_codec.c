@@ -0,0 +1,142 @@
+#include <string.h>
+#include "msg_codec.h"
+
+// ================ WRITER ================
+
+static void put_byte(mc_writer_t *w, uint8_t b) {
+    if (w->len < w->cap)
+        w->buf[w->len++] = b;
+    else
+        w->overflow = true;
+}
+
+void mc_put_uvarint(mc_writer_t *w, uint64_t v) {
+    while (v >= 0x80) {
+        put_byte(w, (uint8_t)v | 0x80);
+        v >>= 7;
+    }
+    put_byte(w, (uint8_t)v);
+}
+
+void mc_put_svarint(mc_writer_t *w, int64_t v) {
+    mc_put_uvarint(w, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+void mc_put_str(mc_writer_t *w, const char *s, size_t max) {
+    size_t n = strnlen(s, max ? max - 1 : 0);
+    mc_put_uvarint(w, n);
+    if (w->len + n > w->cap) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+// ================ READER ================
+
+uint64_t mc_get_uvarint(mc_reader_t *r) {
+    uint64_t v = 0;
+
+    if (r->pos >= r->len)
+        return 0;   // field not present: older sender
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->pos >= r->len)
+            break;
+        uint8_t b = r->buf[r->pos++];
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return v;
+    }
+    r->error = true;
+    return 0;
+}
+
+int64_t mc_get_svarint(mc_reader_t *r) {
+    uint64_t z = mc_get_uvarint(r);
+    return (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+}
+
+void mc_get_str(mc_reader_t *r, char *out, size_t max) {
+    size_t n = mc_get_uvarint(r);
+
+    if (n > r->len - r->pos) {
+        r->error = true;
+        n = 0;
+    }
+    size_t keep = n < max ? n : max - 1;
+    memcpy(out, r->buf + r->pos, keep);
+    out[keep] = '\0';
+    r->pos += n;
+}
+
+// ================ FRAMES ================
+
+void mc_begin(mc_writer_t *w, uint8_t *frame, size_t cap, uint8_t type) {
+    w->buf = frame;
+    w->cap = cap < MC_MAX_FRAME ? cap : MC_MAX_FRAME;
+    w->len = MC_HEADER_BYTES;
+    w->overflow = cap < MC_HEADER_BYTES;
+    if (!w->overflow)
+        frame[0] = type;
+}
+
+size_t mc_end(mc_writer_t *w) {
+    if (w->overflow)
+        return 0;
+    w->buf[1] = (uint8_t)(w->len - MC_HEADER_BYTES);
+    return w->len;
+}
+
+bool mc_open(mc_reader_t *r, const uint8_t *frame, size_t len, uint8_t *type) {
+    if (len < MC_HEADER_BYTES || MC_HEADER_BYTES + frame[1] > len)
+        return false;
+    *type = frame[0];
+    r->buf = frame + MC_HEADER_BYTES;
+    r->len = frame[1];
+    r->pos = 0;
+    r->error = false;
+    return true;
+}
+
+// ================ CHANNEL ================
+
+bool mc_channel_create(mc_channel_t *ch, size_t buffer_bytes) {
+    memset(ch, 0, sizeof(*ch));
+    ch->mb = xMessageBufferCreate(buffer_bytes);
+    ch->tx_lock = xSemaphoreCreateMutex();
+    return ch->mb && ch->tx_lock;
+}
+
+void mc_channel_delete(mc_channel_t *ch) {
+    if (ch->mb)
+        vMessageBufferDelete(ch->mb);
+    if (ch->tx_lock)
+        vSemaphoreDelete(ch->tx_lock);
+    ch->mb = NULL;
+    ch->tx_lock = NULL;
+}
+
+bool mc_channel_send(mc_channel_t *ch, const uint8_t *frame, size_t len, TickType_t timeout) {
+    if (!len || xSemaphoreTake(ch->tx_lock, timeout) != pdTRUE) {
+        __atomic_fetch_add(&ch->dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    bool ok = xMessageBufferSend(ch->mb, frame, len, timeout) == len;
+    if (ok) {
+        ch->sent++;
+        ch->bytes += len;
+    } else {
+        // Atomic too: a sender that times out on tx_lock counts outside it
+        __atomic_fetch_add(&ch->dropped, 1, __ATOMIC_RELAXED);
+    }
+    xSemaphoreGive(ch->tx_lock);
+    return ok;
+}
+
+size_t mc_channel_receive(mc_channel_t *ch, uint8_t *frame, size_t cap, TickType_t timeout) {
+    size_t len = xMessageBufferReceive(ch->mb, frame, cap, timeout);
+    if (len)
+        ch->received++;
+    return len;
+}
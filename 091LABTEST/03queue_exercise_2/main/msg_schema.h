@@ -0,0 +1,18 @@
+#ifndef MSG_SCHEMA_H
+#define MSG_SCHEMA_H
+
+// ============================= MESSAGE SCHEMA =============================
+// One row per message: M(NAME, name, type id, field list). A field list
+// names its fields as F(kind, field, array size); see msg_codec_gen.h.
+// Append new fields at the end only, and never reuse a type id.
+
+#define MSG_TEXT_FIELDS(F)      F(STR, text, 32)
+#define MSG_NUMBER_FIELDS(F)    F(I32, number, 0)
+#define MSG_COMMAND_FIELDS(F)   F(STR, command, 16)
+
+#define MSG_SCHEMA(M) \
+    M(TEXT,    text,    1, MSG_TEXT_FIELDS) \
+    M(NUMBER,  number,  2, MSG_NUMBER_FIELDS) \
+    M(COMMAND, command, 3, MSG_COMMAND_FIELDS)
+
+#endif
@@ -3,11 +3,23 @@
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "esp_log.h"
+#include "prio_mailbox.h"
 
 static const char *TAG = "QUEUE_EX3";
 
-QueueHandle_t high_priority_queue;
-QueueHandle_t normal_priority_queue;
+// One mailbox, two levels: the consumer blocks once and wakes on either
+#define LEVEL_HIGH      0
+#define LEVEL_NORMAL    1
+#define PROCESS_MS      100     // consumer work per message
+#define NORMAL_MAX_WAIT 1000    // aging: a normal message waits at most this long
+#define STORM_EVERY     8       // every 8th high cycle is a burst...
+#define STORM_SIZE      20      // ...of this many messages (2 s of work)
+// Once at the head of its level, a high message waits for the message in
+// progress plus at most one aged normal message (pmb head_max_us)
+#define HIGH_BOUND_MS   (2 * PROCESS_MS + 20)
+
+pmb_t mailbox;
+static const char *level_names[] = {"HIGH", "NORMAL"};
 
 typedef struct {
     char msg[32];
@@ -18,10 +30,19 @@ void producer_high_task(void *pv)
 {
     message_t msg;
     msg.priority = 1;
+    int cycle = 0;
     while (1)
     {
-        sprintf(msg.msg, "High Priority Msg");
-        xQueueSend(high_priority_queue, &msg, pdMS_TO_TICKS(100));
+        int count = (++cycle % STORM_EVERY == 0) ? STORM_SIZE : 1;
+        if (count > 1)
+        {
+            ESP_LOGW(TAG, "🌩️ High-priority storm: %d messages", count);
+        }
+        for (int i = 0; i < count; i++)
+        {
+            sprintf(msg.msg, "High Priority Msg");
+            pmb_post(&mailbox, LEVEL_HIGH, &msg, pdMS_TO_TICKS(100));
+        }
         ESP_LOGW(TAG, "Sent HIGH: %s", msg.msg);
         vTaskDelay(pdMS_TO_TICKS(1500));
     }
@@ -35,7 +56,7 @@ void producer_normal_task(void *pv)
     while (1)
     {
         sprintf(msg.msg, "Normal Msg %d", counter++);
-        xQueueSend(normal_priority_queue, &msg, pdMS_TO_TICKS(100));
+        pmb_post(&mailbox, LEVEL_NORMAL, &msg, pdMS_TO_TICKS(100));
         ESP_LOGI(TAG, "Sent NORMAL: %s", msg.msg);
         vTaskDelay(pdMS_TO_TICKS(800));
     }
@@ -44,32 +65,44 @@ void producer_normal_task(void *pv)
 void consumer_task(void *pv)
 {
     message_t msg;
+    int level;
+    uint32_t latency_us;
+    uint32_t consumed = 0;
     while (1)
     {
-        if (xQueueReceive(high_priority_queue, &msg, pdMS_TO_TICKS(100)) == pdTRUE)
+        if (!pmb_receive(&mailbox, &msg, &level, &latency_us, pdMS_TO_TICKS(5000)))
         {
-            ESP_LOGW(TAG, "⚡ Consumed HIGH: %s", msg.msg);
+            ESP_LOGI(TAG, "No messages, idle...");
+            continue;
         }
-        else if (xQueueReceive(normal_priority_queue, &msg, pdMS_TO_TICKS(100)) == pdTRUE)
+        if (level == LEVEL_HIGH)
         {
-            ESP_LOGI(TAG, "Consumed NORMAL: %s", msg.msg);
+            ESP_LOGW(TAG, "⚡ Consumed HIGH: %s (waited %lu ms)", msg.msg, latency_us / 1000);
         }
         else
         {
-            ESP_LOGI(TAG, "No messages, idle...");
+            ESP_LOGI(TAG, "Consumed NORMAL: %s (waited %lu ms)", msg.msg, latency_us / 1000);
+        }
+        vTaskDelay(pdMS_TO_TICKS(PROCESS_MS));   // simulated processing
+
+        if (++consumed % 50 == 0)
+        {
+            pmb_report(&mailbox, level_names);
+            uint32_t head_max_ms = mailbox.stats[LEVEL_HIGH].head_max_us / 1000;
+            ESP_LOGI(TAG, "HIGH wait at head: max %lu ms, bound %d ms %s", head_max_ms,
+                     HIGH_BOUND_MS, head_max_ms <= HIGH_BOUND_MS ? "✅ held" : "❌ exceeded");
         }
-        vTaskDelay(pdMS_TO_TICKS(300));
     }
 }
 
 void app_main(void)
 {
-    high_priority_queue = xQueueCreate(5, sizeof(message_t));
-    normal_priority_queue = xQueueCreate(15, sizeof(message_t));
+    const UBaseType_t depth[] = {STORM_SIZE + 4, 15};
+    const uint32_t max_wait_ms[] = {0, NORMAL_MAX_WAIT};
 
-    if (!high_priority_queue || !normal_priority_queue)
+    if (!pmb_create(&mailbox, 2, sizeof(message_t), depth, max_wait_ms))
     {
-        ESP_LOGE(TAG, "Failed to create queues!");
+        ESP_LOGE(TAG, "Failed to create mailbox!");
         return;
     }
 
@@ -0,0 +1,127 @@
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "prio_mailbox.h"
+
+static const char *TAG = "PMB";
+
+// Queue slot: post time, then the caller's item
+typedef struct {
+    int64_t t_us;
+    uint8_t data[PMB_MAX_ITEM];
+} pmb_slot_t;
+
+#define SLOT_BYTES(mb) (sizeof(int64_t) + (mb)->item_size)
+
+bool pmb_create(pmb_t *mb, int levels, size_t item_size, const UBaseType_t *depth,
+                const uint32_t *max_wait_ms) {
+    UBaseType_t total = 0;
+
+    memset(mb, 0, sizeof(*mb));
+    if (levels < 1 || levels > PMB_MAX_LEVELS || item_size > PMB_MAX_ITEM)
+        return false;
+    mb->levels = levels;
+    mb->item_size = item_size;
+    for (int i = 0; i < levels; i++) {
+        mb->level[i] = xQueueCreate(depth[i], SLOT_BYTES(mb));
+        mb->max_wait_ms[i] = max_wait_ms ? max_wait_ms[i] : 0;
+        if (!mb->level[i])
+            return false;
+        total += depth[i];
+    }
+    mb->items = xSemaphoreCreateCounting(total, 0);
+    return mb->items != NULL;
+}
+
+bool pmb_post(pmb_t *mb, int level, const void *item, TickType_t timeout) {
+    pmb_slot_t slot;
+
+    slot.t_us = esp_timer_get_time();
+    memcpy(slot.data, item, mb->item_size);
+    if (xQueueSend(mb->level[level], &slot, timeout) != pdTRUE) {
+        __atomic_fetch_add(&mb->stats[level].dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    __atomic_fetch_add(&mb->stats[level].posted, 1, __ATOMIC_RELAXED);
+    // Item first, count second: a woken receiver always finds it
+    xSemaphoreGive(mb->items);
+    return true;
+}
+
+// Most overdue aged level, or the highest non-empty one
+static int pick_level(pmb_t *mb, int64_t now, bool *aged) {
+    int best = -1, highest = -1;
+    int64_t best_over = 0;
+    pmb_slot_t head;
+
+    for (int i = 0; i < mb->levels; i++) {
+        if (uxQueueMessagesWaiting(mb->level[i]) == 0)
+            continue;
+        if (highest < 0)
+            highest = i;
+        if (i == highest || !mb->max_wait_ms[i])
+            continue;
+        if (xQueuePeek(mb->level[i], &head, 0) != pdTRUE)
+            continue;
+        int64_t over = now - head.t_us - (int64_t)mb->max_wait_ms[i] * 1000;
+        if (over > best_over) {
+            best_over = over;
+            best = i;
+        }
+    }
+    *aged = best >= 0;
+    return best >= 0 ? best : highest;
+}
+
+bool pmb_receive(pmb_t *mb, void *item, int *level, uint32_t *latency_us, TickType_t timeout) {
+    pmb_slot_t slot;
+    bool aged;
+
+    if (xSemaphoreTake(mb->items, timeout) != pdTRUE)
+        return false;
+
+    int64_t now = esp_timer_get_time();
+    int lv = pick_level(mb, now, &aged);
+    // Another receiver may have emptied the chosen level; the count still
+    // guarantees an item somewhere, so fall back to a full sweep
+    while (lv < 0 || xQueueReceive(mb->level[lv], &slot, 0) != pdTRUE) {
+        aged = false;
+        for (lv = 0; lv < mb->levels; lv++)
+            if (xQueueReceive(mb->level[lv], &slot, 0) == pdTRUE)
+                break;
+        if (lv < mb->levels)
+            break;
+        lv = -1;
+        taskYIELD();
+    }
+
+    uint32_t lat = (uint32_t)(now - slot.t_us);
+    pmb_level_stats_t *s = &mb->stats[lv];
+    int64_t head_since = slot.t_us > s->last_take_us ? slot.t_us : s->last_take_us;
+    if (now - head_since > s->head_max_us)
+        s->head_max_us = (uint32_t)(now - head_since);
+    s->last_take_us = now;
+    s->received++;
+    s->aged += aged;
+    s->lat_total_us += lat;
+    if (lat > s->lat_max_us)
+        s->lat_max_us = lat;
+
+    memcpy(item, slot.data, mb->item_size);
+    if (level)
+        *level = lv;
+    if (latency_us)
+        *latency_us = lat;
+    return true;
+}
+
+void pmb_report(const pmb_t *mb, const char *const *names) {
+    ESP_LOGI(TAG, "📬 Priority mailbox:");
+    for (int i = 0; i < mb->levels; i++) {
+        const pmb_level_stats_t *s = &mb->stats[i];
+        ESP_LOGI(TAG, "  %-8s posted %lu, received %lu (aged %lu), dropped %lu | latency avg %lu us, max %lu us, at head max %lu us%s",
+                 names ? names[i] : "", s->posted, s->received, s->aged, s->dropped,
+                 s->received ? (uint32_t)(s->lat_total_us / s->received) : 0, s->lat_max_us, s->head_max_us,
+                 mb->max_wait_ms[i] ? "" : " (no aging)");
+    }
+}
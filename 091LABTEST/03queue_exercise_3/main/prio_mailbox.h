@@ -0,0 +1,60 @@
+#ifndef PRIO_MAILBOX_H
+#define PRIO_MAILBOX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+// ============================= PRIORITY MAILBOX =============================
+// N priority levels behind one blocking receive.
+//
+// Each level is a FreeRTOS queue; every post also gives one count on a
+// shared counting semaphore. A receiver blocks on that semaphore only, so
+// it wakes on the first arrival at any level, and a count always stands for
+// an item that is already queued. It then takes the highest non-empty level
+// (0 is the highest).
+//
+// Aging: a level with max_wait_ms > 0 whose oldest item has waited longer
+// than that is served first, ahead of higher levels. If several are
+// overdue, the one furthest past its limit goes first. Items are stamped
+// on post, so every dequeue also yields its queueing latency. The time an
+// item spent at the head of its level (head_max_us) excludes waiting behind
+// its own level, so it is the figure priority and aging bound.
+
+#define PMB_MAX_LEVELS   4
+#define PMB_MAX_ITEM     64
+
+typedef struct {
+    uint32_t posted;
+    uint32_t received;
+    uint32_t aged;          // served ahead of a higher level by aging
+    uint32_t dropped;       // level full
+    uint32_t lat_max_us;    // post to dequeue
+    uint64_t lat_total_us;
+    uint32_t head_max_us;   // at the head of its level: not counting its own backlog
+    int64_t last_take_us;
+} pmb_level_stats_t;
+
+typedef struct {
+    QueueHandle_t level[PMB_MAX_LEVELS];
+    uint32_t max_wait_ms[PMB_MAX_LEVELS];
+    SemaphoreHandle_t items;
+    int levels;
+    size_t item_size;
+    pmb_level_stats_t stats[PMB_MAX_LEVELS];
+} pmb_t;
+
+// depth[i] items at level i; max_wait_ms[i] = 0 disables aging for it
+bool pmb_create(pmb_t *mb, int levels, size_t item_size, const UBaseType_t *depth,
+                const uint32_t *max_wait_ms);
+
+bool pmb_post(pmb_t *mb, int level, const void *item, TickType_t timeout);
+
+// Returns false on timeout. level and latency_us may be NULL.
+bool pmb_receive(pmb_t *mb, void *item, int *level, uint32_t *latency_us, TickType_t timeout);
+
+void pmb_report(const pmb_t *mb, const char *const *names);
+
+#endif
@@ -1,21 +1,50 @@
 #include <stdio.h>
+#include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <stdlib.h>
+#include "dsp_block.h"
 
 static const char *TAG = "QUEUE_EX4";
 
+#define FRAME_MAX_LATENCY_MS 8000   // flush a partial frame after this long
+#define ALERT_THRESHOLD      35.0f
+#define BENCH_FRAMES         200
+#define BENCH_RATE_HZ        10000
+
 typedef struct {
     float value;
     uint32_t timestamp;
 } sensor_data_t;
 
+// One per processed frame instead of one per sample
+typedef struct {
+    float mean, min, max;
+    uint32_t count;
+    uint32_t timestamp;
+} frame_summary_t;
+
+// All threshold crossings of a frame in one message
+typedef struct {
+    uint32_t count;
+    float peak;
+    uint32_t first_timestamp;
+} alert_batch_t;
+
 QueueHandle_t raw_queue;
 QueueHandle_t processed_queue;
 QueueHandle_t alert_queue;
 
+// 8-tap symmetric low-pass, unity DC gain
+static const float fir_coeffs[] = {0.02f, 0.06f, 0.16f, 0.26f, 0.26f, 0.16f, 0.06f, 0.02f};
+
+static dsp_fir_t fir;
+static dsp_median3_t median;
+static dsp_stats_t dsp_stats;
+
 void sensor_reader_task(void *pv)
 {
     sensor_data_t data;
@@ -29,52 +58,165 @@ void sensor_reader_task(void *pv)
     }
 }
 
+// median3 -> FIR low-pass -> threshold, over a whole frame
+static void process_frame(const float *samples, const uint32_t *stamps, int len)
+{
+    float filtered[DSP_FRAME_SIZE];
+    dsp_detect_t detect = {.threshold = ALERT_THRESHOLD};
+
+    int64_t start = esp_timer_get_time();
+    dsp_median3_process(&median, samples, filtered, len);
+    dsp_fir_process(&fir, filtered, filtered, len);
+    dsp_detect_threshold(&detect, filtered, len);
+
+    frame_summary_t summary = {.min = filtered[0], .max = filtered[0], .count = len, .timestamp = stamps[0]};
+    float sum = 0.0f;
+    for (int n = 0; n < len; n++)
+    {
+        sum += filtered[n];
+        summary.min = fminf(summary.min, filtered[n]);
+        summary.max = fmaxf(summary.max, filtered[n]);
+    }
+    summary.mean = sum / len;
+
+    uint32_t frame_ns = (uint32_t)(esp_timer_get_time() - start) * 1000;
+    dsp_stats.frames++;
+    dsp_stats.samples += len;
+    dsp_stats.busy_ns += frame_ns;
+    if (frame_ns > dsp_stats.max_frame_ns)
+        dsp_stats.max_frame_ns = frame_ns;
+
+    xQueueSend(processed_queue, &summary, pdMS_TO_TICKS(100));
+    if (detect.count > 0)
+    {
+        alert_batch_t batch = {
+            .count = detect.count,
+            .peak = detect.peak,
+            .first_timestamp = stamps[detect.first_index],
+        };
+        xQueueSend(alert_queue, &batch, 0);
+    }
+}
+
 void data_processor_task(void *pv)
 {
-    sensor_data_t in, out;
+    sensor_data_t in;
+    float samples[DSP_FRAME_SIZE];
+    uint32_t stamps[DSP_FRAME_SIZE];
+    int fill = 0;
+    TickType_t frame_start = 0;
+
     while (1)
     {
-        if (xQueueReceive(raw_queue, &in, portMAX_DELAY))
+        TickType_t wait = portMAX_DELAY;
+        if (fill > 0)
         {
-            out.value = in.value * 0.98; // filter
-            out.timestamp = in.timestamp;
-            xQueueSend(processed_queue, &out, pdMS_TO_TICKS(100));
-            ESP_LOGI(TAG, "Processed data: %.1f", out.value);
-            if (out.value > 35.0)
-                xQueueSend(alert_queue, &out, 0);
+            TickType_t age = xTaskGetTickCount() - frame_start;
+            wait = age < pdMS_TO_TICKS(FRAME_MAX_LATENCY_MS) ? pdMS_TO_TICKS(FRAME_MAX_LATENCY_MS) - age : 0;
+        }
+
+        if (xQueueReceive(raw_queue, &in, wait))
+        {
+            if (fill == 0)
+                frame_start = xTaskGetTickCount();
+            samples[fill] = in.value;
+            stamps[fill] = in.timestamp;
+            fill++;
+        }
+
+        bool full = (fill == DSP_FRAME_SIZE);
+        bool late = fill > 0 && xTaskGetTickCount() - frame_start >= pdMS_TO_TICKS(FRAME_MAX_LATENCY_MS);
+        if (full || late)
+        {
+            process_frame(samples, stamps, fill);
+            ESP_LOGI(TAG, "Processed frame of %d samples (%.0f ns/sample avg)",
+                     fill, dsp_stats_ns_per_sample(&dsp_stats));
+            fill = 0;
         }
     }
 }
 
 void alert_handler_task(void *pv)
 {
-    sensor_data_t alert;
+    alert_batch_t alert;
     while (1)
     {
         if (xQueueReceive(alert_queue, &alert, portMAX_DELAY))
         {
-            ESP_LOGW(TAG, "ALERT! High temperature: %.1f °C", alert.value);
+            ESP_LOGW(TAG, "ALERT! %lu samples above %.1f °C, peak %.1f °C from @%lu",
+                     alert.count, ALERT_THRESHOLD, alert.peak, alert.first_timestamp);
         }
     }
 }
 
 void logger_task(void *pv)
 {
-    sensor_data_t data;
+    frame_summary_t data;
     while (1)
     {
         if (xQueueReceive(processed_queue, &data, pdMS_TO_TICKS(5000)))
         {
-            ESP_LOGI(TAG, "Logger: %.1f°C @%d", data.value, data.timestamp);
+            ESP_LOGI(TAG, "Logger: %lu samples mean %.1f°C [%.1f..%.1f] @%lu",
+                     data.count, data.mean, data.min, data.max, data.timestamp);
+        }
+    }
+}
+
+// Per-stage cost on a synthetic 10 kHz signal with spikes
+static void dsp_benchmark(void)
+{
+    static float in[DSP_FRAME_SIZE], out[DSP_FRAME_SIZE];
+    dsp_fir_t bench_fir;
+    dsp_median3_t bench_median = {0};
+    dsp_biquad_t bench_iir;
+    dsp_detect_t bench_detect = {.threshold = ALERT_THRESHOLD};
+    int64_t t_median = 0, t_fir = 0, t_iir = 0, t_detect = 0;
+
+    dsp_fir_init(&bench_fir, fir_coeffs, sizeof(fir_coeffs) / sizeof(fir_coeffs[0]));
+    dsp_biquad_lowpass(&bench_iir, 500.0f, BENCH_RATE_HZ);
+
+    for (int f = 0; f < BENCH_FRAMES; f++)
+    {
+        for (int n = 0; n < DSP_FRAME_SIZE; n++)
+        {
+            int i = f * DSP_FRAME_SIZE + n;
+            in[n] = 30.0f + 5.0f * sinf(2.0f * (float)M_PI * 50.0f * i / BENCH_RATE_HZ) + (rand() % 100) / 100.0f;
+            if (rand() % 200 == 0)
+                in[n] += 40.0f;
         }
+
+        int64_t t0 = esp_timer_get_time();
+        dsp_median3_process(&bench_median, in, out, DSP_FRAME_SIZE);
+        int64_t t1 = esp_timer_get_time();
+        dsp_fir_process(&bench_fir, out, out, DSP_FRAME_SIZE);
+        int64_t t2 = esp_timer_get_time();
+        dsp_biquad_process(&bench_iir, out, out, DSP_FRAME_SIZE);
+        int64_t t3 = esp_timer_get_time();
+        dsp_detect_threshold(&bench_detect, out, DSP_FRAME_SIZE);
+        int64_t t4 = esp_timer_get_time();
+
+        t_median += t1 - t0;
+        t_fir += t2 - t1;
+        t_iir += t3 - t2;
+        t_detect += t4 - t3;
     }
+
+    float samples = BENCH_FRAMES * DSP_FRAME_SIZE;
+    float total_ns = (t_median + t_fir + t_iir + t_detect) * 1000.0f / samples;
+    ESP_LOGI(TAG, "=== DSP benchmark: %d frames x %d samples (%s FIR) ===",
+             BENCH_FRAMES, DSP_FRAME_SIZE, DSP_USE_ESP_DSP ? "esp-dsp" : "C");
+    ESP_LOGI(TAG, "median3 %.0f ns | FIR %.0f ns | IIR %.0f ns | detect %.0f ns per sample",
+             t_median * 1000.0f / samples, t_fir * 1000.0f / samples,
+             t_iir * 1000.0f / samples, t_detect * 1000.0f / samples);
+    ESP_LOGI(TAG, "Total %.0f ns/sample -> %.2f%% CPU at %d Hz",
+             total_ns, total_ns * BENCH_RATE_HZ / 1e7f, BENCH_RATE_HZ);
 }
 
 void app_main(void)
 {
-    raw_queue = xQueueCreate(10, sizeof(sensor_data_t));
-    processed_queue = xQueueCreate(10, sizeof(sensor_data_t));
-    alert_queue = xQueueCreate(5, sizeof(sensor_data_t));
+    raw_queue = xQueueCreate(DSP_FRAME_SIZE, sizeof(sensor_data_t));
+    processed_queue = xQueueCreate(10, sizeof(frame_summary_t));
+    alert_queue = xQueueCreate(5, sizeof(alert_batch_t));
 
     if (!raw_queue || !processed_queue || !alert_queue)
     {
@@ -82,8 +224,11 @@ void app_main(void)
         return;
     }
 
+    dsp_benchmark();
+    dsp_fir_init(&fir, fir_coeffs, sizeof(fir_coeffs) / sizeof(fir_coeffs[0]));
+
     xTaskCreate(sensor_reader_task, "Sensor", 2048, NULL, 3, NULL);
-    xTaskCreate(data_processor_task, "Processor", 3072, NULL, 3, NULL);
+    xTaskCreate(data_processor_task, "Processor", 4096, NULL, 3, NULL);
     xTaskCreate(alert_handler_task, "Alert", 2048, NULL, 4, NULL);
     xTaskCreate(logger_task, "Logger", 2048, NULL, 2, NULL);
 }
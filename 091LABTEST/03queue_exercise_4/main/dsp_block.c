@@ -0,0 +1,148 @@
+#include <string.h>
+#include <math.h>
+#include "dsp_block.h"
+
+// Keep the hot loops free of aliasing so GCC can vectorize them at -O2/-O3
+#define DSP_RESTRICT __restrict__
+
+// ====================== FIR ======================
+
+void dsp_fir_init(dsp_fir_t *f, const float *coeffs, int taps)
+{
+    if (taps > DSP_FIR_MAX_TAPS)
+        taps = DSP_FIR_MAX_TAPS;
+
+    memset(f, 0, sizeof(*f));
+    f->taps = taps;
+    // Reverse once so coeffs[0] pairs with the oldest sample, like esp-dsp
+    for (int k = 0; k < taps; k++)
+        f->coeffs[k] = coeffs[taps - 1 - k];
+
+#if DSP_USE_ESP_DSP
+    dsps_fir_init_f32(&f->esp_fir, f->coeffs, f->esp_delay, taps);
+#endif
+}
+
+void dsp_fir_process(dsp_fir_t *f, const float *in, float *out, int len)
+{
+#if DSP_USE_ESP_DSP
+    dsps_fir_f32(&f->esp_fir, in, out, len);
+#else
+    const int hist = f->taps - 1;
+    float *DSP_RESTRICT buf = f->work;
+    float *DSP_RESTRICT y = out;
+
+    memcpy(buf + hist, in, len * sizeof(float));
+
+    // Tap-outer / sample-inner: each pass is a plain multiply-add over the
+    // frame, which vectorizes without reassociating float sums
+    for (int n = 0; n < len; n++)
+        y[n] = 0.0f;
+    for (int k = 0; k < f->taps; k++)
+    {
+        const float c = f->coeffs[k];
+        const float *DSP_RESTRICT x = buf + k;
+        for (int n = 0; n < len; n++)
+            y[n] += c * x[n];
+    }
+
+    memmove(buf, buf + len, hist * sizeof(float));
+#endif
+}
+
+// ====================== IIR ======================
+
+// RBJ cookbook low-pass, Q = 1/sqrt(2)
+void dsp_biquad_lowpass(dsp_biquad_t *q, float cutoff_hz, float sample_hz)
+{
+    float w0 = 2.0f * (float)M_PI * cutoff_hz / sample_hz;
+    float alpha = sinf(w0) / (2.0f * 0.70710678f);
+    float cosw = cosf(w0);
+    float a0 = 1.0f + alpha;
+
+    q->b0 = (1.0f - cosw) / 2.0f / a0;
+    q->b1 = (1.0f - cosw) / a0;
+    q->b2 = q->b0;
+    q->a1 = -2.0f * cosw / a0;
+    q->a2 = (1.0f - alpha) / a0;
+    q->z1 = q->z2 = 0.0f;
+}
+
+// Recursive, so one sample at a time; state stays in registers for the frame
+void dsp_biquad_process(dsp_biquad_t *q, const float *in, float *out, int len)
+{
+    float z1 = q->z1, z2 = q->z2;
+    for (int n = 0; n < len; n++)
+    {
+        float x = in[n];
+        float y = q->b0 * x + z1;
+        z1 = q->b1 * x - q->a1 * y + z2;
+        z2 = q->b2 * x - q->a2 * y;
+        out[n] = y;
+    }
+    q->z1 = z1;
+    q->z2 = z2;
+}
+
+// ====================== MEDIAN ======================
+
+void dsp_median3_process(dsp_median3_t *m, const float *in, float *out, int len)
+{
+    float buf[DSP_FRAME_SIZE + 2];
+    const float *DSP_RESTRICT x = buf;
+    float *DSP_RESTRICT y = out;
+
+    if (!m->primed)
+    {
+        m->prev[0] = m->prev[1] = in[0];
+        m->primed = true;
+    }
+    buf[0] = m->prev[0];
+    buf[1] = m->prev[1];
+    memcpy(buf + 2, in, len * sizeof(float));
+
+    // Branch-free min/max network
+    for (int n = 0; n < len; n++)
+    {
+        float a = x[n], b = x[n + 1], c = x[n + 2];
+        y[n] = fmaxf(fminf(a, b), fminf(fmaxf(a, b), c));
+    }
+
+    m->prev[0] = buf[len];
+    m->prev[1] = buf[len + 1];
+}
+
+// ====================== DETECTION ======================
+
+void dsp_detect_threshold(dsp_detect_t *d, const float *in, int len)
+{
+    const float thr = d->threshold;
+    uint32_t count = 0;
+    float peak = -INFINITY;
+
+    for (int n = 0; n < len; n++)
+    {
+        count += (in[n] > thr);
+        peak = fmaxf(peak, in[n]);
+    }
+
+    d->count = count;
+    d->peak = peak;
+    d->first_index = -1;
+    if (count > 0)
+    {
+        for (int n = 0; n < len; n++)
+        {
+            if (in[n] > thr)
+            {
+                d->first_index = n;
+                break;
+            }
+        }
+    }
+}
+
+float dsp_stats_ns_per_sample(const dsp_stats_t *s)
+{
+    return s->samples ? (float)s->busy_ns / s->samples : 0.0f;
+}
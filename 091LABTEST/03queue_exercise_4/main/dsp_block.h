@@ -0,0 +1,76 @@
+#ifndef DSP_BLOCK_H
+#define DSP_BLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Block-processing DSP stage: samples are collected into frames and every
+// filter runs over a whole frame in flat loops the compiler can vectorize.
+// With the esp-dsp component and CONFIG_DSP_OPTIMIZED the FIR runs on the
+// esp-dsp assembly kernels (PIE on ESP32-S3) instead.
+
+#define DSP_FRAME_SIZE   64
+#define DSP_FIR_MAX_TAPS 16
+
+#if defined(CONFIG_DSP_OPTIMIZED) && __has_include("dsps_fir.h")
+#define DSP_USE_ESP_DSP 1
+#include "dsps_fir.h"
+#else
+#define DSP_USE_ESP_DSP 0
+#endif
+
+typedef struct
+{
+    int taps;
+    float coeffs[DSP_FIR_MAX_TAPS];                        // time-reversed
+    float work[DSP_FIR_MAX_TAPS - 1 + DSP_FRAME_SIZE];     // history + frame
+#if DSP_USE_ESP_DSP
+    fir_f32_t esp_fir;
+    float esp_delay[DSP_FIR_MAX_TAPS];
+#endif
+} dsp_fir_t;
+
+// Direct form II transposed biquad
+typedef struct
+{
+    float b0, b1, b2, a1, a2;
+    float z1, z2;
+} dsp_biquad_t;
+
+// Median-of-3 spike filter, keeps the last two samples across frames
+typedef struct
+{
+    float prev[2];
+    bool primed;
+} dsp_median3_t;
+
+typedef struct
+{
+    float threshold;
+    uint32_t count;          // samples above threshold in the frame
+    int first_index;         // -1 if none
+    float peak;
+} dsp_detect_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t samples;
+    uint64_t busy_ns;
+    uint32_t max_frame_ns;
+} dsp_stats_t;
+
+void dsp_fir_init(dsp_fir_t *f, const float *coeffs, int taps);
+void dsp_fir_process(dsp_fir_t *f, const float *in, float *out, int len);
+
+void dsp_biquad_lowpass(dsp_biquad_t *q, float cutoff_hz, float sample_hz);
+void dsp_biquad_process(dsp_biquad_t *q, const float *in, float *out, int len);
+
+void dsp_median3_process(dsp_median3_t *m, const float *in, float *out, int len);
+
+void dsp_detect_threshold(dsp_detect_t *d, const float *in, int len);
+
+// ns per sample averaged over everything processed so far
+float dsp_stats_ns_per_sample(const dsp_stats_t *s);
+
+#endif
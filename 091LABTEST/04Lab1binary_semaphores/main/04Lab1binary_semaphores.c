@@ -8,6 +8,7 @@
 #include "esp_timer.h"
 #include "driver/gpio.h"
 #include "esp_random.h"
+#include "fast_signal.h"
 
 static const char *TAG = "BINARY_SEM_CHALLENGE";
 
@@ -37,7 +38,9 @@ system_stats_t stats = {0, 0, 0, 0, 0};
 // --------------------------
 // 🔐 SEMAPHORE
 // --------------------------
-SemaphoreHandle_t xBinarySemaphore;
+// Two consumers wait on it, so fsig falls back to a binary semaphore
+#define CONSUMER_COUNT 2
+fsig_t xEventSignal;
 
 // --------------------------
 // ⏱️ Utility
@@ -51,7 +54,7 @@ uint64_t get_time_ms() {
 // --------------------------
 static void IRAM_ATTR button_isr(void *arg) {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    xSemaphoreGiveFromISR(xBinarySemaphore, &xHigherPriorityTaskWoken);
+    fsig_give_from_isr(&xEventSignal, &xHigherPriorityTaskWoken);
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
@@ -67,7 +70,7 @@ void producer_task(void *pvParameters) {
         counter++;
         stats.events_sent++;
 
-        if (xSemaphoreGive(xBinarySemaphore) == pdPASS) {
+        if (fsig_give(&xEventSignal)) {
             ESP_LOGI(TAG, "🔥 Producer: Event #%d signaled", counter);
             gpio_set_level(LED_PRODUCER, 1);
             vTaskDelay(pdMS_TO_TICKS(100));
@@ -93,7 +96,7 @@ void consumer_task(void *param) {
         ESP_LOGI(TAG, "%s waiting for event...", name);
         uint64_t start = get_time_ms();
 
-        if (xSemaphoreTake(xBinarySemaphore, pdMS_TO_TICKS(MAX_TIMEOUT_MS)) == pdTRUE) {
+        if (fsig_wait(&xEventSignal, pdMS_TO_TICKS(MAX_TIMEOUT_MS))) {
             uint64_t end = get_time_ms();
             double resp = (double)(end - start);
 
@@ -110,14 +113,6 @@ void consumer_task(void *param) {
         } else {
             stats.timeouts++;
             ESP_LOGW(TAG, "⏰ %s: Timeout waiting for event!", name);
-
-            // Recovery mechanism
-            if (xBinarySemaphore == NULL) {
-                ESP_LOGE(TAG, "%s: Semaphore corrupted! Recreating...", name);
-                xBinarySemaphore = xSemaphoreCreateBinary();
-                if (xBinarySemaphore != NULL)
-                    ESP_LOGI(TAG, "%s: Semaphore recovered ✅", name);
-            }
         }
 
         vTaskDelay(pdMS_TO_TICKS(1000));
@@ -155,15 +150,15 @@ void app_main(void) {
     gpio_set_pull_mode(BUTTON_PIN, GPIO_PULLUP_ONLY);
     gpio_set_intr_type(BUTTON_PIN, GPIO_INTR_NEGEDGE);
 
-    gpio_install_isr_service(0);
-    gpio_isr_handler_add(BUTTON_PIN, button_isr, NULL);
-
-    // Create semaphore
-    xBinarySemaphore = xSemaphoreCreateBinary();
-    if (!xBinarySemaphore) {
+    // Create the signal before the ISR can give it
+    if (!fsig_create(&xEventSignal, CONSUMER_COUNT, 0)) {
         ESP_LOGE(TAG, "Failed to create semaphore!");
         return;
     }
+    ESP_LOGI(TAG, "Event signal mode: %s", fsig_mode_name(&xEventSignal));
+
+    gpio_install_isr_service(0);
+    gpio_isr_handler_add(BUTTON_PIN, button_isr, NULL);
 
     // Create tasks
     xTaskCreate(producer_task, "Producer", 2048, NULL, 5, NULL);
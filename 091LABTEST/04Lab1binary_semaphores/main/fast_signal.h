@@ -0,0 +1,50 @@
+#ifndef FAST_SIGNAL_H
+#define FAST_SIGNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+// ============================= FAST SIGNAL =============================
+// Binary "something happened" signal. When created for a single waiter it
+// rides on a direct-to-task notification slot (no kernel object, no extra
+// RAM, shorter wake path); otherwise it is an ordinary binary semaphore.
+// Callers use the same give/wait API either way.
+//
+// In notification mode the waiter is bound on its first fsig_wait(); a give
+// that happens before that is remembered and consumed by the first wait.
+// Each signal owned by the same task needs its own channel, and channel
+// must be below configTASK_NOTIFICATION_ARRAY_ENTRIES, else the signal
+// falls back to a semaphore.
+
+typedef enum {
+    FSIG_NOTIFY,
+    FSIG_SEMAPHORE,
+} fsig_mode_t;
+
+typedef struct {
+    fsig_mode_t mode;
+    UBaseType_t channel;
+    TaskHandle_t owner;
+    uint32_t early;          // give seen before the waiter was bound
+    SemaphoreHandle_t sem;
+} fsig_t;
+
+// max_waiters == 1 selects the notification path when the channel allows it
+bool fsig_create(fsig_t *s, int max_waiters, UBaseType_t channel);
+void fsig_delete(fsig_t *s);
+
+// false only if a semaphore-mode signal was already given
+bool fsig_give(fsig_t *s);
+void fsig_give_from_isr(fsig_t *s, BaseType_t *woken);
+bool fsig_wait(fsig_t *s, TickType_t timeout);
+
+const char *fsig_mode_name(const fsig_t *s);
+
+// Kernel memory the signal costs on top of the fsig_t itself
+size_t fsig_kernel_bytes(const fsig_t *s);
+
+#endif
@@ -8,6 +8,9 @@
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "esp_random.h"
+#include "admission.h"
+#include "pool_health.h"
+#include "shard_counter.h"
 
 static const char *TAG = "COUNTING_SEM_CHALLENGE";
 
@@ -21,6 +24,23 @@ static const char *TAG = "COUNTING_SEM_CHALLENGE";
 #define MAX_PRODUCERS 6
 #define MIN_RESOURCES 2
 
+// Admission classes: even producers get twice the share and a faster bucket
+#define CLASS_HIGH_WEIGHT     2
+#define CLASS_HIGH_PER_MINUTE 30
+#define CLASS_HIGH_BURST      3
+#define CLASS_LOW_WEIGHT      1
+#define CLASS_LOW_PER_MINUTE  20
+#define CLASS_LOW_BURST       2
+
+// Fault injection benchmark: one resource fails for FAULT_DURATION_MS every
+// FAULT_PERIOD_MS; throughput is a sliding window of TPUT_WINDOW samples
+#define FAULT_PERIOD_MS    25000
+#define FAULT_DURATION_MS  5000
+#define TPUT_SAMPLE_MS     500
+#define TPUT_WINDOW        16
+#define TPUT_RECOVERED_PCT 90
+#define RECOVERY_GIVEUP_MS 30000
+
 typedef struct {
     int id;
     bool in_use;
@@ -30,18 +50,21 @@ typedef struct {
     uint32_t total_time;
 } resource_t;
 
+// Request counters are bumped by six producers on both cores (shard_counter.h)
 typedef struct {
-    uint32_t req_total;
-    uint32_t req_success;
-    uint32_t req_fail;
-    uint32_t res_failed;
-    float utilization;
+    sc_counter_t req_total;
+    sc_counter_t req_success;
+    sc_counter_t req_fail;
+    sc_counter_t req_limited;
+    sc_counter_t res_failed;
+    float utilization;      // written by the monitor only
 } stats_t;
 
 resource_t pool[MAX_RESOURCES];
-SemaphoreHandle_t xCountingSem;
-QueueHandle_t tokenQueue;
-stats_t stats = {0};
+admission_t admission;
+pool_health_t health;
+int class_high, class_low;
+stats_t stats;
 
 void blink_led(gpio_num_t pin, int count, int delay) {
     for (int i = 0; i < count; i++) {
@@ -52,22 +75,16 @@ void blink_led(gpio_num_t pin, int count, int delay) {
     }
 }
 
-// Acquire available resource
-int acquire_resource(const char *user) {
-    for (int i = 0; i < MAX_RESOURCES; i++) {
-        if (!pool[i].in_use && !pool[i].failed) {
-            pool[i].in_use = true;
-            strcpy(pool[i].owner, user);
-            pool[i].usage_count++;
-            switch (i) {
-                case 0: gpio_set_level(LED_R1, 1); break;
-                case 1: gpio_set_level(LED_R2, 1); break;
-                case 2: gpio_set_level(LED_R3, 1); break;
-            }
-            return i;
-        }
+// Mark a resource handed out by the admission controller as ours
+void claim_resource(int idx, const char *user) {
+    pool[idx].in_use = true;
+    strcpy(pool[idx].owner, user);
+    pool[idx].usage_count++;
+    switch (idx) {
+        case 0: gpio_set_level(LED_R1, 1); break;
+        case 1: gpio_set_level(LED_R2, 1); break;
+        case 2: gpio_set_level(LED_R3, 1); break;
     }
-    return -1;
 }
 
 // Release resource
@@ -89,31 +106,34 @@ void producer_task(void *pv) {
     char name[16];
     snprintf(name, sizeof(name), "Producer%d", id);
     int priority = (id % 2 == 0) ? 2 : 1; // even-numbered producers = higher priority
+    int client = admission_register(&admission, name, priority == 2 ? class_high : class_low);
     ESP_LOGI(TAG, "%s started (priority %d)", name, priority);
 
     while (1) {
-        stats.req_total++;
-        if (xSemaphoreTake(xCountingSem, pdMS_TO_TICKS(5000)) == pdTRUE) {
-            int token;
-            if (xQueueReceive(tokenQueue, &token, 0) == pdTRUE) {
-                int idx = acquire_resource(name);
-                if (idx >= 0) {
-                    ESP_LOGI(TAG, "✓ %s: acquired resource %d", name, idx + 1);
-                    uint32_t usage = 500 + (esp_random() % 2000);
-                    vTaskDelay(pdMS_TO_TICKS(usage));
-                    release_resource(idx, usage);
-                    xSemaphoreGive(xCountingSem);
-                    xQueueSend(tokenQueue, &token, 0);
-                    stats.req_success++;
-                } else {
-                    ESP_LOGW(TAG, "✗ %s: no resource available", name);
-                    stats.req_fail++;
-                    xSemaphoreGive(xCountingSem);
-                }
+        sc_inc(&stats.req_total);
+        int idx = admission_acquire(&admission, client, pdMS_TO_TICKS(5000));
+        if (idx >= 0) {
+            if (!pool[idx].failed) {
+                claim_resource(idx, name);
+                ESP_LOGI(TAG, "✓ %s: acquired resource %d", name, idx + 1);
+                uint32_t usage = 500 + (esp_random() % 2000);
+                vTaskDelay(pdMS_TO_TICKS(usage));
+                release_resource(idx, usage);
+                sc_inc(&stats.req_success);
+            } else {
+                // Breaker opens now; the slot is parked on release and
+                // nobody is handed it again until it passes probation
+                ESP_LOGW(TAG, "✗ %s: resource %d has failed", name, idx + 1);
+                pool_health_report_error(&health, idx);
+                sc_inc(&stats.req_fail);
             }
+            admission_release(&admission, idx);
+        } else if (idx == ADMIT_RATE_LIMITED) {
+            ESP_LOGW(TAG, "🚦 %s: over its request rate, backing off", name);
+            sc_inc(&stats.req_limited);
         } else {
-            ESP_LOGW(TAG, "⏰ %s: timeout waiting for semaphore", name);
-            stats.req_fail++;
+            ESP_LOGW(TAG, "⏰ %s: timeout waiting for a resource", name);
+            sc_inc(&stats.req_fail);
         }
 
         vTaskDelay(pdMS_TO_TICKS(2000 + (esp_random() % 2000)));
@@ -124,30 +144,92 @@ void producer_task(void *pv) {
 void scaling_task(void *pv) {
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(15000));
-        float load = (float)stats.req_success / (stats.req_total + 1);
-        if (load < 0.75 && uxSemaphoreGetCount(xCountingSem) < MAX_RESOURCES) {
-            xSemaphoreGive(xCountingSem);
+        float load = (float)sc_read(&stats.req_success) / (sc_read(&stats.req_total) + 1);
+        int capacity = admission_budget(&admission);
+        if (load < 0.75 && capacity < MAX_RESOURCES) {
+            admission_set_capacity(&admission, capacity + 1);
             ESP_LOGI(TAG, "⚙️ Load low, increasing available resource slot");
-        } else if (load > 0.95 && uxSemaphoreGetCount(xCountingSem) > MIN_RESOURCES) {
-            xSemaphoreTake(xCountingSem, 0);
+        } else if (load > 0.95 && capacity > MIN_RESOURCES) {
+            admission_set_capacity(&admission, capacity - 1);
             ESP_LOGW(TAG, "⚠️ Load high, temporarily reducing resource slot");
         }
     }
 }
 
-// Failure simulation
+// Health probe: the simulated hardware reports its fault flag
+bool probe_resource(int idx, void *ctx) {
+    return !pool[idx].failed;
+}
+
+// Failure simulation + fault-injection benchmark. Measures how long the
+// breaker takes to open, how long a repaired resource takes to pass
+// probation, and when throughput is back to TPUT_RECOVERED_PCT of the
+// pre-fault baseline.
 void failure_task(void *pv) {
+    uint32_t ring[TPUT_WINDOW] = {0};
+    int head = 0;
+    int idx = -1;
+    float baseline = 0, dip = 0;
+    int64_t t_inject = 0, t_detect = 0, t_repair = 0, t_online = 0;
+    int64_t next_fault = esp_timer_get_time() + (int64_t)FAULT_PERIOD_MS * 1000;
+
     while (1) {
-        vTaskDelay(pdMS_TO_TICKS(25000));
-        int idx = esp_random() % MAX_RESOURCES;
-        if (!pool[idx].failed) {
+        vTaskDelay(pdMS_TO_TICKS(TPUT_SAMPLE_MS));
+        int64_t now = esp_timer_get_time();
+
+        uint32_t done = sc_read(&stats.req_success);
+        float rate = (done - ring[head]) * 1000.0f / (TPUT_WINDOW * TPUT_SAMPLE_MS);
+        ring[head] = done;
+        head = (head + 1) % TPUT_WINDOW;
+
+        if (idx < 0) {
+            if (now < next_fault)
+                continue;
+            idx = esp_random() % MAX_RESOURCES;
+            if (pool_health_state(&health, idx) != RES_HEALTHY) {
+                idx = -1;
+                continue;
+            }
             pool[idx].failed = true;
-            stats.res_failed++;
-            ESP_LOGE(TAG, "💥 Resource %d FAILED!", idx + 1);
-            blink_led(LED_SYSTEM, 3, 150);
-            vTaskDelay(pdMS_TO_TICKS(5000));
-            pool[idx].failed = false;
-            ESP_LOGI(TAG, "🧩 Resource %d recovered.", idx + 1);
+            sc_inc(&stats.res_failed);
+            baseline = dip = rate;
+            t_inject = now;
+            t_detect = t_repair = t_online = 0;
+            next_fault = now + (int64_t)FAULT_PERIOD_MS * 1000;
+            gpio_set_level(LED_SYSTEM, 1);
+            ESP_LOGE(TAG, "💥 Resource %d FAILED! (baseline %.2f req/s)", idx + 1, baseline);
+            continue;
+        }
+
+        if (rate < dip)
+            dip = rate;
+        res_health_t state = pool_health_state(&health, idx);
+        if (t_detect == 0 && state != RES_HEALTHY)
+            t_detect = now;
+
+        if (t_repair == 0) {
+            if (now - t_inject >= (int64_t)FAULT_DURATION_MS * 1000) {
+                pool[idx].failed = false;
+                t_repair = now;
+                gpio_set_level(LED_SYSTEM, 0);
+                ESP_LOGI(TAG, "🧩 Resource %d repaired.", idx + 1);
+            }
+            continue;
+        }
+
+        if (t_online == 0 && state == RES_HEALTHY)
+            t_online = now;
+
+        bool recovered = t_online && rate >= baseline * TPUT_RECOVERED_PCT / 100;
+        if (recovered || now - t_repair >= (int64_t)RECOVERY_GIVEUP_MS * 1000) {
+            ESP_LOGI(TAG, "🧪 Fault on R%d: detected +%lld ms | back online +%lld ms after repair | "
+                     "throughput %.2f -> %.2f req/s, %s +%lld ms after repair",
+                     idx + 1,
+                     t_detect ? (t_detect - t_inject) / 1000 : -1,
+                     t_online ? (t_online - t_repair) / 1000 : -1,
+                     baseline, dip, recovered ? "recovered" : "NOT recovered",
+                     (now - t_repair) / 1000);
+            idx = -1;
         }
     }
 }
@@ -156,45 +238,96 @@ void failure_task(void *pv) {
 void monitor_task(void *pv) {
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(10000));
-        int available = uxSemaphoreGetCount(xCountingSem);
-        int used = MAX_RESOURCES - available;
+        int available = admission_free_count(&admission);
+        int used = admission_capacity(&admission) - available;
         stats.utilization = ((float)used / MAX_RESOURCES) * 100;
         ESP_LOGI(TAG, "\n📊 SYSTEM STATUS");
-        ESP_LOGI(TAG, "Requests: %lu | Success: %lu | Fail: %lu", stats.req_total, stats.req_success, stats.req_fail);
-        ESP_LOGI(TAG, "Resources failed: %lu", stats.res_failed);
+        ESP_LOGI(TAG, "Requests: %lu | Success: %lu | Fail: %lu | Rate limited: %lu",
+                 sc_read(&stats.req_total), sc_read(&stats.req_success),
+                 sc_read(&stats.req_fail), sc_read(&stats.req_limited));
+        ESP_LOGI(TAG, "Resources failed: %lu", sc_read(&stats.res_failed));
         ESP_LOGI(TAG, "Utilization: %.1f%%", stats.utilization);
         for (int i = 0; i < MAX_RESOURCES; i++) {
-            ESP_LOGI(TAG, "  Resource %d: %s%s", i + 1,
-                     pool[i].failed ? "FAILED " : (pool[i].in_use ? "IN USE" : "FREE"),
+            res_health_t state = pool_health_state(&health, i);
+            ESP_LOGI(TAG, "  Resource %d: %s %s", i + 1,
+                     state != RES_HEALTHY ? pool_health_state_name(state) : (pool[i].in_use ? "IN USE" : "FREE"),
                      pool[i].in_use ? pool[i].owner : "");
         }
+        admission_report(&admission);
+        pool_health_report(&health);
         ESP_LOGI(TAG, "══════════════════════════════");
     }
 }
 
+// Startup check of hot-spare promotion on a scratch pool: with a budget of
+// MIN_RESOURCES, quarantining a resource inside the budget must promote the
+// spare, so capacity stays at the budget until no spare is left
+static bool check_failover(void) {
+    static admission_t a;
+    bool ok = true;
+
+    admission_init(&a, MAX_RESOURCES);
+    int cls = admission_add_class(&a, "check", 1, 600, MAX_RESOURCES);
+    int client = admission_register(&a, "check", cls);
+    admission_set_capacity(&a, MIN_RESOURCES);
+
+    admission_set_online(&a, 0, false);
+    ok &= admission_capacity(&a) == MIN_RESOURCES;
+    ok &= admission_free_count(&a) == MIN_RESOURCES;
+    int first = admission_acquire(&a, client, 0);
+    int second = admission_acquire(&a, client, 0);
+    ok &= first == 1 && second == 2;
+    admission_release(&a, first);
+    admission_release(&a, second);
+
+    // No spare left for a second failure; recovery restores the budget
+    admission_set_online(&a, 1, false);
+    ok &= admission_capacity(&a) == MIN_RESOURCES - 1;
+    admission_set_online(&a, 0, true);
+    admission_set_online(&a, 1, true);
+    ok &= admission_capacity(&a) == MIN_RESOURCES && admission_budget(&a) == MIN_RESOURCES;
+
+    ESP_LOGI(TAG, "%s Failover check: quarantine inside the budget %s",
+             ok ? "✅" : "❌", ok ? "promotes a spare" : "lost capacity");
+    return ok;
+}
+
 void app_main(void) {
     gpio_set_direction(LED_R1, GPIO_MODE_OUTPUT);
     gpio_set_direction(LED_R2, GPIO_MODE_OUTPUT);
     gpio_set_direction(LED_R3, GPIO_MODE_OUTPUT);
     gpio_set_direction(LED_SYSTEM, GPIO_MODE_OUTPUT);
 
-    xCountingSem = xSemaphoreCreateCounting(MAX_RESOURCES, MAX_RESOURCES);
-    tokenQueue = xQueueCreate(MAX_PRODUCERS, sizeof(int));
-    for (int i = 0; i < MAX_PRODUCERS; i++) {
-        xQueueSend(tokenQueue, &i, 0);
-    }
+    check_failover();
 
-    if (!xCountingSem || !tokenQueue) {
+    admission_init(&admission, MAX_RESOURCES);
+    class_high = admission_add_class(&admission, "high", CLASS_HIGH_WEIGHT,
+                                     CLASS_HIGH_PER_MINUTE, CLASS_HIGH_BURST);
+    class_low = admission_add_class(&admission, "low", CLASS_LOW_WEIGHT,
+                                    CLASS_LOW_PER_MINUTE, CLASS_LOW_BURST);
+    if (class_high < 0 || class_low < 0) {
         ESP_LOGE(TAG, "Initialization failed!");
         return;
     }
 
+    sc_register(&stats.req_total, "requests_total", "Resource requests made by producers", SC_COUNTER);
+    sc_register(&stats.req_success, "requests_success", "Requests served by a healthy resource", SC_COUNTER);
+    sc_register(&stats.req_fail, "requests_failed", "Requests that timed out or hit a failed resource", SC_COUNTER);
+    sc_register(&stats.req_limited, "requests_rate_limited", "Requests refused by the rate limiter", SC_COUNTER);
+    sc_register(&stats.res_failed, "resources_failed", "Injected resource faults", SC_COUNTER);
+
     for (int i = 0; i < MAX_RESOURCES; i++) {
         pool[i].id = i + 1;
         pool[i].in_use = false;
         pool[i].failed = false;
     }
 
+    pool_health_init(&health, &admission, probe_resource, NULL);
+    if (!pool_health_start(&health, 5)) {
+        ESP_LOGE(TAG, "Health monitor start failed!");
+        return;
+    }
+
     static int ids[MAX_PRODUCERS] = {1, 2, 3, 4, 5, 6};
     for (int i = 0; i < MAX_PRODUCERS; i++) {
         char tname[16];
@@ -204,7 +337,7 @@ void app_main(void) {
 
     xTaskCreate(monitor_task, "Monitor", 3072, NULL, 2, NULL);
     xTaskCreate(scaling_task, "Scaling", 2048, NULL, 2, NULL);
-    xTaskCreate(failure_task, "Failure", 2048, NULL, 2, NULL);
+    xTaskCreate(failure_task, "Failure", 3072, NULL, 2, NULL);
 
     ESP_LOGI(TAG, "💡 Counting Semaphore Challenge Started!");
 }
@@ -0,0 +1,311 @@
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "admission.h"
+
+static const char *TAG = "ADMISSION";
+
+// One request at weight 1 advances a client's virtual clock by this much
+#define ADMIT_TAG_UNIT (1u << 16)
+
+// ================ HELPERS (call with the lock held) ================
+
+static void refill(admit_class_t *k, int64_t now) {
+    uint64_t add = (uint64_t)(now - k->last_refill_us) * k->rate_milli / 1000000;
+    if (add == 0)
+        return;
+    uint64_t tokens = k->tokens_milli + add;
+    k->tokens_milli = tokens > k->burst * 1000 ? k->burst * 1000 : (uint32_t)tokens;
+    k->last_refill_us = now;
+}
+
+static void record_grant(admit_client_t *c, uint32_t wait_us) {
+    uint32_t ms = wait_us / 1000;
+    int b = ms ? 32 - __builtin_clz(ms) : 0;
+
+    c->grants++;
+    c->wait_sum_us += wait_us;
+    if (wait_us > c->wait_max_us)
+        c->wait_max_us = wait_us;
+    c->wait_hist[b < ADMIT_WAIT_BUCKETS ? b : ADMIT_WAIT_BUCKETS - 1]++;
+}
+
+// Hands every free enabled resource to the waiter with the smallest finish
+// tag. Tasks to wake are returned so they can be notified after unlocking.
+static int dispatch(admission_t *a, TaskHandle_t *wake) {
+    int n = 0;
+    uint32_t avail;
+
+    while ((avail = a->free_mask & a->enabled_mask & a->online_mask) != 0) {
+        admit_client_t *next = NULL;
+        for (int i = 0; i < a->n_clients; i++) {
+            admit_client_t *c = &a->clients[i];
+            if (c->waiting && c->granted < 0 && (next == NULL || c->wait_tag < next->wait_tag))
+                next = c;
+        }
+        if (next == NULL)
+            break;
+
+        int idx = __builtin_ctz(avail);
+        a->free_mask &= ~(1u << idx);
+        next->granted = idx;
+        if (next->start_tag > a->vtime)
+            a->vtime = next->start_tag;
+        wake[n++] = next->task;
+    }
+    return n;
+}
+
+// The budget is a count of online resources: enable the first budget of
+// them, so a healthy spare takes the place of a quarantined one
+static void apply_budget(admission_t *a) {
+    uint32_t online = a->online_mask;
+    uint32_t enabled = 0;
+
+    for (int n = 0; n < a->budget && online; n++) {
+        uint32_t lowest = online & -online;
+        enabled |= lowest;
+        online &= ~lowest;
+    }
+    a->enabled_mask = enabled;
+}
+
+static void wake_all(TaskHandle_t *wake, int n) {
+    for (int i = 0; i < n; i++)
+        xTaskNotifyGive(wake[i]);
+}
+
+// ================ SETUP ================
+
+void admission_init(admission_t *a, int resources) {
+    if (resources > ADMIT_MAX_RESOURCES)
+        resources = ADMIT_MAX_RESOURCES;
+
+    memset(a, 0, sizeof(*a));
+    portMUX_INITIALIZE(&a->lock);
+    a->resources = resources;
+    a->all_mask = resources == 32 ? UINT32_MAX : (1u << resources) - 1;
+    a->budget = resources;
+    a->enabled_mask = a->all_mask;
+    a->online_mask = a->all_mask;
+    a->free_mask = a->all_mask;
+}
+
+int admission_add_class(admission_t *a, const char *name, uint32_t weight,
+                        uint32_t per_minute, uint32_t burst) {
+    if (a->n_classes >= ADMIT_MAX_CLASSES || weight == 0)
+        return -1;
+
+    admit_class_t *k = &a->classes[a->n_classes];
+    k->name = name;
+    k->weight = weight;
+    k->rate_milli = per_minute * 1000 / 60;
+    k->burst = burst;
+    k->tokens_milli = burst * 1000;
+    k->last_refill_us = esp_timer_get_time();
+    return a->n_classes++;
+}
+
+int admission_register(admission_t *a, const char *name, int cls) {
+    int id = -1;
+
+    taskENTER_CRITICAL(&a->lock);
+    if (a->n_clients < ADMIT_MAX_CLIENTS && cls >= 0 && cls < a->n_classes) {
+        id = a->n_clients++;
+        admit_client_t *c = &a->clients[id];
+        c->name = name;
+        c->task = xTaskGetCurrentTaskHandle();
+        c->cls = cls;
+        c->finish_tag = a->vtime;
+        c->granted = -1;
+    }
+    taskEXIT_CRITICAL(&a->lock);
+    return id;
+}
+
+// ================ ACQUIRE / RELEASE ================
+
+int admission_acquire(admission_t *a, int client, TickType_t timeout) {
+    admit_client_t *c = &a->clients[client];
+    admit_class_t *k = &a->classes[c->cls];
+    int64_t t_request = esp_timer_get_time();
+    int idx;
+
+    ulTaskNotifyTake(pdTRUE, 0);  // discard a wakeup left over from a late grant
+
+    taskENTER_CRITICAL(&a->lock);
+    c->requests++;
+    refill(k, t_request);
+    if (k->tokens_milli < 1000) {
+        k->limited++;
+        c->limited++;
+        taskEXIT_CRITICAL(&a->lock);
+        return ADMIT_RATE_LIMITED;
+    }
+    k->tokens_milli -= 1000;
+    k->admitted++;
+
+    uint64_t start = c->finish_tag > a->vtime ? c->finish_tag : a->vtime;
+    c->finish_tag = start + ADMIT_TAG_UNIT / k->weight;
+
+    // Free resources are always dispatched to waiters first, so any left
+    // over mean nobody is queued ahead of us
+    uint32_t avail = a->free_mask & a->enabled_mask & a->online_mask;
+    if (avail) {
+        idx = __builtin_ctz(avail);
+        a->free_mask &= ~(1u << idx);
+        a->vtime = start;
+        record_grant(c, 0);
+        taskEXIT_CRITICAL(&a->lock);
+        return idx;
+    }
+    c->waiting = true;
+    c->start_tag = start;
+    c->wait_tag = c->finish_tag;
+    c->granted = -1;
+    taskEXIT_CRITICAL(&a->lock);
+
+    TickType_t t0 = xTaskGetTickCount();
+    while (1) {
+        TickType_t elapsed = xTaskGetTickCount() - t0;
+        TickType_t left = timeout == portMAX_DELAY ? portMAX_DELAY
+                          : (elapsed < timeout ? timeout - elapsed : 0);
+        if (left > 0)
+            ulTaskNotifyTake(pdTRUE, left);
+
+        taskENTER_CRITICAL(&a->lock);
+        if (c->granted >= 0) {
+            idx = c->granted;
+            c->waiting = false;
+            record_grant(c, (uint32_t)(esp_timer_get_time() - t_request));
+            taskEXIT_CRITICAL(&a->lock);
+            return idx;
+        }
+        if (timeout != portMAX_DELAY && xTaskGetTickCount() - t0 >= timeout) {
+            // Not served: give back the token and the virtual time
+            c->waiting = false;
+            c->timeouts++;
+            c->finish_tag = c->start_tag;
+            k->tokens_milli = k->tokens_milli + 1000 > k->burst * 1000 ? k->burst * 1000
+                                                                       : k->tokens_milli + 1000;
+            taskEXIT_CRITICAL(&a->lock);
+            return ADMIT_TIMEOUT;
+        }
+        taskEXIT_CRITICAL(&a->lock);
+    }
+}
+
+void admission_release(admission_t *a, int idx) {
+    TaskHandle_t wake[ADMIT_MAX_RESOURCES];
+    int n;
+
+    if (idx < 0 || idx >= a->resources)
+        return;
+
+    taskENTER_CRITICAL(&a->lock);
+    a->free_mask |= 1u << idx;
+    n = dispatch(a, wake);
+    taskEXIT_CRITICAL(&a->lock);
+    wake_all(wake, n);
+}
+
+void admission_set_capacity(admission_t *a, int n) {
+    TaskHandle_t wake[ADMIT_MAX_RESOURCES];
+    int woken;
+
+    if (n < 0)
+        n = 0;
+    taskENTER_CRITICAL(&a->lock);
+    a->budget = n >= a->resources ? a->resources : n;
+    apply_budget(a);
+    woken = dispatch(a, wake);
+    taskEXIT_CRITICAL(&a->lock);
+    wake_all(wake, woken);
+}
+
+void admission_set_online(admission_t *a, int idx, bool online) {
+    TaskHandle_t wake[ADMIT_MAX_RESOURCES];
+    int woken;
+
+    if (idx < 0 || idx >= a->resources)
+        return;
+    taskENTER_CRITICAL(&a->lock);
+    if (online)
+        a->online_mask |= 1u << idx;
+    else
+        a->online_mask &= ~(1u << idx);
+    apply_budget(a);
+    woken = dispatch(a, wake);
+    taskEXIT_CRITICAL(&a->lock);
+    wake_all(wake, woken);
+}
+
+int admission_budget(const admission_t *a) {
+    return a->budget;
+}
+
+int admission_capacity(const admission_t *a) {
+    return __builtin_popcount(a->enabled_mask & a->online_mask);
+}
+
+int admission_free_count(const admission_t *a) {
+    return __builtin_popcount(a->free_mask & a->enabled_mask & a->online_mask);
+}
+
+int admission_waiting_count(admission_t *a) {
+    int n = 0;
+    taskENTER_CRITICAL(&a->lock);
+    for (int i = 0; i < a->n_clients; i++)
+        n += a->clients[i].waiting && a->clients[i].granted < 0;
+    taskEXIT_CRITICAL(&a->lock);
+    return n;
+}
+
+// ================ REPORTING ================
+
+uint32_t admission_wait_percentile_ms(const admit_client_t *c, uint32_t permille) {
+    uint32_t total = 0, seen = 0;
+    for (int i = 0; i < ADMIT_WAIT_BUCKETS; i++)
+        total += c->wait_hist[i];
+    if (total == 0)
+        return 0;
+
+    uint32_t target = (uint32_t)(((uint64_t)total * permille + 999) / 1000);
+    for (int i = 0; i < ADMIT_WAIT_BUCKETS; i++) {
+        seen += c->wait_hist[i];
+        if (seen >= target)
+            return 1u << i;
+    }
+    return 1u << (ADMIT_WAIT_BUCKETS - 1);
+}
+
+// Per-client service and wait tails, plus Jain's fairness index over
+// grants normalised by class weight (1.0 = perfectly weighted-fair)
+void admission_report(admission_t *a) {
+    admit_client_t snap[ADMIT_MAX_CLIENTS];
+    int n;
+    float sum = 0, sum_sq = 0;
+
+    taskENTER_CRITICAL(&a->lock);
+    n = a->n_clients;
+    memcpy(snap, a->clients, n * sizeof(admit_client_t));
+    taskEXIT_CRITICAL(&a->lock);
+
+    for (int i = 0; i < n; i++) {
+        const admit_client_t *c = &snap[i];
+        const admit_class_t *k = &a->classes[c->cls];
+        float share = (float)c->grants / k->weight;
+        sum += share;
+        sum_sq += share * share;
+
+        ESP_LOGI(TAG, "  %-10s %-5s req %4lu grant %4lu limited %3lu timeout %3lu | wait avg %5lu ms p99<%lu ms max %lu ms",
+                 c->name, k->name, c->requests, c->grants, c->limited, c->timeouts,
+                 c->grants ? (uint32_t)(c->wait_sum_us / c->grants / 1000) : 0,
+                 admission_wait_percentile_ms(c, 990), c->wait_max_us / 1000);
+    }
+    if (n > 0 && sum_sq > 0) {
+        ESP_LOGI(TAG, "  Weighted fairness (Jain): %.3f | capacity %d free %d waiting %d",
+                 sum * sum / (n * sum_sq), admission_capacity(a), admission_free_count(a),
+                 admission_waiting_count(a));
+    }
+}
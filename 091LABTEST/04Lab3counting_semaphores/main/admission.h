@@ -0,0 +1,105 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ================ ADMISSION CONTROL ================
+// Gatekeeper for a pool of up to 32 identical resources:
+//  - each client class has a token bucket that caps its request rate
+//  - clients that find the pool busy wait in weighted-fair order (start-time
+//    fair queuing on virtual finish tags) rather than FreeRTOS priority order
+//  - free resources live in a bitmap, so picking one is a single ctz
+// Released resources are handed straight to the next waiter and the waiter
+// is woken with a task notification.
+
+#define ADMIT_MAX_RESOURCES 32
+#define ADMIT_MAX_CLASSES   4
+#define ADMIT_MAX_CLIENTS   8
+#define ADMIT_WAIT_BUCKETS  12   // log2 wait histogram, bucket 0: <1 ms
+
+// Return codes of admission_acquire(), resource indexes are >= 0
+#define ADMIT_RATE_LIMITED  (-1)
+#define ADMIT_TIMEOUT       (-2)
+
+typedef struct {
+    const char *name;
+    uint32_t weight;            // share of the pool under contention
+    uint32_t rate_milli;        // token refill, requests per 1000 s
+    uint32_t burst;             // bucket depth in requests
+    uint32_t tokens_milli;
+    int64_t last_refill_us;
+    uint32_t admitted;
+    uint32_t limited;
+} admit_class_t;
+
+typedef struct {
+    const char *name;
+    TaskHandle_t task;
+    uint8_t cls;
+    uint64_t finish_tag;        // virtual finish time of the latest request
+    // pending request, valid while waiting
+    bool waiting;
+    uint64_t start_tag;
+    uint64_t wait_tag;
+    int granted;
+    // statistics
+    uint32_t requests;
+    uint32_t grants;
+    uint32_t limited;
+    uint32_t timeouts;
+    uint64_t wait_sum_us;
+    uint32_t wait_max_us;
+    uint32_t wait_hist[ADMIT_WAIT_BUCKETS];
+} admit_client_t;
+
+typedef struct {
+    portMUX_TYPE lock;
+    int resources;
+    uint32_t all_mask;
+    int budget;                 // resources to keep in service, admission_set_capacity()
+    uint32_t enabled_mask;      // the first `budget` online resources
+    uint32_t online_mask;       // cleared while a resource is quarantined
+    uint32_t free_mask;
+    uint64_t vtime;
+    int n_classes;
+    int n_clients;
+    admit_class_t classes[ADMIT_MAX_CLASSES];
+    admit_client_t clients[ADMIT_MAX_CLIENTS];
+} admission_t;
+
+void admission_init(admission_t *a, int resources);
+
+// Returns the class id, or -1 when the table is full
+int admission_add_class(admission_t *a, const char *name, uint32_t weight,
+                        uint32_t per_minute, uint32_t burst);
+
+// Called from the client's own task; returns the client id or -1
+int admission_register(admission_t *a, const char *name, int cls);
+
+// Resource index, ADMIT_RATE_LIMITED (no token, returns at once) or
+// ADMIT_TIMEOUT (token refunded)
+int admission_acquire(admission_t *a, int client, TickType_t timeout);
+void admission_release(admission_t *a, int idx);
+
+// Keep n resources in service: the first n that are online, so spares
+// beyond the budget replace quarantined ones. Shrinking takes effect as
+// busy resources come back.
+void admission_set_capacity(admission_t *a, int n);
+int admission_budget(const admission_t *a);
+
+// Take a resource out of (or back into) service, e.g. on a health failure;
+// a busy resource is parked when released and a spare is promoted
+void admission_set_online(admission_t *a, int idx, bool online);
+
+// Resources in service: the budget, less any that no spare can replace
+int admission_capacity(const admission_t *a);
+int admission_free_count(const admission_t *a);
+int admission_waiting_count(admission_t *a);
+
+uint32_t admission_wait_percentile_ms(const admit_client_t *c, uint32_t permille);
+void admission_report(admission_t *a);
+
+#endif
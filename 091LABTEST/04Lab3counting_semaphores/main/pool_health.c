@@ -0,0 +1,184 @@
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "pool_health.h"
+
+static const char *TAG = "POOL_HEALTH";
+
+#define HEALTH_DEFAULT_INTERVAL_MS 250
+#define HEALTH_DEFAULT_MAX_BACKOFF 4000
+#define HEALTH_DEFAULT_TRIP        2
+#define HEALTH_DEFAULT_RECOVERY    3
+
+typedef enum {
+    HEALTH_NONE,
+    HEALTH_TRIP,
+    HEALTH_RECOVER,
+} health_action_t;
+
+// ================ STATE MACHINE (lock held) ================
+
+static health_action_t trip(pool_health_t *h, res_health_slot_t *s, int64_t now) {
+    s->state = RES_QUARANTINED;
+    s->trips++;
+    s->tripped_us = now;
+    s->fails = 0;
+    s->oks = 0;
+    s->backoff_ms = h->probe_interval_ms;
+    s->next_probe_us = now + (int64_t)s->backoff_ms * 1000;
+    return HEALTH_TRIP;
+}
+
+static health_action_t on_probe(pool_health_t *h, res_health_slot_t *s, bool ok, int64_t now) {
+    if (ok)
+        s->probes_ok++;
+    else
+        s->probes_failed++;
+
+    switch (s->state) {
+        case RES_HEALTHY:
+            s->fails = ok ? 0 : s->fails + 1;
+            if (s->fails >= h->trip_threshold)
+                return trip(h, s, now);
+            break;
+
+        case RES_QUARANTINED:
+            if (ok) {
+                s->state = RES_PROBATION;
+                s->oks = 1;
+            } else {
+                s->backoff_ms = s->backoff_ms * 2 < h->max_backoff_ms ? s->backoff_ms * 2 : h->max_backoff_ms;
+                s->next_probe_us = now + (int64_t)s->backoff_ms * 1000;
+            }
+            break;
+
+        case RES_PROBATION:
+            if (!ok) {
+                s->state = RES_QUARANTINED;
+                s->backoff_ms = s->backoff_ms * 2 < h->max_backoff_ms ? s->backoff_ms * 2 : h->max_backoff_ms;
+                s->next_probe_us = now + (int64_t)s->backoff_ms * 1000;
+            } else if (++s->oks >= h->recovery_probes) {
+                s->state = RES_HEALTHY;
+                s->recoveries++;
+                s->downtime_us += now - s->tripped_us;
+                return HEALTH_RECOVER;
+            }
+            break;
+    }
+    return HEALTH_NONE;
+}
+
+// The action is decided under h->lock but applied after it, so a trip and
+// a recovery can race to the admission controller. Each apply therefore
+// pushes the state as it is now, one at a time: whichever runs last sees
+// the latest state, and a quarantined resource never ends up online.
+static void apply(pool_health_t *h, int idx, health_action_t action) {
+    if (action == HEALTH_NONE)
+        return;
+
+    xSemaphoreTake(h->apply_lock, portMAX_DELAY);
+    taskENTER_CRITICAL(&h->lock);
+    bool online = h->slot[idx].state == RES_HEALTHY;
+    taskEXIT_CRITICAL(&h->lock);
+    admission_set_online(h->adm, idx, online);
+    xSemaphoreGive(h->apply_lock);
+
+    if (online != (action == HEALTH_RECOVER))
+        return; // superseded, the newer change logs itself
+    if (online)
+        ESP_LOGI(TAG, "✅ Resource %d back in service, capacity now %d", idx + 1, admission_capacity(h->adm));
+    else
+        ESP_LOGE(TAG, "⛔ Resource %d quarantined, capacity now %d", idx + 1, admission_capacity(h->adm));
+}
+
+// ================ PROBE TASK ================
+
+static void health_task(void *pv) {
+    pool_health_t *h = pv;
+
+    while (1) {
+        for (int i = 0; i < h->resources; i++) {
+            res_health_slot_t *s = &h->slot[i];
+            int64_t now = esp_timer_get_time();
+
+            taskENTER_CRITICAL(&h->lock);
+            bool due = s->state != RES_QUARANTINED || now >= s->next_probe_us;
+            taskEXIT_CRITICAL(&h->lock);
+            if (!due)
+                continue;
+
+            bool ok = h->probe(i, h->ctx);
+
+            taskENTER_CRITICAL(&h->lock);
+            health_action_t action = on_probe(h, s, ok, esp_timer_get_time());
+            taskEXIT_CRITICAL(&h->lock);
+            apply(h, i, action);
+        }
+        vTaskDelay(pdMS_TO_TICKS(h->probe_interval_ms));
+    }
+}
+
+// ================ PUBLIC API ================
+
+void pool_health_init(pool_health_t *h, admission_t *adm, health_probe_fn probe, void *ctx) {
+    memset(h, 0, sizeof(*h));
+    h->adm = adm;
+    h->probe = probe;
+    h->ctx = ctx;
+    h->resources = adm->resources;
+    h->probe_interval_ms = HEALTH_DEFAULT_INTERVAL_MS;
+    h->max_backoff_ms = HEALTH_DEFAULT_MAX_BACKOFF;
+    h->trip_threshold = HEALTH_DEFAULT_TRIP;
+    h->recovery_probes = HEALTH_DEFAULT_RECOVERY;
+    portMUX_INITIALIZE(&h->lock);
+    h->apply_lock = xSemaphoreCreateMutexStatic(&h->apply_buf);
+}
+
+bool pool_health_start(pool_health_t *h, UBaseType_t priority) {
+    return xTaskCreate(health_task, "PoolHealth", 3072, h, priority, NULL) == pdPASS;
+}
+
+void pool_health_report_error(pool_health_t *h, int idx) {
+    health_action_t action = HEALTH_NONE;
+
+    if (idx < 0 || idx >= h->resources)
+        return;
+    taskENTER_CRITICAL(&h->lock);
+    res_health_slot_t *s = &h->slot[idx];
+    s->errors_reported++;
+    if (s->state == RES_HEALTHY)
+        action = trip(h, s, esp_timer_get_time());
+    taskEXIT_CRITICAL(&h->lock);
+    apply(h, idx, action);
+}
+
+res_health_t pool_health_state(const pool_health_t *h, int idx) {
+    return h->slot[idx].state;
+}
+
+const char *pool_health_state_name(res_health_t s) {
+    switch (s) {
+        case RES_HEALTHY:     return "HEALTHY";
+        case RES_QUARANTINED: return "QUARANTINED";
+        case RES_PROBATION:   return "PROBATION";
+    }
+    return "?";
+}
+
+void pool_health_report(pool_health_t *h) {
+    res_health_slot_t snap[ADMIT_MAX_RESOURCES];
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&h->lock);
+    memcpy(snap, h->slot, h->resources * sizeof(res_health_slot_t));
+    taskEXIT_CRITICAL(&h->lock);
+
+    for (int i = 0; i < h->resources; i++) {
+        const res_health_slot_t *s = &snap[i];
+        uint64_t down = s->downtime_us + (s->state != RES_HEALTHY ? now - s->tripped_us : 0);
+        ESP_LOGI(TAG, "  R%d %-11s trips %lu recov %lu errors %lu | probes ok %lu fail %lu | down %llu ms MTTR %llu ms",
+                 i + 1, pool_health_state_name(s->state), s->trips, s->recoveries, s->errors_reported,
+                 s->probes_ok, s->probes_failed, down / 1000,
+                 s->recoveries ? s->downtime_us / s->recoveries / 1000 : 0);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef POOL_HEALTH_H
+#define POOL_HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/semphr.h"
+#include "admission.h"
+
+// ================ POOL HEALTH ================
+// Per-resource circuit breaker driven by a background probe task:
+//
+//   HEALTHY --(trip_threshold failed probes, or a reported error)--> QUARANTINED
+//   QUARANTINED --(probe ok, retried with exponential backoff)--> PROBATION
+//   PROBATION --(recovery_probes ok in a row)--> HEALTHY
+//   PROBATION --(probe fails)--> QUARANTINED, backoff doubled
+//
+// Quarantine takes the resource offline in the admission controller, so the
+// usable budget shrinks immediately and no request is handed a dead slot;
+// recovery puts it back and wakes the next waiter.
+
+typedef enum {
+    RES_HEALTHY,        // breaker closed
+    RES_QUARANTINED,    // breaker open
+    RES_PROBATION,      // breaker half-open
+} res_health_t;
+
+// Returns true if resource idx answers correctly
+typedef bool (*health_probe_fn)(int idx, void *ctx);
+
+typedef struct {
+    res_health_t state;
+    uint8_t fails;              // consecutive failed probes while healthy
+    uint8_t oks;                // consecutive good probes on probation
+    uint32_t backoff_ms;
+    int64_t next_probe_us;
+    int64_t tripped_us;
+    // circuit breaker statistics
+    uint32_t trips;
+    uint32_t recoveries;
+    uint32_t probes_ok;
+    uint32_t probes_failed;
+    uint32_t errors_reported;
+    uint64_t downtime_us;
+} res_health_slot_t;
+
+typedef struct {
+    admission_t *adm;
+    health_probe_fn probe;
+    void *ctx;
+    int resources;
+    uint32_t probe_interval_ms;
+    uint32_t max_backoff_ms;
+    uint8_t trip_threshold;
+    uint8_t recovery_probes;
+    portMUX_TYPE lock;
+    SemaphoreHandle_t apply_lock;   // orders admission updates, see apply()
+    StaticSemaphore_t apply_buf;
+    res_health_slot_t slot[ADMIT_MAX_RESOURCES];
+} pool_health_t;
+
+void pool_health_init(pool_health_t *h, admission_t *adm, health_probe_fn probe, void *ctx);
+bool pool_health_start(pool_health_t *h, UBaseType_t priority);
+
+// A client saw the resource misbehave: open its breaker without waiting
+// for the next probe
+void pool_health_report_error(pool_health_t *h, int idx);
+
+res_health_t pool_health_state(const pool_health_t *h, int idx);
+const char *pool_health_state_name(res_health_t s);
+void pool_health_report(pool_health_t *h);
+
+#endif
@@ -3,19 +3,37 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "shard_counter.h"
 
 static const char *TAG = "EX1_RESOURCE_PROTECT";
 
 // ----------------------------
 // ⚙️ CONFIG
 // ----------------------------
-#define USE_MUTEX 1   // 0 = ไม่ใช้ (Race Condition), 1 = ใช้ (Protected)
+#define MODE_RACE    0   // ไม่ป้องกัน (Race Condition)
+#define MODE_MUTEX   1   // Mutex คุมเฉพาะการเพิ่มค่า
+#define MODE_SHARDED 2   // Sharded atomic counter (shard_counter.h)
+#define COUNTER_MODE MODE_SHARDED
+
+#define NUM_TASKS 3
 
 // ----------------------------
 // 📊 Shared Resource
 // ----------------------------
 static int shared_counter = 0;
 SemaphoreHandle_t counter_mutex;
+sc_counter_t counter_shards;
+
+// Updates each task believes it made (one writer per slot)
+static uint32_t updates_done[NUM_TASKS + 1];
+
+static const char *mode_names[] = {"⚠️ No Mutex (Race Condition)", "🔒 Using Mutex", "🧮 Sharded Atomic"};
+
+static uint32_t counter_value(void)
+{
+    return COUNTER_MODE == MODE_SHARDED ? sc_read(&counter_shards) : (uint32_t)shared_counter;
+}
 
 // ----------------------------
 // 🧵 Task Function
@@ -28,29 +46,34 @@ void counter_task(void *param)
 
     while (1)
     {
-#if USE_MUTEX
-        // --- 🔒 เข้าสู่ Critical Section แบบปลอดภัย ---
+#if COUNTER_MODE == MODE_MUTEX
+        // งานจริงทำนอก lock; mutex คุมแค่ read-modify-write
+        vTaskDelay(pdMS_TO_TICKS(200));  // จำลองงานก่อนนับ
         if (xSemaphoreTake(counter_mutex, pdMS_TO_TICKS(500)) == pdTRUE)
         {
-            int local = shared_counter;
-            ESP_LOGI(TAG, "%s: Acquired mutex, read counter = %d", task_name, local);
-            vTaskDelay(pdMS_TO_TICKS(200));  // จำลอง delay ก่อนเขียน
-            shared_counter = local + 1;
-            ESP_LOGI(TAG, "%s: Updated counter to %d", task_name, shared_counter);
-
+            shared_counter++;
+            int value = shared_counter;
             xSemaphoreGive(counter_mutex);
-            ESP_LOGI(TAG, "%s: Released mutex\n", task_name);
+            updates_done[id]++;
+            ESP_LOGI(TAG, "%s: Updated counter to %d", task_name, value);
         }
         else
         {
             ESP_LOGW(TAG, "%s: Timeout acquiring mutex!", task_name);
         }
+#elif COUNTER_MODE == MODE_SHARDED
+        // ไม่มี lock: atomic add บน shard ของ core ตัวเอง
+        vTaskDelay(pdMS_TO_TICKS(200));
+        sc_inc(&counter_shards);
+        updates_done[id]++;
+        ESP_LOGI(TAG, "%s: Incremented, counter now %lu", task_name, sc_read(&counter_shards));
 #else
         // --- ⚠️ ไม่ใช้ mutex → Race Condition ---
         int local = shared_counter;
         ESP_LOGI(TAG, "%s: Read counter: %d, incrementing...", task_name, local);
         vTaskDelay(pdMS_TO_TICKS(200));
         shared_counter = local + 1;
+        updates_done[id]++;
         ESP_LOGI(TAG, "%s: Updated counter to %d\n", task_name, shared_counter);
 #endif
 
@@ -58,15 +81,163 @@ void counter_task(void *param)
     }
 }
 
+// ----------------------------
+// 🔎 Lost update check
+// ----------------------------
+void checker_task(void *param)
+{
+    while (1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(5000));
+        uint32_t expected = 0;
+        for (int i = 1; i <= NUM_TASKS; i++)
+        {
+            expected += updates_done[i];
+        }
+        uint32_t actual = counter_value();
+        // Tasks tally after their add, so any shortfall is a lost update
+        uint32_t lost = expected > actual ? expected - actual : 0;
+        ESP_LOGI(TAG, "🔎 Counter %lu, updates made %lu, lost %lu %s", actual, expected, lost,
+                 lost ? "❌" : "✅");
+    }
+}
+
+// ----------------------------
+// 🏁 Benchmark: mutex vs atomic vs sharded
+// ----------------------------
+#define BENCH_OPS       10000   // increments per task
+#define BENCH_MAX_TASKS 8
+#define BENCH_PRIO      5
+
+typedef enum
+{
+    BENCH_PLAIN,
+    BENCH_MUTEX,
+    BENCH_ATOMIC,
+    BENCH_SHARDED,
+    BENCH_METHODS
+} bench_method_t;
+
+static volatile uint32_t bench_plain;
+static uint32_t bench_atomic;
+static sc_counter_t bench_shards;
+static SemaphoreHandle_t bench_mutex, bench_go, bench_done;
+static bench_method_t bench_method;
+
+void bench_task(void *param)
+{
+    xSemaphoreTake(bench_go, portMAX_DELAY);
+    for (int i = 0; i < BENCH_OPS; i++)
+    {
+        switch (bench_method)
+        {
+            case BENCH_PLAIN:
+                bench_plain++;
+                break;
+            case BENCH_MUTEX:
+                xSemaphoreTake(bench_mutex, portMAX_DELAY);
+                bench_plain++;
+                xSemaphoreGive(bench_mutex);
+                break;
+            case BENCH_ATOMIC:
+                __atomic_fetch_add(&bench_atomic, 1, __ATOMIC_RELAXED);
+                break;
+            default:
+                sc_inc(&bench_shards);
+                break;
+        }
+    }
+    xSemaphoreGive(bench_done);
+    vTaskDelete(NULL);
+}
+
+// Runs n tasks spread over both cores; returns increments per ms and the final count
+static uint32_t bench_run(bench_method_t method, int n, uint32_t *count)
+{
+    bench_method = method;
+    bench_plain = 0;
+    bench_atomic = 0;
+    sc_set(&bench_shards, 0);
+
+    for (int i = 0; i < n; i++)
+    {
+        xTaskCreatePinnedToCore(bench_task, "Bench", 2048, NULL, BENCH_PRIO, NULL, i % portNUM_PROCESSORS);
+    }
+
+    // Release everyone from above their priority, so no task starts alone
+    UBaseType_t prio = uxTaskPriorityGet(NULL);
+    vTaskPrioritySet(NULL, BENCH_PRIO + 1);
+    for (int i = 0; i < n; i++)
+    {
+        xSemaphoreGive(bench_go);
+    }
+    int64_t start = esp_timer_get_time();
+    vTaskPrioritySet(NULL, prio);
+    for (int i = 0; i < n; i++)
+    {
+        xSemaphoreTake(bench_done, portMAX_DELAY);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    switch (method)
+    {
+        case BENCH_ATOMIC:  *count = bench_atomic; break;
+        case BENCH_SHARDED: *count = sc_read(&bench_shards); break;
+        default:            *count = bench_plain; break;
+    }
+    // Let the idle task free the finished tasks and feed its watchdog
+    vTaskDelay(pdMS_TO_TICKS(20));
+    return (uint32_t)((int64_t)n * BENCH_OPS * 1000 / (elapsed ? elapsed : 1));
+}
+
+void counter_benchmark(void)
+{
+    bench_mutex = xSemaphoreCreateMutex();
+    bench_go = xSemaphoreCreateCounting(BENCH_MAX_TASKS, 0);
+    bench_done = xSemaphoreCreateCounting(BENCH_MAX_TASKS, 0);
+    if (!bench_mutex || !bench_go || !bench_done)
+    {
+        ESP_LOGE(TAG, "Benchmark setup failed");
+        return;
+    }
+    sc_register(&bench_shards, "bench_increments", "Benchmark scratch counter", SC_COUNTER);
+
+    ESP_LOGI(TAG, "🏁 Counter benchmark: %d increments per task, increments/ms", BENCH_OPS);
+    ESP_LOGI(TAG, "%5s %18s %8s %8s %8s", "tasks", "plain++ (lost)", "mutex", "atomic", "sharded");
+    for (int n = 1; n <= BENCH_MAX_TASKS; n++)
+    {
+        uint32_t rate[BENCH_METHODS], count[BENCH_METHODS];
+        bool exact = true;
+        for (int m = 0; m < BENCH_METHODS; m++)
+        {
+            rate[m] = bench_run(m, n, &count[m]);
+            if (m != BENCH_PLAIN && count[m] != (uint32_t)n * BENCH_OPS)
+            {
+                exact = false;
+            }
+        }
+        ESP_LOGI(TAG, "%5d %8lu (%7lu) %8lu %8lu %8lu %s", n, rate[BENCH_PLAIN],
+                 (uint32_t)n * BENCH_OPS - count[BENCH_PLAIN], rate[BENCH_MUTEX],
+                 rate[BENCH_ATOMIC], rate[BENCH_SHARDED], exact ? "" : "❌ lost updates");
+    }
+
+    vSemaphoreDelete(bench_mutex);
+    vSemaphoreDelete(bench_go);
+    vSemaphoreDelete(bench_done);
+}
+
 // ----------------------------
 // 🚀 app_main
 // ----------------------------
 void app_main(void)
 {
     ESP_LOGI(TAG, "=== Exercise 1: Resource Protection ===");
-    ESP_LOGI(TAG, "Mode: %s\n", USE_MUTEX ? "🔒 Using Mutex" : "⚠️ No Mutex (Race Condition)");
 
-    if (USE_MUTEX)
+    counter_benchmark();
+
+    ESP_LOGI(TAG, "Mode: %s\n", mode_names[COUNTER_MODE]);
+
+    if (COUNTER_MODE == MODE_MUTEX)
     {
         counter_mutex = xSemaphoreCreateMutex();
         if (counter_mutex == NULL)
@@ -75,8 +246,10 @@ void app_main(void)
             return;
         }
     }
+    sc_register(&counter_shards, "shared_counter", "Increments by the counter tasks", SC_COUNTER);
 
     xTaskCreate(counter_task, "Task1", 2048, (void *)1, 5, NULL);
     xTaskCreate(counter_task, "Task2", 2048, (void *)2, 5, NULL);
     xTaskCreate(counter_task, "Task3", 2048, (void *)3, 5, NULL);
+    xTaskCreate(checker_task, "Checker", 2048, NULL, 4, NULL);
 }
@@ -7,6 +7,7 @@
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "esp_random.h"
+#include "timer_exec.h"
 
 static const char *TAG = "TIMER_CHALLENGE";
 
@@ -16,6 +17,11 @@ static const char *TAG = "TIMER_CHALLENGE";
 #define LED_ERROR GPIO_NUM_5
 #define LED_SCHED GPIO_NUM_18
 
+// Timer executor (see timer_exec.h)
+#define TIMER_WORKERS 2
+#define TIMER_WORKER_PRIORITY 2
+#define TIMER_BUDGET_US 500
+
 // Timer Handles
 TimerHandle_t syncTimer;
 TimerHandle_t analysisTimer;
@@ -44,7 +50,7 @@ void sync_callback(TimerHandle_t xTimer) {
     // Randomly inject simulated delay (testing timer precision)
     if (esp_random() % 10 == 0) {
         ESP_LOGW(TAG, "⚠️ Simulating processing delay...");
-        vTaskDelay(pdMS_TO_TICKS(200)); // deliberate delay
+        tx_delay(pdMS_TO_TICKS(200)); // deliberate delay
     }
 }
 
@@ -60,6 +66,7 @@ void analysis_callback(TimerHandle_t xTimer) {
     }
 
     gpio_set_level(LED_ANALYSIS, 0);
+    tx_report();
 }
 
 void scheduler_callback(TimerHandle_t xTimer) {
@@ -95,7 +102,7 @@ void error_check_callback(TimerHandle_t xTimer) {
         // Recovery: stop & restart
         ESP_LOGI(TAG, "🔁 Attempting Recovery...");
         xTimerStop(syncTimer, 0);
-        vTaskDelay(pdMS_TO_TICKS(500));
+        tx_delay(pdMS_TO_TICKS(500));
         xTimerStart(syncTimer, 0);
         gpio_set_level(LED_ERROR, 0);
         error_state = 0;
@@ -118,11 +125,13 @@ void app_main(void) {
     gpio_set_level(LED_ERROR, 0);
     gpio_set_level(LED_SCHED, 0);
 
-    // Create Timers
-    syncTimer = xTimerCreate("SyncTimer", pdMS_TO_TICKS(500), pdTRUE, NULL, sync_callback);
-    analysisTimer = xTimerCreate("AnalysisTimer", pdMS_TO_TICKS(3000), pdTRUE, NULL, analysis_callback);
-    schedulerTimer = xTimerCreate("SchedulerTimer", pdMS_TO_TICKS(7000), pdTRUE, NULL, scheduler_callback);
-    errorCheckTimer = xTimerCreate("ErrorCheckTimer", pdMS_TO_TICKS(5000), pdTRUE, NULL, error_check_callback);
+    // Create Timers: sync sleeps now and then (moved off the daemon the first
+    // time it does), error recovery always sleeps 500 ms so it starts offloaded
+    tx_init(TIMER_WORKERS, TIMER_WORKER_PRIORITY);
+    syncTimer = tx_timer_create("SyncTimer", pdMS_TO_TICKS(500), pdTRUE, TX_AUTO, TIMER_BUDGET_US, sync_callback);
+    analysisTimer = tx_timer_create("AnalysisTimer", pdMS_TO_TICKS(3000), pdTRUE, TX_AUTO, TIMER_BUDGET_US, analysis_callback);
+    schedulerTimer = tx_timer_create("SchedulerTimer", pdMS_TO_TICKS(7000), pdTRUE, TX_INLINE, TIMER_BUDGET_US, scheduler_callback);
+    errorCheckTimer = tx_timer_create("ErrorCheckTimer", pdMS_TO_TICKS(5000), pdTRUE, TX_OFFLOAD, TIMER_BUDGET_US, error_check_callback);
 
     if (!syncTimer || !analysisTimer || !schedulerTimer || !errorCheckTimer) {
         ESP_LOGE(TAG, "❌ Failed to create one or more timers!");
@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "timer_exec.h"
+
+static const char *TAG = "TIMER_EXEC";
+
+typedef struct tx_timer {
+    const char *name;
+    TimerCallbackFunction_t fn;
+    TimerHandle_t handle;
+    bool auto_reload;
+    tx_mode_t mode;
+    volatile tx_mode_t effective;   // AUTO resolves to INLINE or OFFLOAD
+    uint32_t budget_us;
+    uint32_t pending;               // expiries queued or running on the pool
+    bool flagged;                   // tx_delay() seen during this inline run
+    tx_stats_t stats;
+    struct tx_timer *next;
+} tx_timer_t;
+
+static tx_timer_t *registry;
+static portMUX_TYPE registry_lock = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t job_queue;
+static tx_timer_t *volatile daemon_current;   // inline callback now running
+
+static bool in_daemon(void) {
+    return xTaskGetCurrentTaskHandle() == xTimerGetTimerDaemonTaskHandle();
+}
+
+// ================ RUNNING A CALLBACK ================
+
+static void run(tx_timer_t *t) {
+    bool daemon = in_daemon();
+#if configGENERATE_RUN_TIME_STATS
+    TaskStatus_t before, after;
+    if (daemon)
+        vTaskGetInfo(NULL, &before, pdFALSE, eRunning);
+#endif
+
+    if (daemon) {
+        t->flagged = false;
+        daemon_current = t;
+    }
+    int64_t start = esp_timer_get_time();
+    t->fn(t->handle);
+    uint32_t took = (uint32_t)(esp_timer_get_time() - start);
+    if (daemon)
+        daemon_current = NULL;
+
+    t->stats.runs++;
+    t->stats.total_us += took;
+    if (took > t->stats.max_us)
+        t->stats.max_us = took;
+    bool over = t->budget_us && took > t->budget_us;
+    if (over)
+        t->stats.overruns++;
+    if (!daemon)
+        return;
+
+#if configGENERATE_RUN_TIME_STATS
+    // The daemon's run-time counter only moves when it is switched out, so a
+    // change means the callback slept or was preempted
+    vTaskGetInfo(NULL, &after, pdFALSE, eRunning);
+    if (after.ulRunTimeCounter != before.ulRunTimeCounter)
+        t->stats.descheduled++;
+#endif
+
+    if (t->effective == TX_INLINE && t->mode == TX_AUTO && (over || t->flagged)) {
+        t->effective = TX_OFFLOAD;
+        ESP_LOGW(TAG, "⏩ %s moved to worker pool (%s, %lu us)",
+                 t->name, t->flagged ? "blocking call" : "over budget", took);
+    }
+}
+
+static void worker_task(void *pv) {
+    tx_timer_t *t;
+
+    while (1) {
+        if (xQueueReceive(job_queue, &t, portMAX_DELAY) != pdTRUE)
+            continue;
+        // Expiries that arrived while this one ran are drained here, by the
+        // same worker, so one timer's callbacks never overlap or reorder
+        do {
+            run(t);
+            t->stats.offloaded++;
+        } while (__atomic_sub_fetch(&t->pending, 1, __ATOMIC_ACQ_REL) > 0);
+    }
+}
+
+// ================ DAEMON SIDE ================
+
+static void note_lateness(tx_timer_t *t) {
+    TickType_t expiry = xTimerGetExpiryTime(t->handle);
+
+    // Auto-reload timers are re-armed one period ahead before the callback
+    if (t->auto_reload)
+        expiry -= xTimerGetPeriod(t->handle);
+    TickType_t late = xTaskGetTickCount() - expiry;
+    if (late > portMAX_DELAY / 2)
+        return;   // period changed since the expiry, no reference point
+
+    uint32_t ms = pdTICKS_TO_MS(late);
+    t->stats.late_total_ms += ms;
+    if (ms > t->stats.late_max_ms)
+        t->stats.late_max_ms = ms;
+}
+
+static void trampoline(TimerHandle_t timer) {
+    tx_timer_t *t = pvTimerGetTimerID(timer);
+
+    t->stats.expiries++;
+    note_lateness(t);
+    if (t->effective == TX_INLINE || !job_queue) {
+        run(t);
+        return;
+    }
+
+    uint32_t ahead = __atomic_fetch_add(&t->pending, 1, __ATOMIC_ACQ_REL);
+    if (ahead) {
+        if (ahead > t->stats.max_backlog)
+            t->stats.max_backlog = ahead;
+        return;   // the worker holding this timer picks it up
+    }
+    if (xQueueSend(job_queue, &t, 0) != pdTRUE) {
+        __atomic_sub_fetch(&t->pending, 1, __ATOMIC_ACQ_REL);
+        t->stats.dropped++;
+    }
+}
+
+// ================ PUBLIC API ================
+
+bool tx_init(int workers, UBaseType_t worker_priority) {
+    char name[configMAX_TASK_NAME_LEN];
+
+    if (job_queue)
+        return true;
+    job_queue = xQueueCreate(TX_JOB_QUEUE, sizeof(tx_timer_t *));
+    if (!job_queue)
+        return false;
+    if (workers > TX_MAX_WORKERS)
+        workers = TX_MAX_WORKERS;
+    for (int i = 0; i < workers; i++) {
+        snprintf(name, sizeof(name), "TxWorker%d", i);
+        if (xTaskCreate(worker_task, name, 3072, NULL, worker_priority, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to start %s", name);
+            return false;
+        }
+    }
+    ESP_LOGI(TAG, "Timer executor: %d workers at priority %u", workers, (unsigned)worker_priority);
+    return true;
+}
+
+TimerHandle_t tx_timer_create(const char *name, TickType_t period, UBaseType_t auto_reload,
+                              tx_mode_t mode, uint32_t budget_us, TimerCallbackFunction_t fn) {
+    tx_timer_t *t = calloc(1, sizeof(*t));
+    if (!t)
+        return NULL;
+
+    t->name = name;
+    t->fn = fn;
+    t->auto_reload = auto_reload;
+    t->mode = mode;
+    t->effective = mode == TX_OFFLOAD ? TX_OFFLOAD : TX_INLINE;
+    t->budget_us = budget_us;
+    t->handle = xTimerCreate(name, period, auto_reload, t, trampoline);
+    if (!t->handle) {
+        free(t);
+        return NULL;
+    }
+
+    taskENTER_CRITICAL(&registry_lock);
+    t->next = registry;
+    registry = t;
+    taskEXIT_CRITICAL(&registry_lock);
+    return t->handle;
+}
+
+void tx_delay(TickType_t ticks) {
+    tx_timer_t *t = daemon_current;
+
+    if (t && in_daemon()) {
+        if (t->stats.blocking_calls++ == 0)
+            ESP_LOGW(TAG, "🐌 %s: %lu ms sleep inside the timer daemon", t->name, pdTICKS_TO_MS(ticks));
+        t->flagged = true;
+    }
+    vTaskDelay(ticks);
+}
+
+static tx_timer_t *find(TimerHandle_t timer) {
+    for (tx_timer_t *t = registry; t; t = t->next)
+        if (t->handle == timer)
+            return t;
+    return NULL;
+}
+
+bool tx_get_stats(TimerHandle_t timer, tx_stats_t *out) {
+    tx_timer_t *t = find(timer);
+    if (!t)
+        return false;
+    *out = t->stats;
+    return true;
+}
+
+const char *tx_mode_name(tx_mode_t mode) {
+    switch (mode) {
+        case TX_INLINE:  return "inline";
+        case TX_OFFLOAD: return "offload";
+        case TX_AUTO:    return "auto";
+    }
+    return "?";
+}
+
+void tx_report(void) {
+    uint32_t worst_late = 0;
+
+    ESP_LOGI(TAG, "%-14s %-8s %6s %6s %8s %8s %5s %5s %6s %8s %8s",
+             "timer", "runs in", "runs", "pool", "avg us", "max us", "over", "block", "desch", "late avg", "late max");
+    for (tx_timer_t *t = registry; t; t = t->next) {
+        tx_stats_t s = t->stats;
+        ESP_LOGI(TAG, "%-14s %-8s %6lu %6lu %8lu %8lu %5lu %5lu %6lu %6lu ms %6lu ms",
+                 t->name, tx_mode_name(t->effective), s.runs, s.offloaded,
+                 s.runs ? (uint32_t)(s.total_us / s.runs) : 0, s.max_us,
+                 s.overruns, s.blocking_calls, s.descheduled,
+                 s.expiries ? (uint32_t)(s.late_total_ms / s.expiries) : 0, s.late_max_ms);
+        if (s.dropped || s.max_backlog)
+            ESP_LOGW(TAG, "%-14s dropped %lu expiries, backlog peaked at %lu", t->name, s.dropped, s.max_backlog);
+        if (s.late_max_ms > worst_late)
+            worst_late = s.late_max_ms;
+    }
+    ESP_LOGI(TAG, "Worst expiry-to-callback delay across timers: %lu ms", worst_late);
+}
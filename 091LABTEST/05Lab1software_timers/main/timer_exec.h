@@ -0,0 +1,67 @@
+#ifndef TIMER_EXEC_H
+#define TIMER_EXEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+
+// ============================= TIMER EXECUTOR =============================
+// Every software timer shares the one timer daemon task, so a callback that
+// sleeps or runs long delays every other timer. Timers created through
+// tx_timer_create() run their callback via a trampoline that:
+//   - measures each run against a time budget
+//   - measures how late each expiry was serviced (daemon jitter)
+//   - catches blocking: tx_delay() called from the daemon, or the daemon
+//     being switched out in the middle of a callback (run-time stats)
+//   - optionally hands the callback to a worker pool instead of running it
+//     in the daemon
+//
+// Offloaded callbacks of one timer never overlap and run in expiry order.
+// Different timers run in parallel on different workers. The callback
+// receives the same TimerHandle_t either way. It must use task-context
+// APIs (xTimerChangePeriod(..., 0), xQueueSend(..., 0)), not the FromISR
+// ones.
+
+#define TX_MAX_WORKERS 4
+#define TX_JOB_QUEUE   16
+
+typedef enum {
+    TX_INLINE,    // always in the daemon (cheap, non-blocking callbacks)
+    TX_OFFLOAD,   // always on the worker pool
+    TX_AUTO,      // inline until it overruns its budget or blocks, then offloaded
+} tx_mode_t;
+
+typedef struct {
+    uint32_t expiries;
+    uint32_t runs;
+    uint32_t offloaded;
+    uint32_t overruns;        // runs longer than the budget
+    uint32_t blocking_calls;  // tx_delay() from the daemon
+    uint32_t descheduled;     // daemon switched out mid-callback
+    uint32_t dropped;         // job queue full, expiry lost
+    uint32_t max_backlog;     // expiries waiting behind a running one
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t late_max_ms;     // expiry -> callback start
+    uint64_t late_total_ms;
+} tx_stats_t;
+
+bool tx_init(int workers, UBaseType_t worker_priority);
+
+// Drop-in for xTimerCreate(); the timer ID is owned by the executor
+TimerHandle_t tx_timer_create(const char *name, TickType_t period, UBaseType_t auto_reload,
+                              tx_mode_t mode, uint32_t budget_us, TimerCallbackFunction_t fn);
+
+// Use instead of vTaskDelay() inside callbacks. Still sleeps, but when it
+// runs in the daemon it is recorded against the timer (and an AUTO timer is
+// moved to the worker pool for its next expiry).
+void tx_delay(TickType_t ticks);
+
+bool tx_get_stats(TimerHandle_t timer, tx_stats_t *out);
+const char *tx_mode_name(tx_mode_t mode);
+
+// One line per managed timer
+void tx_report(void);
+
+#endif
@@ -8,10 +8,16 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
-#include "driver/adc.h"
-#include "esp_adc_cal.h"
 #include "esp_random.h"
 #include "esp_system.h"
+#include "esp_timer.h"
+#include "sensor_value.h"
+#include "timer_exec.h"
+#include "waveform.h"
+#include "acquisition.h"
+#include "adaptive_rate.h"
+#include "task_supervisor.h"
+#include "metrics.h"
 
 static const char *TAG = "TIMER_APPS";
 
@@ -23,12 +29,30 @@ static const char *TAG = "TIMER_APPS";
 #define PATTERN_LED_3    GPIO_NUM_19
 #define SENSOR_POWER     GPIO_NUM_21
 #define SENSOR_PIN       GPIO_NUM_22
+#define SENSOR_ADC_CHANNEL 0            // ADC1 channel 0 (GPIO36)
+
+// Timer executor (see timer_exec.h)
+#define TIMER_WORKERS           2
+#define TIMER_WORKER_PRIORITY   2
+#define TIMER_BUDGET_US         500     // inline callbacks should stay well under this
 
 // Timer Periods
-#define WATCHDOG_TIMEOUT_MS     5000    // 5 seconds
-#define WATCHDOG_FEED_MS        2000    // Feed every 2 seconds
-#define PATTERN_BASE_MS         500     // Base pattern timing
-#define SENSOR_SAMPLE_MS        1000    // Sensor sampling rate
+#define WATCHDOG_TIMEOUT_MS     5000    // Sensor check-in deadline (slowest block is 2 s)
+#define SUPERVISOR_SCAN_MS      1000    // One pass over all check-in slots
+#define MONITOR_DEADLINE_MS     90000   // System monitor runs once a minute
+#define STATUS_DEADLINE_MS      10000   // Status timer, i.e. the timer engine
+#define HANG_AFTER_READINGS     30      // Simulated sensor hang, once
+#define HANG_MS                 12000
+#define PATTERN_ROTATE_STEPS    50      // Next pattern after this many steps
+// Sensor decimation: ADC conversions averaged per sample. With 250-sample
+// blocks at 20 kHz these give one block (one reading) per 0.25 s / 1 s / 2 s
+#define SENSOR_DECIM_FAST       20      // 1 kHz
+#define SENSOR_DECIM_NORMAL     80      // 250 Hz
+#define SENSOR_DECIM_SLOW       160     // 125 Hz
+// Adaptive rate: readings per second follow the signal (adaptive_rate.h)
+#define SENSOR_READING_COST_US  300     // reduce + log one block
+#define SENSOR_RATE_BUDGET_US   900     // per second, caps readings at 3 Hz
+#define SENSOR_WARN_HIGH        35.0f   // °C, also the benchmark's event level
 #define STATUS_UPDATE_MS        3000    // Status update interval
 
 // Pattern Types
@@ -42,339 +66,291 @@ typedef enum {
     PATTERN_MAX
 } led_pattern_t;
 
-// Sensor Data Structure
+// Sensor Data Structure (value is float or Q16.16, see sensor_value.h)
 typedef struct {
-    float value;
+    sensor_value_t value;
     uint32_t timestamp;
     bool valid;
 } sensor_data_t;
 
-// System Health Structure
+// System Health Structure: registered metrics, served on the console by
+// the metrics task (metrics.h) as well as logged by the status timer
 typedef struct {
-    uint32_t watchdog_feeds;
-    uint32_t watchdog_timeouts;
-    uint32_t pattern_changes;
-    uint32_t sensor_readings;
-    uint32_t system_uptime_sec;
-    bool system_healthy;
+    mx_metric_t watchdog_timeouts;
+    mx_metric_t pattern_changes;
+    mx_metric_t sensor_readings;
+    mx_metric_t system_uptime_sec;      // gauge
+    mx_metric_t system_healthy;         // gauge, 0 or 1
+    mx_metric_t temperature_mc;         // gauge, last reading in m°C
+    mx_metric_t sensor_rate_mhz;        // gauge, readings per 1000 s
+    mx_metric_t pattern_selected[PATTERN_MAX];
 } system_health_t;
 
 // Global Variables
-TimerHandle_t watchdog_timer;
-TimerHandle_t feed_timer;
-TimerHandle_t pattern_timer;
-TimerHandle_t sensor_timer;
 TimerHandle_t status_timer;
 
-QueueHandle_t sensor_queue;
 QueueHandle_t pattern_queue;
 
 led_pattern_t current_pattern = PATTERN_OFF;
-int pattern_step = 0;
-system_health_t health_stats = {0, 0, 0, 0, 0, true};
-
-// Pattern state for complex patterns
-typedef struct {
-    int step;
-    int direction;
-    int intensity;
-    bool state;
-} pattern_state_t;
-
-pattern_state_t pattern_state = {0, 1, 0, false};
-
-// ADC calibration
-esp_adc_cal_characteristics_t *adc_chars;
+wf_player_t led_player;
+system_health_t health_stats;
+static char pattern_labels[PATTERN_MAX][24];
+
+// Continuous ADC acquisition
+acq_t sensor_acq;
+
+// Supervisor check-in slots
+int sensor_slot = -1;
+int monitor_slot = -1;
+int status_slot = -1;
+int escalated_slots = 0;
+
+// Adaptive sampling rate of the sensor (readings per second)
+ar_controller_t rate_ctl;
+ar_stream_t sensor_rate;
+static const ar_config_t sensor_rate_cfg = {
+    .min_hz = (float)ACQ_ADC_RATE_HZ / (ACQ_BLOCK_SAMPLES * SENSOR_DECIM_SLOW),
+    .max_hz = (float)ACQ_ADC_RATE_HZ / (ACQ_BLOCK_SAMPLES * SENSOR_DECIM_FAST),
+    .slope_ref = 0.25f,     // °C/s
+    .noise_ref = 3.0f,      // °C
+    .cost_us = SENSOR_READING_COST_US,
+    .hysteresis = 0.25f,
+    .dwell = 3,
+};
 
 // ================ WATCHDOG SYSTEM ================
-
-void watchdog_timeout_callback(TimerHandle_t timer) {
-    health_stats.watchdog_timeouts++;
-    health_stats.system_healthy = false;
-    
-    ESP_LOGE(TAG, "🚨 WATCHDOG TIMEOUT! System may be hung!");
-    ESP_LOGE(TAG, "System stats: Feeds=%lu, Timeouts=%lu", 
-             health_stats.watchdog_feeds, health_stats.watchdog_timeouts);
-    
-    // Flash watchdog LED rapidly
-    for (int i = 0; i < 10; i++) {
-        gpio_set_level(WATCHDOG_LED, 1);
-        vTaskDelay(pdMS_TO_TICKS(50));
-        gpio_set_level(WATCHDOG_LED, 0);
-        vTaskDelay(pdMS_TO_TICKS(50));
-    }
-    
-    // In production, this would trigger system reset
-    ESP_LOGW(TAG, "In production: esp_restart() would be called here");
-    
-    // Reset watchdog for continued operation
-    xTimerReset(watchdog_timer, 0);
-    health_stats.system_healthy = true;
-}
-
-void feed_watchdog_callback(TimerHandle_t timer) {
-    static int feed_count = 0;
-    feed_count++;
-    
-    // Simulate occasional system issues
-    if (feed_count == 15) {
-        ESP_LOGW(TAG, "🐛 Simulating system hang - stopping watchdog feeds for 8 seconds");
-        xTimerStop(feed_timer, 0);
-        
-        // Create recovery timer
-        TimerHandle_t recovery_timer = xTimerCreate("Recovery", 
-                                                   pdMS_TO_TICKS(8000),
-                                                   pdFALSE, // One-shot
-                                                   (void*)0,
-                                                   recovery_callback);
-        xTimerStart(recovery_timer, 0);
-        return;
+// Tasks check in with the supervisor (task_supervisor.h); it escalates from
+// a log to a task restart, a sensor power cycle and finally a reset
+
+void watchdog_hook(int slot, const char *name, sup_level_t level, void *ctx) {
+    if (level == SUP_LOG) {
+        mx_inc(&health_stats.watchdog_timeouts);
+        escalated_slots++;
+        ESP_LOGE(TAG, "🚨 WATCHDOG: %s is not checking in!", name);
+    } else if (level == SUP_OK) {
+        escalated_slots--;
     }
-    
-    health_stats.watchdog_feeds++;
-    ESP_LOGI(TAG, "🍖 Feeding watchdog (feed #%lu)", health_stats.watchdog_feeds);
-    
-    // Reset watchdog timer
-    xTimerReset(watchdog_timer, 0);
-    
-    // Flash status LED briefly
-    gpio_set_level(STATUS_LED, 1);
-    vTaskDelay(pdMS_TO_TICKS(50));
-    gpio_set_level(STATUS_LED, 0);
+    mx_set(&health_stats.system_healthy, escalated_slots == 0);
+    gpio_set_level(WATCHDOG_LED, escalated_slots > 0);
 }
 
-void recovery_callback(TimerHandle_t timer) {
-    ESP_LOGI(TAG, "🔄 System recovered - resuming watchdog feeds");
-    xTimerStart(feed_timer, 0);
-    xTimerDelete(timer, 0);
+// Subsystem re-initialisation: power-cycle the sensor; the supervisor then
+// respawns SensorProc
+void sensor_subsystem_reinit(void *arg) {
+    gpio_set_level(SENSOR_POWER, 0);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    gpio_set_level(SENSOR_POWER, 1);
 }
 
 // ================ LED PATTERN SYSTEM ================
-
-void set_pattern_leds(bool led1, bool led2, bool led3) {
-    gpio_set_level(PATTERN_LED_1, led1);
-    gpio_set_level(PATTERN_LED_2, led2);
-    gpio_set_level(PATTERN_LED_3, led3);
-}
-
-void pattern_timer_callback(TimerHandle_t timer) {
-    static uint32_t pattern_cycle = 0;
-    pattern_cycle++;
-    
-    switch (current_pattern) {
-        case PATTERN_OFF:
-            set_pattern_leds(0, 0, 0);
-            xTimerChangePeriod(timer, pdMS_TO_TICKS(1000), 0);
-            break;
-            
-        case PATTERN_SLOW_BLINK:
-            pattern_state.state = !pattern_state.state;
-            set_pattern_leds(pattern_state.state, 0, 0);
-            xTimerChangePeriod(timer, pdMS_TO_TICKS(1000), 0);
-            ESP_LOGI(TAG, "💡 Slow Blink: %s", pattern_state.state ? "ON" : "OFF");
-            break;
-            
-        case PATTERN_FAST_BLINK:
-            pattern_state.state = !pattern_state.state;
-            set_pattern_leds(0, pattern_state.state, 0);
-            xTimerChangePeriod(timer, pdMS_TO_TICKS(200), 0);
-            break;
-            
-        case PATTERN_HEARTBEAT: {
-            // Double pulse pattern
-            int step = pattern_step % 10;
-            bool pulse = (step < 2) || (step >= 3 && step < 5);
-            set_pattern_leds(0, 0, pulse);
-            pattern_step++;
-            xTimerChangePeriod(timer, pdMS_TO_TICKS(100), 0);
-            if (step == 9) ESP_LOGI(TAG, "💓 Heartbeat pulse");
-            break;
-        }
-        
-        case PATTERN_SOS: {
-            // SOS: ... --- ... (dots and dashes)
-            static const char* sos = "...---...";
-            static int sos_pos = 0;
-            
-            bool on = (sos[sos_pos] == '.');
-            int duration = on ? 200 : 600; // Dot: 200ms, Dash: 600ms
-            
-            set_pattern_leds(on, on, on);
-            
-            sos_pos = (sos_pos + 1) % strlen(sos);
-            if (sos_pos == 0) {
-                ESP_LOGI(TAG, "🆘 SOS Pattern Complete");
-                vTaskDelay(pdMS_TO_TICKS(1000)); // Pause between repeats
-            }
-            
-            xTimerChangePeriod(timer, pdMS_TO_TICKS(duration), 0);
-            break;
-        }
-        
-        case PATTERN_RAINBOW: {
-            // Cycle through LED combinations
-            int rainbow_step = pattern_step % 8;
-            bool led1 = (rainbow_step & 1) != 0;
-            bool led2 = (rainbow_step & 2) != 0;
-            bool led3 = (rainbow_step & 4) != 0;
-            
-            set_pattern_leds(led1, led2, led3);
-            pattern_step++;
-            
-            if (rainbow_step == 7) ESP_LOGI(TAG, "🌈 Rainbow cycle complete");
-            xTimerChangePeriod(timer, pdMS_TO_TICKS(300), 0);
-            break;
-        }
-        
-        default:
-            set_pattern_leds(0, 0, 0);
-            break;
-    }
-    
-    // Change pattern every 50 cycles
-    if (pattern_cycle % 50 == 0) {
-        led_pattern_t new_pattern = (current_pattern + 1) % PATTERN_MAX;
-        change_led_pattern(new_pattern);
-    }
-}
+// Patterns are (LED mask, duration) tables played by the waveform player;
+// bit 0/1/2 = PATTERN_LED_1/2/3
+
+#define LED1 (1 << 0)
+#define LED2 (1 << 1)
+#define LED3 (1 << 2)
+#define LEDS (LED1 | LED2 | LED3)
+
+static const wf_step_t pat_off[]        = {{0, 1000}};
+static const wf_step_t pat_slow_blink[] = {{LED1, 1000}, {0, 1000}};
+static const wf_step_t pat_fast_blink[] = {{LED2, 200}, {0, 200}};
+static const wf_step_t pat_heartbeat[]  = {{LED3, 200}, {0, 100}, {LED3, 200}, {0, 500}};  // double pulse
+
+// Morse, 200 ms unit: dot 1, dash 3, inside a letter 1, between letters 3,
+// then a 7-unit pause before repeating
+static const wf_step_t pat_sos[] = {
+    {LEDS, 200}, {0, 200}, {LEDS, 200}, {0, 200}, {LEDS, 200}, {0, 600},
+    {LEDS, 600}, {0, 200}, {LEDS, 600}, {0, 200}, {LEDS, 600}, {0, 600},
+    {LEDS, 200}, {0, 200}, {LEDS, 200}, {0, 200}, {LEDS, 200}, {0, 1400},
+};
+
+static const wf_step_t pat_rainbow[] = {
+    {0, 300}, {LED1, 300}, {LED2, 300}, {LED1 | LED2, 300},
+    {LED3, 300}, {LED1 | LED3, 300}, {LED2 | LED3, 300}, {LEDS, 300},
+};
+
+static const wf_pattern_t led_patterns[PATTERN_MAX] = {
+    [PATTERN_OFF]        = WF_PATTERN("OFF", pat_off),
+    [PATTERN_SLOW_BLINK] = WF_PATTERN("SLOW_BLINK", pat_slow_blink),
+    [PATTERN_FAST_BLINK] = WF_PATTERN("FAST_BLINK", pat_fast_blink),
+    [PATTERN_HEARTBEAT]  = WF_PATTERN("HEARTBEAT", pat_heartbeat),
+    [PATTERN_SOS]        = WF_PATTERN("SOS", pat_sos),
+    [PATTERN_RAINBOW]    = WF_PATTERN("RAINBOW", pat_rainbow),
+};
 
 void change_led_pattern(led_pattern_t new_pattern) {
-    const char* pattern_names[] = {
-        "OFF", "SLOW_BLINK", "FAST_BLINK", 
-        "HEARTBEAT", "SOS", "RAINBOW"
-    };
-    
     ESP_LOGI(TAG, "🎨 Changing pattern: %s -> %s", 
-             pattern_names[current_pattern], pattern_names[new_pattern]);
+             led_patterns[current_pattern].name, led_patterns[new_pattern].name);
     
     current_pattern = new_pattern;
-    pattern_step = 0;
-    pattern_state.step = 0;
-    pattern_state.state = false;
-    health_stats.pattern_changes++;
+    mx_inc(&health_stats.pattern_changes);
+    mx_inc(&health_stats.pattern_selected[new_pattern]);
     
-    // Reset timer with new pattern
-    xTimerReset(pattern_timer, 0);
+    // Swap the table; the player restarts on it right away
+    wf_play(&led_player, &led_patterns[new_pattern]);
 }
 
-// ================ SENSOR SYSTEM ================
-
-float read_sensor_value(void) {
-    // Enable sensor power
-    gpio_set_level(SENSOR_POWER, 1);
-    vTaskDelay(pdMS_TO_TICKS(10)); // Power stabilization
-    
-    // Read ADC value (simulated sensor)
-    uint32_t adc_reading = adc1_get_raw(ADC1_CHANNEL_0);
-    uint32_t voltage = esp_adc_cal_raw_to_voltage(adc_reading, adc_chars);
-    
-    // Convert to meaningful sensor value (e.g., temperature)
-    float sensor_value = (voltage / 1000.0) * 50.0; // 0-50°C range
+// Called by the player (esp_timer task) each time a table wraps around
+void pattern_wrap_hook(const wf_pattern_t *pattern, uint32_t steps, void *ctx) {
+    static uint32_t steps_at_change = 0;
     
-    // Add some noise/variation
-    sensor_value += (esp_random() % 100 - 50) / 100.0;
-    
-    // Disable sensor power to save energy
-    gpio_set_level(SENSOR_POWER, 0);
+    if (pattern == &led_patterns[PATTERN_HEARTBEAT]) {
+        ESP_LOGI(TAG, "💓 Heartbeat pulse");
+    } else if (pattern == &led_patterns[PATTERN_SOS]) {
+        ESP_LOGI(TAG, "🆘 SOS Pattern Complete");
+    } else if (pattern == &led_patterns[PATTERN_RAINBOW]) {
+        ESP_LOGI(TAG, "🌈 Rainbow cycle complete");
+    }
     
-    return sensor_value;
+    // Rotate patterns, at a wrap so a pattern is never cut mid-cycle
+    if (steps - steps_at_change >= PATTERN_ROTATE_STEPS) {
+        steps_at_change = steps;
+        change_led_pattern((current_pattern + 1) % PATTERN_MAX);
+    }
 }
 
-void sensor_timer_callback(TimerHandle_t timer) {
+// ================ SENSOR SYSTEM ================
+
+// The ADC runs continuously (acquisition.h); each full block becomes one
+// reading, the block mean in °C (sensor scale 20 mV/°C)
+sensor_data_t reduce_block(const acq_block_t *block) {
     sensor_data_t sensor_data;
+    int32_t sum = 0;
     
-    sensor_data.value = read_sensor_value();
-    sensor_data.timestamp = xTaskGetTickCount();
-    sensor_data.valid = (sensor_data.value >= 0 && sensor_data.value <= 50);
-    
-    health_stats.sensor_readings++;
-    
-    // Send to processing queue
-    BaseType_t higher_priority_task_woken = pdFALSE;
-    if (xQueueSendFromISR(sensor_queue, &sensor_data, &higher_priority_task_woken) != pdTRUE) {
-        ESP_LOGW(TAG, "Sensor queue full - dropping sample");
+    for (int i = 0; i < block->count; i++) {
+        sum += block->mv[i];
     }
-    
-    // Adaptive sampling based on sensor value
-    TickType_t new_period;
-    if (sensor_data.value > 40.0) {
-        new_period = pdMS_TO_TICKS(500);  // High temp - sample faster
-    } else if (sensor_data.value > 25.0) {
-        new_period = pdMS_TO_TICKS(1000); // Normal temp
-    } else {
-        new_period = pdMS_TO_TICKS(2000); // Low temp - sample slower
+    sensor_data.value = SV_FROM_RATIO(sum * 50, block->count * 1000); // 0-50°C range
+    sensor_data.timestamp = (uint32_t)(block->t_first_us / 1000);
+    sensor_data.valid = (sensor_data.value >= SV_CONST(0) && sensor_data.value <= SV_CONST(50));
+    return sensor_data;
+}
+
+// Adaptive sampling: only the decimation changes, taking effect at the next
+// block; the ADC and its DMA keep running untouched
+uint32_t sensor_decimation_for_hz(float readings_hz) {
+    uint32_t decimation = (uint32_t)(ACQ_ADC_RATE_HZ / (readings_hz * ACQ_BLOCK_SAMPLES) + 0.5f);
+    if (decimation < SENSOR_DECIM_FAST) return SENSOR_DECIM_FAST;
+    if (decimation > SENSOR_DECIM_SLOW) return SENSOR_DECIM_SLOW;
+    return decimation;
+}
+
+// One batched update per commit: every stream that moved gets its new rate
+void apply_sensor_rates(ar_stream_t *const *changed, int n, void *ctx) {
+    for (int i = 0; i < n; i++) {
+        acq_set_decimation(changed[i]->user, sensor_decimation_for_hz(changed[i]->applied_hz));
     }
-    
-    xTimerChangePeriodFromISR(timer, new_period, &higher_priority_task_woken);
-    portYIELD_FROM_ISR(higher_priority_task_woken);
 }
 
 // ================ STATUS SYSTEM ================
 
 void status_timer_callback(TimerHandle_t timer) {
-    health_stats.system_uptime_sec = pdTICKS_TO_MS(xTaskGetTickCount()) / 1000;
+    sup_checkin(status_slot);
+    mx_set(&health_stats.system_uptime_sec, pdTICKS_TO_MS(xTaskGetTickCount()) / 1000);
     
     ESP_LOGI(TAG, "\n═══════ SYSTEM STATUS ═══════");
-    ESP_LOGI(TAG, "Uptime: %lu seconds", health_stats.system_uptime_sec);
-    ESP_LOGI(TAG, "System Health: %s", health_stats.system_healthy ? "✅ HEALTHY" : "❌ ISSUES");
-    ESP_LOGI(TAG, "Watchdog Feeds: %lu", health_stats.watchdog_feeds);
-    ESP_LOGI(TAG, "Watchdog Timeouts: %lu", health_stats.watchdog_timeouts);
-    ESP_LOGI(TAG, "Pattern Changes: %lu", health_stats.pattern_changes);
-    ESP_LOGI(TAG, "Sensor Readings: %lu", health_stats.sensor_readings);
-    ESP_LOGI(TAG, "Current Pattern: %d", current_pattern);
+    ESP_LOGI(TAG, "Uptime: %lu seconds", mx_read(&health_stats.system_uptime_sec));
+    ESP_LOGI(TAG, "System Health: %s", mx_read(&health_stats.system_healthy) ? "✅ HEALTHY" : "❌ ISSUES");
+    ESP_LOGI(TAG, "Watchdog Timeouts: %lu", mx_read(&health_stats.watchdog_timeouts));
+    ESP_LOGI(TAG, "Pattern Changes: %lu", mx_read(&health_stats.pattern_changes));
+    ESP_LOGI(TAG, "Sensor Readings: %lu", mx_read(&health_stats.sensor_readings));
+    ESP_LOGI(TAG, "Current Pattern: %s (steps %lu, edge late max %lu us, step cost max %lu us)",
+             led_patterns[current_pattern].name, led_player.steps,
+             led_player.late_max_us, led_player.cb_max_us);
     
     // Check timer states
     ESP_LOGI(TAG, "Timer States:");
-    ESP_LOGI(TAG, "  Watchdog: %s", xTimerIsTimerActive(watchdog_timer) ? "ACTIVE" : "INACTIVE");
-    ESP_LOGI(TAG, "  Feed: %s", xTimerIsTimerActive(feed_timer) ? "ACTIVE" : "INACTIVE");
-    ESP_LOGI(TAG, "  Pattern: %s", xTimerIsTimerActive(pattern_timer) ? "ACTIVE" : "INACTIVE");
-    ESP_LOGI(TAG, "  Sensor: %s", xTimerIsTimerActive(sensor_timer) ? "ACTIVE" : "INACTIVE");
+    ESP_LOGI(TAG, "  Pattern: %s", led_player.running ? "PLAYING" : "STOPPED");
+    acq_stats_t acq;
+    acq_get_stats(&sensor_acq, &acq);
+    ESP_LOGI(TAG, "  Sensor: %.0f Hz, %lu blocks, %lu overruns, busy max %lu us",
+             acq_output_rate_hz(&sensor_acq), acq.blocks, acq.overruns, acq.busy_max_us);
+    ar_report(&rate_ctl);
+    tx_report();
+    sup_report();
     ESP_LOGI(TAG, "════════════════════════════\n");
     
     // Flash status LED
     gpio_set_level(STATUS_LED, 1);
-    vTaskDelay(pdMS_TO_TICKS(200));
+    tx_delay(pdMS_TO_TICKS(200));
     gpio_set_level(STATUS_LED, 0);
 }
 
+// ================ METRICS ================
+// Pulled over the console by tools/metrics_scrape.py (metrics.h)
+
+void init_metrics(void) {
+    mx_counter(&health_stats.watchdog_timeouts, "watchdog_timeouts_total",
+               "Tasks that missed their supervisor check-in", NULL);
+    mx_counter(&health_stats.pattern_changes, "led_pattern_changes_total", "LED pattern switches", NULL);
+    mx_counter(&health_stats.sensor_readings, "sensor_readings_total", "Sensor blocks reduced to a reading", NULL);
+    mx_gauge(&health_stats.system_uptime_sec, "uptime_seconds", "Uptime at the last status report", NULL);
+    mx_gauge(&health_stats.system_healthy, "system_healthy", "1 while no task is escalated", NULL);
+    mx_gauge(&health_stats.temperature_mc, "sensor_temperature_millicelsius", "Last valid sensor reading", NULL);
+    mx_gauge(&health_stats.sensor_rate_mhz, "sensor_rate_millihertz", "Adaptive sensor reading rate", NULL);
+    for (int i = 0; i < PATTERN_MAX; i++) {
+        snprintf(pattern_labels[i], sizeof(pattern_labels[i]), "pattern=\"%s\"", led_patterns[i].name);
+        mx_counter(&health_stats.pattern_selected[i], "led_pattern_selected_total",
+                   "Times each LED pattern was started", pattern_labels[i]);
+    }
+    mx_set(&health_stats.system_healthy, 1);
+}
+
 // ================ PROCESSING TASKS ================
 
 void sensor_processing_task(void *parameter) {
+    static bool hang_simulated = false;
     sensor_data_t sensor_data;
-    float temp_sum = 0;
-    int sample_count = 0;
+    sensor_avg_t temp_avg;
     
-    ESP_LOGI(TAG, "Sensor processing task started");
+    SV_AVG_RESET(&temp_avg);
+    ESP_LOGI(TAG, "Sensor processing task started (%s path)", SV_PATH_NAME);
     
     while (1) {
-        if (xQueueReceive(sensor_queue, &sensor_data, portMAX_DELAY) == pdTRUE) {
+        acq_block_t *block = acq_receive(&sensor_acq, portMAX_DELAY);
+        if (block) {
+            sensor_data = reduce_block(block);
+            acq_release(&sensor_acq, block);
+            mx_inc(&health_stats.sensor_readings);
+            sup_checkin(sensor_slot);
+            
+            // Simulate a hang once; no block is held here, so the
+            // supervisor can delete and respawn the task safely
+            if (mx_read(&health_stats.sensor_readings) == HANG_AFTER_READINGS && !hang_simulated) {
+                hang_simulated = true;
+                ESP_LOGW(TAG, "🐛 Simulating sensor task hang for %d seconds", HANG_MS / 1000);
+                vTaskDelay(pdMS_TO_TICKS(HANG_MS));
+            }
+            
             if (sensor_data.valid) {
-                temp_sum += sensor_data.value;
-                sample_count++;
+                ar_observe(&sensor_rate, SV_TO_FLOAT(sensor_data.value), sensor_data.timestamp);
+                ar_commit(&rate_ctl, apply_sensor_rates, NULL);
+                mx_set(&health_stats.temperature_mc, SV_TO_FLOAT(sensor_data.value) * 1000);
+                mx_set(&health_stats.sensor_rate_mhz, sensor_rate.applied_hz * 1000);
+                SV_AVG_ADD(&temp_avg, sensor_data.value);
                 
                 ESP_LOGI(TAG, "🌡️ Sensor: %.2f°C at %lu ms", 
-                         sensor_data.value, sensor_data.timestamp);
+                         SV_TO_FLOAT(sensor_data.value), sensor_data.timestamp);
                 
                 // Calculate moving average every 10 samples
-                if (sample_count >= 10) {
-                    float average = temp_sum / sample_count;
-                    ESP_LOGI(TAG, "📊 Temperature Average: %.2f°C", average);
+                if (SV_AVG_COUNT(&temp_avg) >= 10) {
+                    sensor_value_t average = SV_AVG_MEAN(&temp_avg);
+                    ESP_LOGI(TAG, "📊 Temperature Average: %.2f°C", SV_TO_FLOAT(average));
                     
                     // Trigger warnings
-                    if (average > 35.0) {
+                    if (average > SV_CONST(SENSOR_WARN_HIGH)) {
                         ESP_LOGW(TAG, "🔥 High temperature warning!");
                         change_led_pattern(PATTERN_FAST_BLINK);
-                    } else if (average < 15.0) {
+                    } else if (average < SV_CONST(15.0)) {
                         ESP_LOGW(TAG, "🧊 Low temperature warning!");
                         change_led_pattern(PATTERN_SOS);
                     }
                     
                     // Reset counters
-                    temp_sum = 0;
-                    sample_count = 0;
+                    SV_AVG_RESET(&temp_avg);
                 }
             } else {
-                ESP_LOGW(TAG, "Invalid sensor reading: %.2f", sensor_data.value);
+                ESP_LOGW(TAG, "Invalid sensor reading: %.2f", SV_TO_FLOAT(sensor_data.value));
             }
         }
     }
@@ -385,20 +361,22 @@ void system_monitor_task(void *parameter) {
     
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(60000)); // Every minute
+        sup_checkin(monitor_slot);
         
         // Check system health
-        if (health_stats.watchdog_timeouts > 5) {
+        if (mx_read(&health_stats.watchdog_timeouts) > 5) {
             ESP_LOGE(TAG, "🚨 Too many watchdog timeouts - system unstable!");
-            health_stats.system_healthy = false;
+            mx_set(&health_stats.system_healthy, 0);
         }
         
         // Check sensor health
         static uint32_t last_sensor_count = 0;
-        if (health_stats.sensor_readings == last_sensor_count) {
+        uint32_t sensor_count = mx_read(&health_stats.sensor_readings);
+        if (sensor_count == last_sensor_count) {
             ESP_LOGW(TAG, "⚠️ Sensor readings stopped - checking sensor system");
-            // Could restart sensor timer here
+            // The supervisor restarts SensorProc if it stays silent
         }
-        last_sensor_count = health_stats.sensor_readings;
+        last_sensor_count = sensor_count;
         
         // Memory health check (example)
         size_t free_heap = esp_get_free_heap_size();
@@ -410,6 +388,220 @@ void system_monitor_task(void *parameter) {
     }
 }
 
+// Spawn functions, also used by the supervisor to restart the tasks
+TaskHandle_t spawn_sensor_processing(int slot, void *arg) {
+    TaskHandle_t task = NULL;
+    xTaskCreate(sensor_processing_task, "SensorProc", 2048, NULL, 6, &task);
+    return task;
+}
+
+TaskHandle_t spawn_system_monitor(int slot, void *arg) {
+    TaskHandle_t task = NULL;
+    xTaskCreate(system_monitor_task, "SysMonitor", 2048, NULL, 3, &task);
+    return task;
+}
+
+// ================ NUMERIC BENCHMARK ================
+
+#define NUMERIC_BENCH_SAMPLES 2000
+#define NUMERIC_BENCH_BLOCK   10
+
+// Runs the same mV -> °C -> EMA -> block average chain in float and in
+// Q16.16, reports cost per sample and the worst deviation between them.
+void numeric_benchmark(void) {
+    static int32_t mv[NUMERIC_BENCH_SAMPLES];
+    static float out_float[NUMERIC_BENCH_SAMPLES];
+    static fx_t out_fixed[NUMERIC_BENCH_SAMPLES];
+    volatile float float_avg_sink = 0;
+    volatile fx_t fixed_avg_sink = 0;
+    
+    for (int i = 0; i < NUMERIC_BENCH_SAMPLES; i++) {
+        mv[i] = esp_random() % 1100;
+    }
+    
+    // Float path
+    int64_t start = esp_timer_get_time();
+    float ema = 0, block_sum = 0;
+    for (int i = 0; i < NUMERIC_BENCH_SAMPLES; i++) {
+        float t = mv[i] / 1000.0f * 50.0f;
+        ema = (i == 0) ? t : ema + 0.1f * (t - ema);
+        out_float[i] = ema;
+        block_sum += ema;
+        if ((i + 1) % NUMERIC_BENCH_BLOCK == 0) {
+            float_avg_sink = block_sum / NUMERIC_BENCH_BLOCK;
+            block_sum = 0;
+        }
+    }
+    int64_t float_us = esp_timer_get_time() - start;
+    
+    // Fixed path
+    start = esp_timer_get_time();
+    fx_ema_t fx_ema;
+    fx_avg_t fx_block;
+    fx_ema_init(&fx_ema, FX_CONST(0.1));
+    fx_avg_reset(&fx_block);
+    for (int i = 0; i < NUMERIC_BENCH_SAMPLES; i++) {
+        fx_t t = fx_from_ratio(mv[i] * 50, 1000);
+        out_fixed[i] = fx_ema_update(&fx_ema, t);
+        fx_avg_add(&fx_block, out_fixed[i]);
+        if (fx_block.count == NUMERIC_BENCH_BLOCK) {
+            fixed_avg_sink = fx_avg_mean(&fx_block);
+            fx_avg_reset(&fx_block);
+        }
+    }
+    int64_t fixed_us = esp_timer_get_time() - start;
+    
+    // Accuracy
+    float max_err = 0, sq_err = 0;
+    for (int i = 0; i < NUMERIC_BENCH_SAMPLES; i++) {
+        float err = fabsf(fx_to_float(out_fixed[i]) - out_float[i]);
+        if (err > max_err) max_err = err;
+        sq_err += err * err;
+    }
+    (void)float_avg_sink;
+    (void)fixed_avg_sink;
+    
+    ESP_LOGI(TAG, "🧮 Numeric benchmark (%d samples, pipeline uses %s):",
+             NUMERIC_BENCH_SAMPLES, SV_PATH_NAME);
+    ESP_LOGI(TAG, "  float : %lld ns/sample", float_us * 1000 / NUMERIC_BENCH_SAMPLES);
+    ESP_LOGI(TAG, "  Q16.16: %lld ns/sample", fixed_us * 1000 / NUMERIC_BENCH_SAMPLES);
+    ESP_LOGI(TAG, "  error : max %.6f°C, rms %.6f°C",
+             max_err, sqrtf(sq_err / NUMERIC_BENCH_SAMPLES));
+}
+
+// ================ ADAPTIVE RATE BENCHMARK ================
+
+#define TRACE_LENGTH_MS     600000
+#define TRACE_TRUTH_STEP_MS 10
+#define TRACE_REARM         33.0f   // °C, an event ends below this
+#define TRACE_MAX_EVENTS    8
+
+typedef struct {
+    uint32_t start_ms;
+    uint32_t rise_ms;
+} trace_episode_t;
+
+// Stand-in for a recorded run: ten minutes at 22 °C with +/-0.3 °C sensor
+// noise and three heating episodes of different steepness. Each climbs
+// 18 °C, holds for 20 s and cools over 40 s, crossing SENSOR_WARN_HIGH.
+static const trace_episode_t trace_episodes[] = {
+    {120000, 30000},
+    {300000, 8000},
+    {450000, 60000},
+};
+
+float reference_trace(uint32_t t_ms) {
+    float v = 22.0f;
+    
+    for (int i = 0; i < sizeof(trace_episodes) / sizeof(trace_episodes[0]); i++) {
+        const trace_episode_t *e = &trace_episodes[i];
+        if (t_ms < e->start_ms) continue;
+        uint32_t dt = t_ms - e->start_ms;
+        if (dt < e->rise_ms) {
+            v += 18.0f * dt / e->rise_ms;
+        } else if (dt < e->rise_ms + 20000) {
+            v += 18.0f;
+        } else if (dt < e->rise_ms + 60000) {
+            v += 18.0f * (1.0f - (dt - e->rise_ms - 20000) / 40000.0f);
+        }
+    }
+    uint32_t h = (t_ms / 100) * 2654435761u;   // noise changes every 100 ms
+    return v + ((int)((h >> 16) % 61) - 30) / 100.0f;
+}
+
+typedef struct {
+    uint32_t start_ms;
+    uint32_t end_ms;
+} trace_event_t;
+
+// Ground truth at full resolution: upward crossings of the warning level
+int trace_events(trace_event_t *events) {
+    int n = 0;
+    bool armed = true;
+    
+    for (uint32_t t = 0; t < TRACE_LENGTH_MS; t += TRACE_TRUTH_STEP_MS) {
+        float v = reference_trace(t);
+        if (armed && v > SENSOR_WARN_HIGH && n < TRACE_MAX_EVENTS) {
+            events[n].start_ms = t;
+            events[n].end_ms = TRACE_LENGTH_MS;
+            armed = false;
+        } else if (!armed && v < TRACE_REARM) {
+            events[n++].end_ms = t;
+            armed = true;
+        }
+    }
+    return armed ? n : n + 1;
+}
+
+typedef enum {
+    POLICY_FIXED_FAST = 0,
+    POLICY_FIXED_NORMAL,
+    POLICY_TEMP_BANDS,      // the old temperature thresholds
+    POLICY_ADAPTIVE,
+    POLICY_MAX
+} rate_policy_t;
+
+static const char *policy_names[POLICY_MAX] = {
+    "fixed 4 Hz", "fixed 1 Hz", "temp bands", "adaptive"
+};
+
+// Replays the trace, sampling it at whatever period the policy picks, and
+// measures how long after each true crossing a sample first shows it
+void adaptive_benchmark(void) {
+    trace_event_t events[TRACE_MAX_EVENTS];
+    int n_events = trace_events(events);
+    
+    ESP_LOGI(TAG, "📉 Adaptive rate benchmark (%d s trace, %d events above %.0f°C):",
+             TRACE_LENGTH_MS / 1000, n_events, SENSOR_WARN_HIGH);
+    
+    for (int p = 0; p < POLICY_MAX; p++) {
+        ar_controller_t ctl;
+        ar_stream_t stream;
+        ar_init(&ctl, SENSOR_RATE_BUDGET_US);
+        ar_stream_init(&stream, policy_names[p], &sensor_rate_cfg, sensor_rate_cfg.min_hz, NULL);
+        ar_add(&ctl, &stream);
+        
+        uint32_t samples = 0, detected = 0, lat_max = 0, lat_total = 0;
+        int next = 0;
+        int64_t start = esp_timer_get_time();
+        
+        for (uint32_t t = 0; t < TRACE_LENGTH_MS; ) {
+            float v = reference_trace(t);
+            samples++;
+            
+            while (next < n_events && t > events[next].end_ms) {
+                next++;     // missed: the excursion ended between samples
+            }
+            if (next < n_events && t >= events[next].start_ms && v > SENSOR_WARN_HIGH) {
+                uint32_t lat = t - events[next].start_ms;
+                lat_total += lat;
+                if (lat > lat_max) lat_max = lat;
+                detected++;
+                next++;
+            }
+            
+            float hz;
+            switch (p) {
+            case POLICY_FIXED_FAST:   hz = sensor_rate_cfg.max_hz; break;
+            case POLICY_FIXED_NORMAL: hz = 1.0f; break;
+            case POLICY_TEMP_BANDS:   hz = v > 40.0f ? 2.0f : (v > 25.0f ? 1.0f : 0.5f); break;
+            default:
+                ar_observe(&stream, v, t);
+                ar_commit(&ctl, NULL, NULL);
+                hz = stream.applied_hz;
+                break;
+            }
+            t += (uint32_t)(1000.0f / hz);
+        }
+        int64_t took = esp_timer_get_time() - start;
+        
+        ESP_LOGI(TAG, "  %-10s: %4lu samples (%5.1f%% saved vs 4 Hz) | detected %lu/%d | latency avg %lu ms, max %lu ms | %lld us",
+                 policy_names[p], samples,
+                 100.0f * (1.0f - samples / (TRACE_LENGTH_MS / 1000.0f * sensor_rate_cfg.max_hz)),
+                 detected, n_events, detected ? lat_total / detected : 0, lat_max, took);
+    }
+}
+
 // ================ INITIALIZATION ================
 
 void init_hardware(void) {
@@ -429,54 +621,27 @@ void init_hardware(void) {
     gpio_set_level(PATTERN_LED_3, 0);
     gpio_set_level(SENSOR_POWER, 0);
     
-    // Configure ADC
-    adc1_config_width(ADC_WIDTH_BIT_12);
-    adc1_config_channel_atten(ADC1_CHANNEL_0, ADC_ATTEN_DB_11);
-    
-    // Characterize ADC
-    adc_chars = calloc(1, sizeof(esp_adc_cal_characteristics_t));
-    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, adc_chars);
+    // LED pattern player drives the three pattern LEDs together
+    const int pattern_pins[] = {PATTERN_LED_1, PATTERN_LED_2, PATTERN_LED_3};
+    wf_init(&led_player, pattern_pins, 3);
+    wf_set_wrap_hook(&led_player, pattern_wrap_hook, NULL);
     
     ESP_LOGI(TAG, "Hardware initialization complete");
 }
 
 void create_timers(void) {
-    // Create watchdog timer (one-shot)
-    watchdog_timer = xTimerCreate("WatchdogTimer",
-                                 pdMS_TO_TICKS(WATCHDOG_TIMEOUT_MS),
-                                 pdFALSE, // One-shot
-                                 (void*)1,
-                                 watchdog_timeout_callback);
-    
-    // Create feed timer (auto-reload)
-    feed_timer = xTimerCreate("FeedTimer",
-                             pdMS_TO_TICKS(WATCHDOG_FEED_MS),
-                             pdTRUE, // Auto-reload
-                             (void*)2,
-                             feed_watchdog_callback);
-    
-    // Create pattern timer (auto-reload)
-    pattern_timer = xTimerCreate("PatternTimer",
-                                pdMS_TO_TICKS(PATTERN_BASE_MS),
-                                pdTRUE, // Auto-reload
-                                (void*)3,
-                                pattern_timer_callback);
-    
-    // Create sensor timer (auto-reload)
-    sensor_timer = xTimerCreate("SensorTimer",
-                               pdMS_TO_TICKS(SENSOR_SAMPLE_MS),
-                               pdTRUE, // Auto-reload
-                               (void*)4,
-                               sensor_timer_callback);
-    
-    // Create status timer (auto-reload)
-    status_timer = xTimerCreate("StatusTimer",
-                               pdMS_TO_TICKS(STATUS_UPDATE_MS),
-                               pdTRUE, // Auto-reload
-                               (void*)5,
-                               status_timer_callback);
-    
-    if (!watchdog_timer || !feed_timer || !pattern_timer || !sensor_timer || !status_timer) {
+    // Callbacks that flash LEDs or sleep go to the worker pool so they
+    // cannot hold up the timer daemon; the rest run inline under a budget
+    tx_init(TIMER_WORKERS, TIMER_WORKER_PRIORITY);
+    
+    // Create status timer (auto-reload, long report)
+    status_timer = tx_timer_create("StatusTimer",
+                                   pdMS_TO_TICKS(STATUS_UPDATE_MS),
+                                   pdTRUE, // Auto-reload
+                                   TX_OFFLOAD, TIMER_BUDGET_US,
+                                   status_timer_callback);
+    
+    if (!status_timer) {
         ESP_LOGE(TAG, "Failed to create one or more timers");
         return;
     }
@@ -485,10 +650,9 @@ void create_timers(void) {
 }
 
 void create_queues(void) {
-    sensor_queue = xQueueCreate(20, sizeof(sensor_data_t));
     pattern_queue = xQueueCreate(10, sizeof(led_pattern_t));
     
-    if (!sensor_queue || !pattern_queue) {
+    if (!pattern_queue) {
         ESP_LOGE(TAG, "Failed to create queues");
         return;
     }
@@ -500,15 +664,32 @@ void start_system(void) {
     // Start all timers
     ESP_LOGI(TAG, "Starting timer system...");
     
-    xTimerStart(watchdog_timer, 0);
-    xTimerStart(feed_timer, 0);
-    xTimerStart(pattern_timer, 0);
-    xTimerStart(sensor_timer, 0);
     xTimerStart(status_timer, 0);
     
-    // Create processing tasks
-    xTaskCreate(sensor_processing_task, "SensorProc", 2048, NULL, 6, NULL);
-    xTaskCreate(system_monitor_task, "SysMonitor", 2048, NULL, 3, NULL);
+    // Sensor stays powered: it is sampled continuously now
+    gpio_set_level(SENSOR_POWER, 1);
+    ar_init(&rate_ctl, SENSOR_RATE_BUDGET_US);
+    ar_stream_init(&sensor_rate, "sensor", &sensor_rate_cfg,
+                   (float)ACQ_ADC_RATE_HZ / (ACQ_BLOCK_SAMPLES * SENSOR_DECIM_NORMAL), &sensor_acq);
+    ar_add(&rate_ctl, &sensor_rate);
+    if (!acq_start(&sensor_acq, SENSOR_ADC_CHANNEL, SENSOR_DECIM_NORMAL, 7)) {
+        ESP_LOGE(TAG, "Sensor acquisition failed to start");
+    }
+    
+    // Create processing tasks under supervision
+    sup_set_hook(watchdog_hook, NULL);
+    int sensor_subsystem = sup_add_subsystem("sensor", sensor_subsystem_reinit, NULL);
+    sensor_slot = sup_register("SensorProc", NULL, WATCHDOG_TIMEOUT_MS,
+                               sensor_subsystem, spawn_sensor_processing, NULL);
+    sup_attach(sensor_slot, spawn_sensor_processing(sensor_slot, NULL));
+    monitor_slot = sup_register("SysMonitor", NULL, MONITOR_DEADLINE_MS,
+                                -1, spawn_system_monitor, NULL);
+    sup_attach(monitor_slot, spawn_system_monitor(monitor_slot, NULL));
+    status_slot = sup_register("StatusTimer", NULL, STATUS_DEADLINE_MS, -1, NULL, NULL);
+    sup_init(SUPERVISOR_SCAN_MS, 8, false);
+    if (!mx_serve_start(1)) {
+        ESP_LOGE(TAG, "Metrics server failed to start");
+    }
     
     ESP_LOGI(TAG, "🚀 Timer Applications System Started!");
     ESP_LOGI(TAG, "Watch the LEDs for different patterns and system status");
@@ -518,7 +699,10 @@ void app_main(void) {
     ESP_LOGI(TAG, "Timer Applications Lab Starting...");
     
     // Initialize components
+    init_metrics();
     init_hardware();
+    numeric_benchmark();
+    adaptive_benchmark();
     create_queues();
     create_timers();
     
@@ -0,0 +1,239 @@
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "acquisition.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#define IRAM_ATTR
+#else
+#include "esp_attr.h"
+#include "soc/soc_caps.h"
+
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define ACQ_OUTPUT_FORMAT  ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define ACQ_RAW(p)         ((p)->type1.data)
+#else
+#define ACQ_OUTPUT_FORMAT  ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define ACQ_RAW(p)         ((p)->type2.data)
+#endif
+#endif
+
+static const char *TAG = "ACQ";
+
+// ================ SAMPLE PATH (acquisition task only) ================
+
+static uint32_t to_mv(acq_t *a, uint32_t raw) {
+#if CONFIG_IDF_TARGET_LINUX
+    return raw;   // the generator already produces mV
+#else
+    int mv;
+    if (a->cali && adc_cali_raw_to_voltage(a->cali, raw, &mv) == ESP_OK)
+        return mv;
+    return raw * 3100 / 4095;   // uncalibrated, 11 dB full scale
+#endif
+}
+
+static void publish(acq_t *a) {
+    int other = !a->fill;
+    acq_block_t *b = &a->buf[a->fill];
+
+    if (__atomic_load_n(&a->held, __ATOMIC_ACQUIRE) & (1u << other)) {
+        a->stats.overruns++;
+        b->count = 0;   // refill the same block
+        return;
+    }
+    b->seq = a->seq++;
+    __atomic_fetch_or(&a->held, 1u << a->fill, __ATOMIC_ACQ_REL);
+    xQueueSend(a->full, &b, 0);
+    a->stats.blocks++;
+    a->fill = other;
+    a->buf[other].count = 0;
+}
+
+static void push_raw(acq_t *a, uint32_t raw) {
+    acq_block_t *b = &a->buf[a->fill];
+
+    if (b->count == 0 && a->acc_n == 0)
+        b->decimation = __atomic_load_n(&a->decimation, __ATOMIC_RELAXED);
+    a->stats.raw_conversions++;
+    a->acc += raw;
+    if (++a->acc_n < b->decimation)
+        return;
+
+    uint32_t avg = a->acc / a->acc_n;
+    a->acc = 0;
+    a->acc_n = 0;
+    if (b->count == 0)
+        b->t_first_us = esp_timer_get_time();
+    b->mv[b->count++] = to_mv(a, avg);
+    if (b->count == ACQ_BLOCK_SAMPLES)
+        publish(a);
+}
+
+static void note_busy(acq_t *a, int64_t start) {
+    uint32_t took = (uint32_t)(esp_timer_get_time() - start);
+    if (took > a->stats.busy_max_us)
+        a->stats.busy_max_us = took;
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+
+// ================ SYNTHETIC SOURCE ================
+// 25 °C +/- 15 °C over a minute (sensor scale is 20 mV/°C) plus a few mV
+// of noise, generated one tick's worth at a time
+static void acq_task(void *pv) {
+    acq_t *a = pv;
+    const uint32_t per_tick = ACQ_ADC_RATE_HZ / configTICK_RATE_HZ;
+    uint32_t n = 0, lcg = 12345;
+    TickType_t last = xTaskGetTickCount();
+
+    while (1) {
+        vTaskDelayUntil(&last, 1);
+        int64_t start = esp_timer_get_time();
+        for (uint32_t i = 0; i < per_tick; i++, n++) {
+            float t = (float)n / ACQ_ADC_RATE_HZ;
+            lcg = lcg * 1103515245u + 12345u;
+            int32_t noise = (int32_t)((lcg >> 16) % 21) - 10;
+            push_raw(a, (uint32_t)(500.0f + 300.0f * sinf(2.0f * (float)M_PI * t / 60.0f)) + noise);
+        }
+        note_busy(a, start);
+    }
+}
+
+static bool source_start(acq_t *a, int adc_channel) {
+    (void)adc_channel;
+    ESP_LOGI(TAG, "Synthetic source at %d Hz", ACQ_ADC_RATE_HZ);
+    return true;
+}
+
+#else
+
+// ================ ADC CONTINUOUS SOURCE ================
+
+static bool IRAM_ATTR on_conv_done(adc_continuous_handle_t handle,
+                                   const adc_continuous_evt_data_t *edata, void *user_data) {
+    acq_t *a = user_data;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(a->task, &woken);
+    return woken == pdTRUE;
+}
+
+static void acq_task(void *pv) {
+    acq_t *a = pv;
+    static uint8_t frame[ACQ_FRAME_BYTES];
+    uint32_t got;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int64_t start = esp_timer_get_time();
+        while (adc_continuous_read(a->adc, frame, sizeof(frame), &got, 0) == ESP_OK) {
+            for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= got; i += SOC_ADC_DIGI_RESULT_BYTES) {
+                adc_digi_output_data_t *d = (adc_digi_output_data_t *)&frame[i];
+                push_raw(a, ACQ_RAW(d));
+            }
+        }
+        note_busy(a, start);
+    }
+}
+
+static void cali_init(acq_t *a, int adc_channel) {
+    esp_err_t err = ESP_ERR_NOT_SUPPORTED;
+#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
+    adc_cali_curve_fitting_config_t cfg = {
+        .unit_id = ADC_UNIT_1,
+        .chan = adc_channel,
+        .atten = ADC_ATTEN_DB_11,
+        .bitwidth = ADC_BITWIDTH_DEFAULT,
+    };
+    err = adc_cali_create_scheme_curve_fitting(&cfg, &a->cali);
+#elif ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
+    adc_cali_line_fitting_config_t cfg = {
+        .unit_id = ADC_UNIT_1,
+        .atten = ADC_ATTEN_DB_11,
+        .bitwidth = ADC_BITWIDTH_DEFAULT,
+    };
+    err = adc_cali_create_scheme_line_fitting(&cfg, &a->cali);
+#endif
+    if (err != ESP_OK) {
+        a->cali = NULL;
+        ESP_LOGW(TAG, "No ADC calibration, using nominal scale");
+    }
+}
+
+static bool source_start(acq_t *a, int adc_channel) {
+    adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = 4 * ACQ_FRAME_BYTES,
+        .conv_frame_size = ACQ_FRAME_BYTES,
+    };
+    if (adc_continuous_new_handle(&handle_cfg, &a->adc) != ESP_OK)
+        return false;
+
+    adc_digi_pattern_config_t pattern = {
+        .atten = ADC_ATTEN_DB_11,
+        .channel = adc_channel,
+        .unit = ADC_UNIT_1,
+        .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH,
+    };
+    adc_continuous_config_t cfg = {
+        .pattern_num = 1,
+        .adc_pattern = &pattern,
+        .sample_freq_hz = ACQ_ADC_RATE_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ACQ_OUTPUT_FORMAT,
+    };
+    adc_continuous_evt_cbs_t cbs = {
+        .on_conv_done = on_conv_done,
+    };
+    cali_init(a, adc_channel);
+    if (adc_continuous_config(a->adc, &cfg) != ESP_OK ||
+        adc_continuous_register_event_callbacks(a->adc, &cbs, a) != ESP_OK ||
+        adc_continuous_start(a->adc) != ESP_OK) {
+        ESP_LOGE(TAG, "ADC continuous mode setup failed");
+        return false;
+    }
+    ESP_LOGI(TAG, "ADC1 channel %d continuous at %d Hz", adc_channel, ACQ_ADC_RATE_HZ);
+    return true;
+}
+
+#endif
+
+// ================ PUBLIC API ================
+
+bool acq_start(acq_t *a, int adc_channel, uint32_t decimation, UBaseType_t priority) {
+    memset(a, 0, sizeof(*a));
+    a->decimation = decimation ? decimation : 1;
+    a->full = xQueueCreate(2, sizeof(acq_block_t *));
+    if (!a->full)
+        return false;
+    // The task must exist before the source can notify it
+    if (xTaskCreate(acq_task, "Acquire", 3072, a, priority, &a->task) != pdPASS)
+        return false;
+    return source_start(a, adc_channel);
+}
+
+acq_block_t *acq_receive(acq_t *a, TickType_t timeout) {
+    acq_block_t *b = NULL;
+    return xQueueReceive(a->full, &b, timeout) == pdTRUE ? b : NULL;
+}
+
+void acq_release(acq_t *a, acq_block_t *block) {
+    int idx = block == &a->buf[1];
+    __atomic_fetch_and(&a->held, ~(1u << idx), __ATOMIC_ACQ_REL);
+}
+
+void acq_set_decimation(acq_t *a, uint32_t decimation) {
+    __atomic_store_n(&a->decimation, decimation ? decimation : 1, __ATOMIC_RELAXED);
+}
+
+uint32_t acq_decimation(const acq_t *a) {
+    return __atomic_load_n(&a->decimation, __ATOMIC_RELAXED);
+}
+
+float acq_output_rate_hz(const acq_t *a) {
+    return (float)ACQ_ADC_RATE_HZ / acq_decimation(a);
+}
+
+void acq_get_stats(const acq_t *a, acq_stats_t *out) {
+    *out = a->stats;
+}
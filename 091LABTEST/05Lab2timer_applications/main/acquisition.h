@@ -0,0 +1,81 @@
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_adc/adc_continuous.h"
+#include "esp_adc/adc_cali.h"
+#endif
+
+// ============================= ACQUISITION =============================
+// Continuous sampling of one ADC channel into a pair of ping-pong blocks.
+//
+// On target the ADC runs in continuous (DMA) mode at ACQ_ADC_RATE_HZ. A
+// conversion-done callback wakes the acquisition task, which drains whole
+// DMA frames. On the Linux host (CONFIG_IDF_TARGET_LINUX) a synthetic
+// waveform generator produces the same stream. Every `decimation` raw
+// conversions are box-car averaged into one output sample in mV, so the
+// decimation factor sets the output rate (ACQ_ADC_RATE_HZ / decimation)
+// without touching the ADC or any timer. A change takes effect at the next
+// block boundary, so every block has a single rate.
+//
+// Full blocks are handed over by pointer: acq_receive() returns one, and
+// the consumer must acq_release() it. While the consumer still holds the
+// other block, a newly filled block is discarded and counted as an
+// overrun. Samples are never overwritten under the consumer.
+
+#define ACQ_ADC_RATE_HZ   20000
+#define ACQ_BLOCK_SAMPLES 250
+#define ACQ_FRAME_BYTES   256     // DMA conversion frame
+
+typedef struct {
+    uint16_t mv[ACQ_BLOCK_SAMPLES];
+    uint16_t count;
+    uint16_t decimation;        // raw conversions per sample in this block
+    int64_t t_first_us;         // when the first sample completed
+    uint32_t seq;
+} acq_block_t;
+
+typedef struct {
+    uint32_t raw_conversions;
+    uint32_t blocks;
+    uint32_t overruns;          // block discarded, consumer too slow
+    uint32_t busy_max_us;       // longest stretch the task spent on one wake-up
+} acq_stats_t;
+
+typedef struct {
+    acq_block_t buf[2];
+    QueueHandle_t full;
+    uint32_t held;              // bit i set while buf[i] is with the consumer
+    uint32_t decimation;        // requested; latched per block
+    TaskHandle_t task;
+    // acquisition task only
+    int fill;                   // block being written
+    uint32_t acc;
+    uint32_t acc_n;
+    uint32_t seq;
+    acq_stats_t stats;
+#if !CONFIG_IDF_TARGET_LINUX
+    adc_continuous_handle_t adc;
+    adc_cali_handle_t cali;
+#endif
+} acq_t;
+
+// adc_channel is an ADC1 channel number (ignored on the host)
+bool acq_start(acq_t *a, int adc_channel, uint32_t decimation, UBaseType_t priority);
+
+acq_block_t *acq_receive(acq_t *a, TickType_t timeout);
+void acq_release(acq_t *a, acq_block_t *block);
+
+void acq_set_decimation(acq_t *a, uint32_t decimation);
+uint32_t acq_decimation(const acq_t *a);
+float acq_output_rate_hz(const acq_t *a);
+
+void acq_get_stats(const acq_t *a, acq_stats_t *out);
+
+#endif
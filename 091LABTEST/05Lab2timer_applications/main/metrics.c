@@ -0,0 +1,406 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "metrics.h"
+#ifdef CONFIG_IDF_TARGET_LINUX
+#include <fcntl.h>
+#endif
+
+static const char *TAG = "MX";
+
+#define MX_LINE_MAX     160
+#define MX_POLL_MS      50
+#define MX_CMD_MAX      32
+
+static mx_metric_t *registry_head = NULL;
+
+// ================ REGISTRATION ================
+
+static void mx_init(mx_metric_t *m, const char *name, const char *help, const char *labels,
+                    mx_type_t type) {
+    memset(m, 0, sizeof(*m));
+    m->name = name;
+    m->help = help;
+    m->labels = labels;
+    m->type = type;
+}
+
+// Fields first: an exporter may reach the metric as soon as it is linked
+static void mx_link(mx_metric_t *m) {
+    m->next = __atomic_load_n(&registry_head, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&registry_head, &m->next, m, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+}
+
+void mx_counter(mx_metric_t *m, const char *name, const char *help, const char *labels) {
+    mx_init(m, name, help, labels, MX_COUNTER);
+    mx_link(m);
+}
+
+void mx_gauge(mx_metric_t *m, const char *name, const char *help, const char *labels) {
+    mx_init(m, name, help, labels, MX_GAUGE);
+    mx_link(m);
+}
+
+void mx_histogram(mx_metric_t *m, const char *name, const char *help, const char *labels,
+                  const uint32_t *bounds, int n_bounds) {
+    mx_init(m, name, help, labels, MX_HISTOGRAM);
+    m->bounds = bounds;
+    m->n_bounds = n_bounds < MX_MAX_BUCKETS ? n_bounds : MX_MAX_BUCKETS;
+    mx_link(m);
+}
+
+// ================ UPDATES ================
+
+void mx_observe(mx_metric_t *m, uint32_t v) {
+    int i = 0;
+    while (i < m->n_bounds && v > m->bounds[i])
+        i++;
+    __atomic_fetch_add(&m->bucket[i], 1, __ATOMIC_RELAXED);
+    sc_add(&m->value, v);
+}
+
+uint32_t mx_count(const mx_metric_t *m) {
+    uint32_t n = 0;
+    for (int i = 0; i <= m->n_bounds; i++)
+        n += __atomic_load_n(&m->bucket[i], __ATOMIC_RELAXED);
+    return n;
+}
+
+// ================ ITERATION ================
+// Registered metrics first, then every shard counter from sc_register()
+
+typedef struct {
+    const char *name;
+    const char *help;
+    const char *labels;
+    mx_type_t type;
+    const sc_counter_t *value;      // identity of the metric
+    const mx_metric_t *m;           // NULL for a plain shard counter
+} mx_view_t;
+
+typedef struct {
+    const mx_metric_t *m;
+    const sc_counter_t *c;
+    bool started_sc;
+} mx_iter_t;
+
+static void iter_begin(mx_iter_t *it) {
+    it->m = __atomic_load_n(&registry_head, __ATOMIC_ACQUIRE);
+    it->c = NULL;
+    it->started_sc = false;
+}
+
+static bool iter_next(mx_iter_t *it, mx_view_t *v) {
+    if (it->m) {
+        const mx_metric_t *m = it->m;
+        it->m = m->next;
+        *v = (mx_view_t){m->name, m->help, m->labels, m->type, &m->value, m};
+        return true;
+    }
+    if (!it->started_sc) {
+        it->c = sc_first();
+        it->started_sc = true;
+    }
+    if (!it->c)
+        return false;
+    const sc_counter_t *c = it->c;
+    it->c = c->next;
+    *v = (mx_view_t){c->name, c->help, NULL, c->kind == SC_GAUGE ? MX_GAUGE : MX_COUNTER, c, NULL};
+    return true;
+}
+
+static bool family_seen_before(const mx_view_t *v) {
+    mx_iter_t it;
+    mx_view_t w;
+    iter_begin(&it);
+    while (iter_next(&it, &w) && w.value != v->value)
+        if (strcmp(w.name, v->name) == 0)
+            return true;
+    return false;
+}
+
+// ================ PROMETHEUS TEXT ================
+
+static const char *type_name(mx_type_t type) {
+    switch (type) {
+        case MX_COUNTER:   return "counter";
+        case MX_GAUGE:     return "gauge";
+        default:           return "histogram";
+    }
+}
+
+static void emit(mx_write_fn write, void *ctx, const char *fmt, ...) {
+    char line[MX_LINE_MAX];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (n > 0)
+        write(line, n < (int)sizeof(line) ? n : (int)sizeof(line) - 1, ctx);
+}
+
+static void emit_samples(mx_write_fn write, void *ctx, const mx_view_t *v) {
+    const char *lb = v->labels ? v->labels : "";
+    const char *open = v->labels ? "{" : "";
+    const char *close = v->labels ? "}" : "";
+
+    if (v->type == MX_COUNTER) {
+        emit(write, ctx, "%s%s%s%s %lu\n", v->name, open, lb, close, (unsigned long)sc_read(v->value));
+        return;
+    }
+    if (v->type == MX_GAUGE) {
+        emit(write, ctx, "%s%s%s%s %ld\n", v->name, open, lb, close, (long)(int32_t)sc_read(v->value));
+        return;
+    }
+
+    const mx_metric_t *m = v->m;
+    const char *sep = v->labels ? "," : "";
+    uint32_t cum = 0;
+    for (int i = 0; i <= m->n_bounds; i++) {
+        cum += __atomic_load_n(&m->bucket[i], __ATOMIC_RELAXED);
+        if (i < m->n_bounds)
+            emit(write, ctx, "%s_bucket{%s%sle=\"%lu\"} %lu\n", v->name, lb, sep,
+                 (unsigned long)m->bounds[i], (unsigned long)cum);
+        else
+            emit(write, ctx, "%s_bucket{%s%sle=\"+Inf\"} %lu\n", v->name, lb, sep, (unsigned long)cum);
+    }
+    emit(write, ctx, "%s_sum%s%s%s %lu\n", v->name, open, lb, close, (unsigned long)sc_read(v->value));
+    emit(write, ctx, "%s_count%s%s%s %lu\n", v->name, open, lb, close, (unsigned long)cum);
+}
+
+void mx_export_text(mx_write_fn write, void *ctx) {
+    mx_iter_t it;
+    mx_view_t v;
+
+    iter_begin(&it);
+    while (iter_next(&it, &v)) {
+        if (family_seen_before(&v))
+            continue;
+        if (v.help)
+            emit(write, ctx, "# HELP %s %s\n", v.name, v.help);
+        emit(write, ctx, "# TYPE %s %s\n", v.name, type_name(v.type));
+        emit_samples(write, ctx, &v);
+
+        // Rest of the family, wherever it was registered
+        mx_iter_t rest = it;
+        mx_view_t w;
+        while (iter_next(&rest, &w))
+            if (strcmp(w.name, v.name) == 0)
+                emit_samples(write, ctx, &w);
+    }
+}
+
+// ================ BINARY SNAPSHOT ================
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+} mx_buf_t;
+
+static void put_byte(mx_buf_t *b, uint8_t v) {
+    if (b->len < b->cap)
+        b->buf[b->len++] = v;
+    else
+        b->overflow = true;
+}
+
+static void put_varint(mx_buf_t *b, uint32_t v) {
+    while (v >= 0x80) {
+        put_byte(b, (uint8_t)v | 0x80);
+        v >>= 7;
+    }
+    put_byte(b, (uint8_t)v);
+}
+
+static void put_str(mx_buf_t *b, const char *s) {
+    size_t n = s ? strlen(s) : 0;
+    put_varint(b, n);
+    for (size_t i = 0; i < n; i++)
+        put_byte(b, (uint8_t)s[i]);
+}
+
+static uint32_t fnv(uint32_t h, const void *data, size_t len) {
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+static uint32_t schema_hash(void) {
+    mx_iter_t it;
+    mx_view_t v;
+    uint32_t h = 2166136261u;
+
+    iter_begin(&it);
+    while (iter_next(&it, &v)) {
+        uint8_t type = v.type;
+        h = fnv(h, &type, 1);
+        h = fnv(h, v.name, strlen(v.name) + 1);
+        h = fnv(h, v.labels ? v.labels : "", (v.labels ? strlen(v.labels) : 0) + 1);
+        if (v.m && v.type == MX_HISTOGRAM)
+            h = fnv(h, v.m->bounds, v.m->n_bounds * sizeof(uint32_t));
+    }
+    return h;
+}
+
+size_t mx_snapshot(uint8_t *out, size_t cap, bool schema) {
+    mx_buf_t b = {out, cap, 0, false};
+    mx_iter_t it;
+    mx_view_t v;
+    uint32_t hash = schema_hash();
+
+    put_byte(&b, 'M');
+    put_byte(&b, schema ? 'S' : 'V');
+    for (int i = 0; i < 4; i++)
+        put_byte(&b, (uint8_t)(hash >> (8 * i)));
+
+    if (schema) {
+        uint32_t count = 0;
+        iter_begin(&it);
+        while (iter_next(&it, &v))
+            count++;
+        put_varint(&b, count);
+    } else {
+        put_varint(&b, (uint32_t)(esp_timer_get_time() / 1000));
+    }
+
+    iter_begin(&it);
+    while (iter_next(&it, &v)) {
+        if (schema) {
+            put_byte(&b, v.type);
+            put_str(&b, v.name);
+            put_str(&b, v.labels);
+            if (v.type == MX_HISTOGRAM) {
+                put_varint(&b, v.m->n_bounds);
+                for (int i = 0; i < v.m->n_bounds; i++)
+                    put_varint(&b, v.m->bounds[i]);
+            }
+            continue;
+        }
+        uint32_t value = sc_read(v.value);
+        if (v.type == MX_GAUGE)
+            put_varint(&b, (value << 1) ^ (uint32_t)((int32_t)value >> 31));
+        else
+            put_varint(&b, value);
+        if (v.type == MX_HISTOGRAM)
+            for (int i = 0; i <= v.m->n_bounds; i++)
+                put_varint(&b, __atomic_load_n(&v.m->bucket[i], __ATOMIC_RELAXED));
+    }
+    return b.overflow ? 0 : b.len;
+}
+
+// ================ FILE ================
+
+static void file_write(const void *data, size_t len, void *ctx) {
+    fwrite(data, 1, len, (FILE *)ctx);
+}
+
+bool mx_dump_file(const char *path, bool binary) {
+    static uint8_t record[MX_SNAPSHOT_MAX];
+    FILE *f = fopen(path, binary ? "wb" : "w");
+    bool ok = f != NULL;
+
+    if (!ok) {
+        ESP_LOGW(TAG, "Cannot open %s", path);
+        return false;
+    }
+    if (binary) {
+        for (int schema = 1; schema >= 0 && ok; schema--) {
+            size_t len = mx_snapshot(record, sizeof(record), schema);
+            uint8_t hdr[2] = {(uint8_t)len, (uint8_t)(len >> 8)};
+            ok = len && fwrite(hdr, 1, 2, f) == 2 && fwrite(record, 1, len, f) == len;
+        }
+    } else {
+        mx_export_text(file_write, f);
+    }
+    ok = fclose(f) == 0 && ok;
+    return ok;
+}
+
+// ================ CONSOLE SERVER ================
+
+static void stdout_write(const void *data, size_t len, void *ctx) {
+    fwrite(data, 1, len, stdout);
+}
+
+static void print_base64_line(const char *prefix, const uint8_t *data, size_t len) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char chunk[64];
+    int n = 0;
+
+    fputs(prefix, stdout);
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = data[i] << 16;
+        if (i + 1 < len)
+            v |= data[i + 1] << 8;
+        if (i + 2 < len)
+            v |= data[i + 2];
+        chunk[n++] = alphabet[(v >> 18) & 63];
+        chunk[n++] = alphabet[(v >> 12) & 63];
+        chunk[n++] = i + 1 < len ? alphabet[(v >> 6) & 63] : '=';
+        chunk[n++] = i + 2 < len ? alphabet[v & 63] : '=';
+        if (n == sizeof(chunk)) {
+            fwrite(chunk, 1, n, stdout);
+            n = 0;
+        }
+    }
+    fwrite(chunk, 1, n, stdout);
+    fputs("\n", stdout);
+}
+
+static void serve_command(const char *cmd) {
+    static uint8_t record[MX_SNAPSHOT_MAX];
+
+    if (strcmp(cmd, "metrics") == 0) {
+        fputs("# BEGIN METRICS\n", stdout);
+        mx_export_text(stdout_write, NULL);
+        fputs("# EOF\n", stdout);
+    } else if (strcmp(cmd, "metrics schema") == 0 || strcmp(cmd, "metrics bin") == 0) {
+        bool schema = cmd[8] == 's';
+        size_t len = mx_snapshot(record, sizeof(record), schema);
+        if (len)
+            print_base64_line(schema ? "MXS " : "MXV ", record, len);
+        else
+            ESP_LOGW(TAG, "Snapshot exceeds %d bytes", MX_SNAPSHOT_MAX);
+    } else {
+        return;
+    }
+    fflush(stdout);
+}
+
+// The console is read without blocking: an idle UART costs one poll per MX_POLL_MS
+void mx_serve_task(void *arg) {
+    char cmd[MX_CMD_MAX];
+    int len = 0;
+
+#ifdef CONFIG_IDF_TARGET_LINUX
+    fcntl(fileno(stdin), F_SETFL, fcntl(fileno(stdin), F_GETFL) | O_NONBLOCK);
+#endif
+    while (1) {
+        int ch = fgetc(stdin);
+        if (ch == EOF) {
+            clearerr(stdin);
+            vTaskDelay(pdMS_TO_TICKS(MX_POLL_MS));
+            continue;
+        }
+        if (ch == '\r' || ch == '\n') {
+            cmd[len] = '\0';
+            if (len)
+                serve_command(cmd);
+            len = 0;
+        } else if (len < MX_CMD_MAX - 1) {
+            cmd[len++] = (char)ch;
+        }
+    }
+}
+
+bool mx_serve_start(UBaseType_t priority) {
+    return xTaskCreate(mx_serve_task, "MetricsSrv", 3072, NULL, priority, NULL) == pdPASS;
+}
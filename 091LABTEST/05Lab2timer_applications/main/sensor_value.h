@@ -0,0 +1,60 @@
+#ifndef SENSOR_VALUE_H
+#define SENSOR_VALUE_H
+
+#include <stdint.h>
+#include "fixed_point.h"
+
+// ================ SENSOR NUMERIC PATH ================
+// Build-time choice of arithmetic for the sensor pipeline:
+//   1 = Q16.16 fixed point (no FPU, usable from ISRs)
+//   0 = float
+#ifndef SENSOR_FIXED_POINT
+#define SENSOR_FIXED_POINT 1
+#endif
+
+#if SENSOR_FIXED_POINT
+
+typedef fx_t sensor_value_t;
+typedef fx_avg_t sensor_avg_t;
+
+#define SV_CONST(x)          FX_CONST(x)
+#define SV_TO_FLOAT(v)       fx_to_float(v)
+#define SV_FROM_RATIO(n, d)  fx_from_ratio((n), (d))
+#define SV_ADD(a, b)         fx_add((a), (b))
+#define SV_SUB(a, b)         fx_sub((a), (b))
+#define SV_MUL(a, b)         fx_mul((a), (b))
+#define SV_ABS(a)            fx_abs(a)
+#define SV_DIV_INT(a, d)     fx_div_int((a), (d))
+#define SV_AVG_RESET(a)      fx_avg_reset(a)
+#define SV_AVG_ADD(a, v)     fx_avg_add((a), (v))
+#define SV_AVG_COUNT(a)      ((a)->count)
+#define SV_AVG_MEAN(a)       fx_avg_mean(a)
+#define SV_PATH_NAME         "Q16.16"
+
+#else
+
+#include <math.h>
+
+typedef float sensor_value_t;
+typedef struct {
+    float sum;
+    uint32_t count;
+} sensor_avg_t;
+
+#define SV_CONST(x)          ((float)(x))
+#define SV_TO_FLOAT(v)       (v)
+#define SV_FROM_RATIO(n, d)  ((float)(n) / (float)(d))
+#define SV_ADD(a, b)         ((a) + (b))
+#define SV_SUB(a, b)         ((a) - (b))
+#define SV_MUL(a, b)         ((a) * (b))
+#define SV_ABS(a)            fabsf(a)
+#define SV_DIV_INT(a, d)     ((a) / (float)(d))
+#define SV_AVG_RESET(a)      ((a)->sum = 0.0f, (a)->count = 0)
+#define SV_AVG_ADD(a, v)     ((a)->sum += (v), (a)->count++)
+#define SV_AVG_COUNT(a)      ((a)->count)
+#define SV_AVG_MEAN(a)       ((a)->count ? (a)->sum / (a)->count : 0.0f)
+#define SV_PATH_NAME         "float"
+
+#endif
+
+#endif
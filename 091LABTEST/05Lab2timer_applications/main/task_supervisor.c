@@ -0,0 +1,246 @@
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "task_supervisor.h"
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_task_wdt.h"
+#endif
+
+static const char *TAG = "SUPERVISOR";
+
+typedef struct {
+    const char *name;
+    sup_reinit_fn reinit;
+    void *arg;
+} sup_subsystem_t;
+
+static sup_slot_t slots[SUP_MAX_SLOTS];
+static int slot_count;
+static sup_subsystem_t subsystems[SUP_MAX_SUBSYSTEMS];
+static int subsystem_count;
+static sup_stats_t stats;
+static uint32_t scan_period_ms;
+static bool reset_allowed;
+static sup_hook_fn hook;
+static void *hook_ctx;
+
+static const char *level_names[SUP_LEVELS] = {
+    "ok", "log", "restart", "subsystem", "reset"
+};
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// ================ CHECK-IN (supervised tasks) ================
+
+void sup_checkin(int slot) {
+    sup_slot_t *s = &slots[slot];
+    uint32_t now = now_ms();
+    uint32_t gap = now - __atomic_load_n(&s->last_ms, __ATOMIC_RELAXED);
+
+    if (gap > s->max_gap_ms)
+        s->max_gap_ms = gap;
+    if (gap > s->deadline_ms)
+        s->late_checkins++;
+    __atomic_store_n(&s->last_ms, now, __ATOMIC_RELAXED);
+    // Release: the supervisor that sees the new count also sees the time
+    __atomic_store_n(&s->checkins, s->checkins + 1, __ATOMIC_RELEASE);
+}
+
+// ================ ESCALATION (supervisor task) ================
+
+static void notify(int i, sup_level_t level) {
+    if (hook)
+        hook(i, slots[i].name, level, hook_ctx);
+}
+
+static bool respawn(int i, uint32_t now) {
+    sup_slot_t *s = &slots[i];
+
+    if (!s->spawn)
+        return false;
+    if (s->task)
+        vTaskDelete(s->task);
+    s->task = s->spawn(i, s->arg);
+    s->restarts++;
+    s->action_ms = now;
+    return s->task != NULL;
+}
+
+static bool restart_subsystem(int i, uint32_t now) {
+    int id = slots[i].subsystem;
+
+    if (id < 0)
+        return false;
+    ESP_LOGW(TAG, "🔁 Restarting subsystem %s", subsystems[id].name);
+    for (int j = 0; j < slot_count; j++) {
+        if (slots[j].subsystem == id && slots[j].spawn && slots[j].task) {
+            vTaskDelete(slots[j].task);
+            slots[j].task = NULL;
+        }
+    }
+    if (subsystems[id].reinit)
+        subsystems[id].reinit(subsystems[id].arg);
+    for (int j = 0; j < slot_count; j++) {
+        if (slots[j].subsystem == id) {
+            if (slots[j].spawn)
+                respawn(j, now);
+            slots[j].action_ms = now;
+        }
+    }
+    return true;
+}
+
+// Acts on the next level up; returns false if that level does not apply
+static bool act(int i, sup_level_t level, uint32_t now) {
+    sup_slot_t *s = &slots[i];
+
+    switch (level) {
+    case SUP_LOG:
+        s->misses++;
+        ESP_LOGW(TAG, "⏰ %s missed its %lu ms deadline", s->name, s->deadline_ms);
+        return true;
+    case SUP_RESTART:
+        if (!s->spawn)
+            return false;
+        ESP_LOGW(TAG, "🔄 Restarting task %s", s->name);
+        respawn(i, now);
+        return true;
+    case SUP_SUBSYSTEM:
+        return restart_subsystem(i, now);
+    case SUP_RESET:
+        ESP_LOGE(TAG, "🚨 %s still silent after restarts", s->name);
+        sup_report();
+        if (reset_allowed)
+            esp_restart();
+        ESP_LOGW(TAG, "In production: esp_restart() would be called here");
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void scan(uint32_t now) {
+    for (int i = 0; i < slot_count; i++) {
+        sup_slot_t *s = &slots[i];
+        uint32_t checkins = __atomic_load_n(&s->checkins, __ATOMIC_ACQUIRE);
+
+        if (checkins != s->seen_checkins) {
+            s->seen_checkins = checkins;
+            if (s->level != SUP_OK) {
+                ESP_LOGI(TAG, "✅ %s is checking in again", s->name);
+                s->level = SUP_OK;
+                notify(i, SUP_OK);
+            }
+            continue;
+        }
+
+        uint32_t last = __atomic_load_n(&s->last_ms, __ATOMIC_RELAXED);
+        uint32_t since = now - last < now - s->action_ms ? last : s->action_ms;
+        if (now - since <= s->deadline_ms || s->level == SUP_RESET)
+            continue;
+
+        // SUP_RESET always acts, so this stops there at the latest
+        sup_level_t level = s->level;
+        while (!act(i, ++level, now))
+            ;
+        s->level = level;
+        s->action_ms = now;
+        stats.escalations[level]++;
+        notify(i, level);
+    }
+}
+
+static void supervisor_task(void *pv) {
+    TickType_t last_wake = xTaskGetTickCount();
+    bool hw_wdt = false;
+
+#if !CONFIG_IDF_TARGET_LINUX
+    hw_wdt = esp_task_wdt_add(NULL) == ESP_OK;
+#endif
+    ESP_LOGI(TAG, "Supervising %d task(s) every %lu ms%s", slot_count, scan_period_ms,
+             hw_wdt ? ", itself watched by the task WDT" : "");
+
+    while (1) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(scan_period_ms));
+        int64_t start = esp_timer_get_time();
+        scan(now_ms());
+        uint32_t took = (uint32_t)(esp_timer_get_time() - start);
+        if (took > stats.scan_max_us)
+            stats.scan_max_us = took;
+        stats.scans++;
+#if !CONFIG_IDF_TARGET_LINUX
+        if (hw_wdt)
+            esp_task_wdt_reset();
+#endif
+    }
+}
+
+// ================ PUBLIC API ================
+
+bool sup_init(uint32_t scan_ms, UBaseType_t priority, bool allow_reset) {
+    scan_period_ms = scan_ms;
+    reset_allowed = allow_reset;
+    return xTaskCreate(supervisor_task, "Supervisor", 3072, NULL, priority, NULL) == pdPASS;
+}
+
+int sup_add_subsystem(const char *name, sup_reinit_fn reinit, void *arg) {
+    if (subsystem_count >= SUP_MAX_SUBSYSTEMS)
+        return -1;
+    subsystems[subsystem_count] = (sup_subsystem_t){name, reinit, arg};
+    return subsystem_count++;
+}
+
+int sup_register(const char *name, TaskHandle_t task, uint32_t deadline_ms,
+                 int subsystem, sup_spawn_fn spawn, void *arg) {
+    if (slot_count >= SUP_MAX_SLOTS)
+        return -1;
+    sup_slot_t *s = &slots[slot_count];
+    memset(s, 0, sizeof(*s));
+    s->name = name;
+    s->task = task;
+    s->deadline_ms = deadline_ms;
+    s->subsystem = subsystem;
+    s->spawn = spawn;
+    s->arg = arg;
+    s->last_ms = s->action_ms = now_ms();
+    // Publish the slot only once it is filled in
+    __atomic_store_n(&slot_count, slot_count + 1, __ATOMIC_RELEASE);
+    return slot_count - 1;
+}
+
+void sup_attach(int slot, TaskHandle_t task) {
+    slots[slot].task = task;
+}
+
+void sup_set_hook(sup_hook_fn fn, void *ctx) {
+    hook_ctx = ctx;
+    hook = fn;
+}
+
+const sup_slot_t *sup_slot(int slot) {
+    return &slots[slot];
+}
+
+void sup_get_stats(sup_stats_t *out) {
+    *out = stats;
+}
+
+const char *sup_level_name(sup_level_t level) {
+    return level < SUP_LEVELS ? level_names[level] : "?";
+}
+
+void sup_report(void) {
+    ESP_LOGI(TAG, "🐕 Supervisor: %lu scans (max %lu us) | escalations log %lu, restart %lu, subsystem %lu, reset %lu",
+             stats.scans, stats.scan_max_us, stats.escalations[SUP_LOG], stats.escalations[SUP_RESTART],
+             stats.escalations[SUP_SUBSYSTEM], stats.escalations[SUP_RESET]);
+    for (int i = 0; i < slot_count; i++) {
+        const sup_slot_t *s = &slots[i];
+        ESP_LOGI(TAG, "  %-12s %-9s | %lu check-ins, %lu late, max gap %lu/%lu ms | %lu misses, %lu restarts",
+                 s->name, level_names[s->level], s->checkins, s->late_checkins,
+                 s->max_gap_ms, s->deadline_ms, s->misses, s->restarts);
+    }
+}
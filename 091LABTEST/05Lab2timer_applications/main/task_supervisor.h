@@ -0,0 +1,95 @@
+#ifndef TASK_SUPERVISOR_H
+#define TASK_SUPERVISOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ============================= TASK SUPERVISOR =============================
+// Software watchdog for individual tasks, with one supervisor task.
+//
+// Each supervised task owns a slot and calls sup_checkin() at least once per
+// deadline. A check-in is a store of the time and a counter bump into the
+// task's own slot: no lock, no queue, no timer. The supervisor wakes every
+// scan period and walks all slots once (O(tasks)), so the cost is one task
+// in total rather than one timer per task.
+//
+// A task that stays silent past its deadline climbs one level per further
+// deadline without a check-in:
+//   SUP_LOG        warn and count the miss
+//   SUP_RESTART    delete the task and spawn it again
+//   SUP_SUBSYSTEM  re-initialise its subsystem and respawn every member
+//   SUP_RESET      esp_restart() (only logged if resets are disabled)
+// A level the slot cannot act on (no spawn function, no subsystem) passes
+// straight to the next one. Any check-in drops the slot back to SUP_OK.
+//
+// On target the supervisor subscribes itself to the hardware task watchdog
+// (esp_task_wdt), so a hung supervisor is caught in turn.
+//
+// Deleting a task that holds a mutex or a borrowed buffer leaks it; spawn
+// functions should only be given for tasks that can be killed at any point
+// where they might hang.
+
+#define SUP_MAX_SLOTS       12
+#define SUP_MAX_SUBSYSTEMS  4
+
+typedef enum {
+    SUP_OK = 0,
+    SUP_LOG,
+    SUP_RESTART,
+    SUP_SUBSYSTEM,
+    SUP_RESET,
+    SUP_LEVELS
+} sup_level_t;
+
+typedef TaskHandle_t (*sup_spawn_fn)(int slot, void *arg);
+typedef void (*sup_reinit_fn)(void *arg);
+typedef void (*sup_hook_fn)(int slot, const char *name, sup_level_t level, void *ctx);
+
+typedef struct {
+    const char *name;
+    TaskHandle_t task;
+    uint32_t deadline_ms;
+    int subsystem;              // -1 for none
+    sup_spawn_fn spawn;         // NULL: cannot be restarted alone
+    void *arg;
+    // written by the task only
+    uint32_t last_ms;
+    uint32_t checkins;
+    uint32_t late_checkins;     // gap between check-ins exceeded the deadline
+    uint32_t max_gap_ms;
+    // written by the supervisor only
+    uint32_t seen_checkins;
+    uint32_t action_ms;         // last escalation, restarts the grace period
+    sup_level_t level;
+    uint32_t misses;            // escalation episodes
+    uint32_t restarts;
+} sup_slot_t;
+
+typedef struct {
+    uint32_t scans;
+    uint32_t scan_max_us;
+    uint32_t escalations[SUP_LEVELS];
+} sup_stats_t;
+
+bool sup_init(uint32_t scan_ms, UBaseType_t priority, bool allow_reset);
+
+int sup_add_subsystem(const char *name, sup_reinit_fn reinit, void *arg);
+
+// Returns the slot the task checks in with, or -1. task may be NULL and set
+// later with sup_attach(), e.g. when the task registers itself.
+int sup_register(const char *name, TaskHandle_t task, uint32_t deadline_ms,
+                 int subsystem, sup_spawn_fn spawn, void *arg);
+void sup_attach(int slot, TaskHandle_t task);
+
+void sup_checkin(int slot);
+
+void sup_set_hook(sup_hook_fn fn, void *ctx);
+
+const sup_slot_t *sup_slot(int slot);
+void sup_get_stats(sup_stats_t *out);
+const char *sup_level_name(sup_level_t level);
+void sup_report(void);
+
+#endif
@@ -0,0 +1,138 @@
+#include <string.h>
+#include "esp_log.h"
+#include "waveform.h"
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "driver/gpio.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#endif
+
+static const char *TAG = "WAVEFORM";
+
+// ================ OUTPUT ================
+
+static void apply(wf_player_t *p, uint32_t mask, int64_t now) {
+    uint32_t changed = mask ^ p->mask_now;
+
+    if (!changed)
+        return;
+#if !CONFIG_IDF_TARGET_LINUX
+    uint32_t set = 0, clr = 0;
+    for (int i = 0; i < p->channels; i++) {
+        int pin = p->pins[i];
+        if (!(changed & (1u << i)) || pin < 0)
+            continue;
+        bool on = mask & (1u << i);
+        if (pin < 32) {
+            if (on)
+                set |= 1u << pin;
+            else
+                clr |= 1u << pin;
+        } else {
+            gpio_set_level(pin, on);
+        }
+    }
+    if (set)
+        REG_WRITE(GPIO_OUT_W1TS_REG, set);
+    if (clr)
+        REG_WRITE(GPIO_OUT_W1TC_REG, clr);
+#endif
+    p->mask_now = mask;
+    if (p->sink)
+        p->sink(mask, now, p->sink_ctx);
+}
+
+// ================ STEP CALLBACK (esp_timer task) ================
+
+static void step_cb(void *arg) {
+    wf_player_t *p = arg;
+    int64_t now = esp_timer_get_time();
+
+    const wf_pattern_t *next = __atomic_exchange_n(&p->pending, NULL, __ATOMIC_ACQ_REL);
+    if (next) {
+        p->cur = next;
+        p->index = 0;
+        p->due_us = now;
+        p->swaps++;
+    }
+    if (!p->running || !p->cur)
+        return;
+
+    uint32_t late = (uint32_t)(now - p->due_us);
+    if (late > p->late_max_us)
+        p->late_max_us = late;
+
+    const wf_step_t *step = &p->cur->steps[p->index];
+    apply(p, step->mask, now);
+    p->due_us += (int64_t)step->ms * 1000;
+    p->steps++;
+
+    if (++p->index == p->cur->count) {
+        p->index = 0;
+        p->wraps++;
+        if (p->on_wrap)
+            p->on_wrap(p->cur, p->steps, p->wrap_ctx);
+    }
+
+    int64_t end = esp_timer_get_time();
+    if ((uint32_t)(end - now) > p->cb_max_us)
+        p->cb_max_us = (uint32_t)(end - now);
+    if (p->running)
+        esp_timer_start_once(p->timer, p->due_us > end ? p->due_us - end : 0);
+}
+
+// ================ PUBLIC API ================
+
+bool wf_init(wf_player_t *p, const int *pins, int channels) {
+    memset(p, 0, sizeof(*p));
+    if (channels > WF_MAX_CHANNELS)
+        return false;
+    memcpy(p->pins, pins, channels * sizeof(int));
+    p->channels = channels;
+
+    esp_timer_create_args_t args = {
+        .callback = step_cb,
+        .arg = p,
+        .name = "waveform",
+    };
+    if (esp_timer_create(&args, &p->timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot create step timer");
+        return false;
+    }
+    return true;
+}
+
+void wf_set_wrap_hook(wf_player_t *p, wf_wrap_fn fn, void *ctx) {
+    p->wrap_ctx = ctx;
+    p->on_wrap = fn;
+}
+
+void wf_set_sink(wf_player_t *p, wf_sink_fn fn, void *ctx) {
+    p->sink_ctx = ctx;
+    p->sink = fn;
+}
+
+void wf_play(wf_player_t *p, const wf_pattern_t *pattern) {
+    __atomic_store_n(&p->pending, pattern, __ATOMIC_RELEASE);
+    if (!p->running) {
+        p->running = true;
+        esp_timer_start_once(p->timer, 0);
+        return;
+    }
+    // Cut the current step short. If the callback is running right now the
+    // stop fails, and the callback re-arms and picks the table up at its
+    // next edge.
+    if (esp_timer_stop(p->timer) == ESP_OK)
+        esp_timer_start_once(p->timer, 0);
+}
+
+void wf_stop(wf_player_t *p) {
+    p->running = false;
+    esp_timer_stop(p->timer);
+    apply(p, 0, esp_timer_get_time());
+}
+
+const wf_pattern_t *wf_current(const wf_player_t *p) {
+    return p->cur;
+}
@@ -0,0 +1,72 @@
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_timer.h"
+
+// ============================= WAVEFORM PLAYER =============================
+// Plays precompiled output patterns: a pattern is a const table of
+// (level mask, duration) steps, with bit i of the mask driving channel i.
+// Playback is one esp_timer one-shot re-armed from its own callback
+// against an absolute schedule, so steps do not drift. Each step costs a
+// table read and, for pins below 32, a single W1TS/W1TC register write
+// pair, so every channel changes at the same instant.
+//
+// wf_play() swaps the table pointer atomically. The callback picks the new
+// table up at once; if called from the wrap hook, it takes over after the
+// current step. A sink callback sees every applied mask; on the Linux host
+// (CONFIG_IDF_TARGET_LINUX) it is the only output.
+
+#define WF_MAX_CHANNELS 8
+
+typedef struct {
+    uint8_t mask;
+    uint16_t ms;
+} wf_step_t;
+
+typedef struct {
+    const char *name;
+    const wf_step_t *steps;
+    uint16_t count;
+} wf_pattern_t;
+
+#define WF_PATTERN(name_, table_) { (name_), (table_), sizeof(table_) / sizeof((table_)[0]) }
+
+typedef void (*wf_wrap_fn)(const wf_pattern_t *pattern, uint32_t steps, void *ctx);
+typedef void (*wf_sink_fn)(uint32_t mask, int64_t t_us, void *ctx);
+
+typedef struct {
+    int pins[WF_MAX_CHANNELS];
+    int channels;
+    esp_timer_handle_t timer;
+    volatile bool running;
+    const wf_pattern_t *pending;
+    // esp_timer task only
+    const wf_pattern_t *cur;
+    uint16_t index;
+    uint32_t mask_now;
+    int64_t due_us;
+    wf_wrap_fn on_wrap;
+    void *wrap_ctx;
+    wf_sink_fn sink;
+    void *sink_ctx;
+    // stats
+    uint32_t steps;
+    uint32_t wraps;
+    uint32_t swaps;
+    uint32_t late_max_us;     // step edge applied after its due time
+    uint32_t cb_max_us;       // time spent in the step callback
+} wf_player_t;
+
+// pins must already be outputs; use -1 for a channel with no pin
+bool wf_init(wf_player_t *p, const int *pins, int channels);
+void wf_set_wrap_hook(wf_player_t *p, wf_wrap_fn fn, void *ctx);
+void wf_set_sink(wf_player_t *p, wf_sink_fn fn, void *ctx);
+
+void wf_play(wf_player_t *p, const wf_pattern_t *pattern);
+void wf_stop(wf_player_t *p);
+
+const wf_pattern_t *wf_current(const wf_player_t *p);
+
+#endif
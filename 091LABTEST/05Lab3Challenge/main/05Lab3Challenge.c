@@ -11,6 +11,9 @@
 #include "esp_sntp.h"
 #include "driver/gpio.h"
 #include "nvs_flash.h"
+#include "adaptive_rate.h"
+#include "metrics.h"
+#include "cpu_account.h"
 
 static const char *TAG = "EXPERT_CHALLENGES";
 
@@ -21,6 +24,9 @@ static const char *TAG = "EXPERT_CHALLENGES";
 #define MEMORY_THRESHOLD        30000
 #define NETWORK_SYNC_INTERVAL   10000
 #define LOAD_BALANCE_INTERVAL   2000
+#define SCHED_CPU_BUDGET_US     10000   // per second for all scheduled tasks (1% of a core)
+#define SCHED_RATE_RANGE        0.2f    // rate may move +/-20% around the nominal period
+#define CPU_SAMPLE_MS           500     // CPU accounting period; the window is CA_WINDOW of them
 
 #define LED_SCHEDULER   GPIO_NUM_2
 #define LED_SYNC        GPIO_NUM_4
@@ -38,22 +44,34 @@ typedef struct {
     TickType_t period;
     uint32_t last_exec_time;
     bool active;
+    float input;            // simulated process value the task samples
+    uint8_t burst;          // runs left in a fast-changing stretch
+    ar_stream_t rate;
+    char labels[32];        // task="<name>"
+    mx_metric_t exec_us;    // histogram, its count is the number of runs
+    mx_metric_t missed;
 } scheduled_task_t;
 
+// Served on the console by the metrics task (metrics.h)
 typedef struct {
-    float avg_exec_us;
-    uint32_t task_count;
-    float cpu_load;
-    float accuracy;
-    uint32_t missed_deadlines;
+    mx_metric_t cpu_load;       // gauge, permille busy over all cores
+    mx_metric_t core_load[portNUM_PROCESSORS];
+    mx_metric_t daemon_load;    // gauge, permille of one core
+    mx_metric_t free_heap;      // gauge
+    mx_metric_t task_count;     // gauge
+    mx_metric_t rate_changes;
 } system_metrics_t;
 
+static const uint32_t exec_bounds_us[] = {500, 1000, 2000, 3000, 4000, 5000, 10000};
+
 // =============================
 // GLOBAL VARIABLES
 // =============================
 static scheduled_task_t scheduler_pool[MAX_SCHEDULED_TASKS];
 static SemaphoreHandle_t scheduler_mutex;
-static system_metrics_t metrics = {0};
+static system_metrics_t metrics;
+static char core_labels[portNUM_PROCESSORS][12];
+static ar_controller_t rate_ctl;
 
 // =============================
 // PROTOTYPES
@@ -74,6 +92,17 @@ void init_scheduler(void) {
     for (int i = 0; i < MAX_SCHEDULED_TASKS; i++) {
         scheduler_pool[i].active = false;
     }
+    ar_init(&rate_ctl, SCHED_CPU_BUDGET_US);
+    mx_gauge(&metrics.cpu_load, "cpu_busy_permille", "Busy share of all cores over the sampling window", NULL);
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        snprintf(core_labels[c], sizeof(core_labels[c]), "core=\"%d\"", c);
+        mx_gauge(&metrics.core_load[c], "core_busy_permille", "Busy share of one core over the sampling window",
+                 core_labels[c]);
+    }
+    mx_gauge(&metrics.daemon_load, "timer_daemon_cpu_permille", "Timer daemon share of one core over the sampling window", NULL);
+    mx_gauge(&metrics.free_heap, "free_heap_bytes", "Free heap at the last health check", NULL);
+    mx_gauge(&metrics.task_count, "scheduled_tasks", "Active scheduler slots", NULL);
+    mx_counter(&metrics.rate_changes, "schedule_rate_changes_total", "Timer periods changed by the controller", NULL);
     ESP_LOGI(TAG, "Scheduler initialized with %d slots", MAX_SCHEDULED_TASKS);
 }
 
@@ -88,10 +117,37 @@ BaseType_t schedule_task(const char *name, uint32_t period_ms, uint8_t priority,
             scheduler_pool[i].priority = priority;
             scheduler_pool[i].deadline_ms = deadline_ms;
             scheduler_pool[i].timer = xTimerCreate(name, scheduler_pool[i].period, pdTRUE, (void*)i, scheduler_task_callback);
+            if (scheduler_pool[i].timer == NULL) {
+                // Slot stays free; nothing is registered with a NULL timer
+                xSemaphoreGive(scheduler_mutex);
+                ESP_LOGE(TAG, "Failed to create timer for task: %s", name);
+                return pdFAIL;
+            }
             scheduler_pool[i].active = true;
 
-            if (scheduler_pool[i].timer)
-                safe_timer_start(scheduler_pool[i].timer);
+            // Rate follows the sampled input within the range; cost starts at
+            // the simulated work and is replaced by the measured time
+            ar_config_t cfg = {
+                .min_hz = 1000.0f / (period_ms * (1.0f + SCHED_RATE_RANGE)),
+                .max_hz = 1000.0f / (period_ms * (1.0f - SCHED_RATE_RANGE)),
+                .slope_ref = 2.0f,
+                .noise_ref = 2.0f,
+                .cost_us = (100 + priority * 50) * 10,
+                .hysteresis = 0.1f,
+                .dwell = 2,
+            };
+            ar_stream_init(&scheduler_pool[i].rate, scheduler_pool[i].name, &cfg,
+                           1000.0f / period_ms, scheduler_pool[i].timer);
+            ar_add(&rate_ctl, &scheduler_pool[i].rate);
+
+            scheduled_task_t *t = &scheduler_pool[i];
+            snprintf(t->labels, sizeof(t->labels), "task=\"%s\"", t->name);
+            mx_histogram(&t->exec_us, "sched_exec_us", "Scheduled task execution time", t->labels,
+                         exec_bounds_us, sizeof(exec_bounds_us) / sizeof(exec_bounds_us[0]));
+            mx_counter(&t->missed, "sched_missed_deadlines_total", "Runs that finished past their deadline", t->labels);
+            mx_add(&metrics.task_count, 1);
+
+            safe_timer_start(scheduler_pool[i].timer);
 
             xSemaphoreGive(scheduler_mutex);
             ESP_LOGI(TAG, "Scheduled task: %s | Priority=%d | Deadline=%dms", name, priority, deadline_ms);
@@ -113,12 +169,25 @@ void scheduler_task_callback(TimerHandle_t timer) {
     ets_delay_us(work_time * 10); // simulate load
 
     uint32_t duration = esp_timer_get_time() - start;
-    metrics.avg_exec_us = (metrics.avg_exec_us + duration) / 2.0;
+    mx_observe(&scheduler_pool[idx].exec_us, duration);
     scheduler_pool[idx].last_exec_time = start / 1000;
 
+    // Sample the simulated input: a slow random walk with occasional bursts
+    // of fast change. The controller task reads the estimate; a torn read of
+    // one float is harmless.
+    scheduled_task_t *t = &scheduler_pool[idx];
+    if (t->burst) {
+        t->burst--;
+    } else if (esp_random() % 50 == 0) {
+        t->burst = 20;
+    }
+    t->input += ((int)(esp_random() % 201) - 100) / 100.0f * (t->burst ? 3.0f : 0.1f);
+    t->rate.cfg.cost_us += 0.1f * (duration - t->rate.cfg.cost_us);
+    ar_observe(&t->rate, t->input, (uint32_t)(esp_timer_get_time() / 1000));
+
     // Check deadline
     if (duration / 1000 > scheduler_pool[idx].deadline_ms) {
-        metrics.missed_deadlines++;
+        mx_inc(&scheduler_pool[idx].missed);
         ESP_LOGW(TAG, "⏰ Missed deadline: %s (%luμs > %dms)", scheduler_pool[idx].name, duration, scheduler_pool[idx].deadline_ms);
     }
 
@@ -149,27 +218,38 @@ void network_sync_task(void *param) {
 // =============================
 // ADAPTIVE PERFORMANCE CONTROLLER
 // =============================
+// Applies every rate change of one commit in a single pass; the caller
+// holds scheduler_mutex. Timers whose rate did not change are not touched,
+// so they keep their phase.
+static void apply_schedule(ar_stream_t *const *changed, int n, void *ctx) {
+    for (int i = 0; i < n; i++) {
+        TickType_t period = pdMS_TO_TICKS(1000.0f / changed[i]->applied_hz);
+        xTimerChangePeriod((TimerHandle_t)changed[i]->user, period ? period : 1, 0);
+    }
+}
+
 void adaptive_controller_task(void *param) {
     ESP_LOGI(TAG, "🧠 Adaptive performance controller running");
-    float load_factor = 1.0;
+    uint32_t cycles = 0;
 
     while (1) {
         check_memory_health();
         comprehensive_health_check();
 
-        // Adjust periods dynamically based on load
-        if (metrics.cpu_load > 80.0) load_factor = 1.2;
-        else if (metrics.cpu_load < 40.0) load_factor = 0.8;
-        else load_factor = 1.0;
+        // Full budget up to 40% load, shrinking to a third of it at 80%
+        ar_set_budget_scale(&rate_ctl, (1000.0f - mx_read(&metrics.cpu_load)) / 600.0f);
 
         if (xSemaphoreTake(scheduler_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            for (int i = 0; i < MAX_SCHEDULED_TASKS; i++) {
-                if (scheduler_pool[i].active) {
-                    TickType_t new_period = scheduler_pool[i].period * load_factor;
-                    xTimerChangePeriod(scheduler_pool[i].timer, new_period, 0);
-                }
-            }
+            int changed = ar_commit(&rate_ctl, apply_schedule, NULL);
             xSemaphoreGive(scheduler_mutex);
+            if (changed) {
+                mx_add(&metrics.rate_changes, changed);
+                ESP_LOGI(TAG, "⚖️ Rates updated: %d task(s) in one batch", changed);
+            }
+        }
+        if (++cycles % 10 == 0) {
+            ar_report(&rate_ctl);
+            ca_report();
         }
 
         gpio_set_level(LED_LOAD, 1);
@@ -185,6 +265,7 @@ void adaptive_controller_task(void *param) {
 // =============================
 void check_memory_health(void) {
     size_t free_heap = esp_get_free_heap_size();
+    mx_set(&metrics.free_heap, free_heap);
     if (free_heap < MEMORY_THRESHOLD) {
         ESP_LOGW(TAG, "⚠️ Low memory: %d bytes", free_heap);
         gpio_set_level(LED_ERROR, 1);
@@ -204,18 +285,23 @@ BaseType_t safe_timer_start(TimerHandle_t timer) {
     return result;
 }
 
+// Loads come from the CPU accounting task, which samples every
+// CPU_SAMPLE_MS; the window covers the last CA_WINDOW samples
 void comprehensive_health_check(void) {
-    TaskStatus_t status;
-    vTaskGetInfo(xTimerGetTimerDaemonTaskHandle(), &status, pdTRUE, eInvalid);
-    uint32_t total_run_time = esp_timer_get_time() / 1000;
-    uint32_t load = (status.ulRunTimeCounter * 100) / (total_run_time + 1);
-    metrics.cpu_load = load;
-
-    if (status.usStackHighWaterMark < 100) {
-        ESP_LOGW(TAG, "Low stack: %d words left", status.usStackHighWaterMark);
+    TaskHandle_t daemon = xTimerGetTimerDaemonTaskHandle();
+    uint32_t load = ca_system_load(true);
+    mx_set(&metrics.cpu_load, load);
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        mx_set(&metrics.core_load[c], ca_core_load(c, true));
+    }
+    mx_set(&metrics.daemon_load, ca_task_load(daemon, true));
+
+    UBaseType_t stack_left = uxTaskGetStackHighWaterMark(daemon);
+    if (stack_left < 100) {
+        ESP_LOGW(TAG, "Low stack: %d words left", stack_left);
     }
-    if (load > 80) {
-        ESP_LOGW(TAG, "⚠️ High CPU Load: %lu%%", load);
+    if (load > 800) {
+        ESP_LOGW(TAG, "⚠️ High CPU Load: %lu.%lu%%", load / 10, load % 10);
     }
 }
 
@@ -230,6 +316,7 @@ void app_main(void) {
     gpio_set_direction(LED_LOAD, GPIO_MODE_OUTPUT);
     gpio_set_direction(LED_ERROR, GPIO_MODE_OUTPUT);
 
+    ca_start(CPU_SAMPLE_MS, 7);
     init_scheduler();
 
     // Schedule sample tasks
@@ -240,6 +327,7 @@ void app_main(void) {
     // Create expert-level controllers
     xTaskCreate(network_sync_task, "NetSync", 4096, NULL, 5, NULL);
     xTaskCreate(adaptive_controller_task, "AdaptiveCtrl", 4096, NULL, 6, NULL);
+    mx_serve_start(1);
 
     ESP_LOGI(TAG, "✅ Expert Timer System Initialized");
     ESP_LOGI(TAG, "LED2: Scheduler | LED4: Network Sync | LED5: Load | LED18: Error");
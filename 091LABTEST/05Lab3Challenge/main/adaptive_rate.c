@@ -0,0 +1,148 @@
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "adaptive_rate.h"
+
+static const char *TAG = "ADAPTIVE";
+
+#define AR_ALPHA 0.2f   // EWMA weight of a new sample
+
+// ================ ESTIMATOR ================
+
+void ar_observe(ar_stream_t *s, float value, uint32_t t_ms) {
+    if (!s->primed) {
+        s->primed = true;
+        s->mean = s->anchor_mean = value;
+        s->var = s->slope = 0;
+        s->anchor_ms = s->last_ms = t_ms;
+        s->samples += 1;
+        s->samples_fixed += 1;
+        return;
+    }
+
+    // Accounting: what this stream took vs a fixed max_hz stream
+    float dt_s = (t_ms - s->last_ms) / 1000.0f;
+    s->last_ms = t_ms;
+    s->samples += 1;
+    s->samples_fixed += dt_s * s->cfg.max_hz;
+
+    float d = value - s->mean;
+    s->mean += AR_ALPHA * d;
+    s->var = (1.0f - AR_ALPHA) * (s->var + AR_ALPHA * d * d);
+
+    uint32_t span = t_ms - s->anchor_ms;
+    if (span >= AR_SLOPE_WINDOW_MS) {
+        float slope = fabsf(s->mean - s->anchor_mean) * 1000.0f / span;
+        s->slope += 0.5f * (slope - s->slope);
+        s->anchor_mean = s->mean;
+        s->anchor_ms = t_ms;
+    }
+
+    float activity = 0;
+    if (s->cfg.slope_ref > 0)
+        activity += s->slope / s->cfg.slope_ref;
+    if (s->cfg.noise_ref > 0)
+        activity += sqrtf(s->var) / s->cfg.noise_ref;
+    if (activity > 1.0f)
+        activity = 1.0f;
+    s->desired_hz = s->cfg.min_hz + (s->cfg.max_hz - s->cfg.min_hz) * activity;
+}
+
+// ================ CONTROLLER ================
+
+void ar_init(ar_controller_t *c, float budget_us_per_s) {
+    memset(c, 0, sizeof(*c));
+    c->budget_us = budget_us_per_s;
+    c->budget_scale = 1.0f;
+}
+
+void ar_stream_init(ar_stream_t *s, const char *name, const ar_config_t *cfg, float start_hz, void *user) {
+    memset(s, 0, sizeof(*s));
+    s->name = name;
+    s->cfg = *cfg;
+    s->user = user;
+    s->desired_hz = s->applied_hz = start_hz;
+}
+
+bool ar_add(ar_controller_t *c, ar_stream_t *s) {
+    if (c->count >= AR_MAX_STREAMS)
+        return false;
+    c->streams[c->count++] = s;
+    return true;
+}
+
+void ar_set_budget_scale(ar_controller_t *c, float scale) {
+    c->budget_scale = scale < 0 ? 0 : (scale > 1.0f ? 1.0f : scale);
+}
+
+int ar_commit(ar_controller_t *c, ar_apply_fn apply, void *ctx) {
+    ar_stream_t *changed[AR_MAX_STREAMS];
+    float target[AR_MAX_STREAMS];
+    float floor_cost = 0, extra_cost = 0;
+    int n = 0;
+
+    c->commits++;
+
+    // 1. Budget: min rates are always paid; the rest shares what is left
+    for (int i = 0; i < c->count; i++) {
+        ar_stream_t *s = c->streams[i];
+        floor_cost += s->cfg.min_hz * s->cfg.cost_us;
+        extra_cost += (s->desired_hz - s->cfg.min_hz) * s->cfg.cost_us;
+    }
+    float room = c->budget_us * c->budget_scale - floor_cost;
+    float share = 1.0f;
+    if (extra_cost > 0 && room < extra_cost) {
+        share = room > 0 ? room / extra_cost : 0;
+        c->budget_limited++;
+    }
+
+    // 2. Hysteresis: rise at once, fall only after `dwell` commits
+    for (int i = 0; i < c->count; i++) {
+        ar_stream_t *s = c->streams[i];
+        float t = s->cfg.min_hz + (s->desired_hz - s->cfg.min_hz) * share;
+        float band = s->applied_hz * s->cfg.hysteresis;
+
+        target[i] = t;
+        if (t > s->applied_hz + band) {
+            s->outside = s->cfg.dwell;
+        } else if (t < s->applied_hz - band) {
+            s->outside++;
+        } else {
+            s->outside = 0;
+            continue;
+        }
+        if (s->outside >= s->cfg.dwell) {
+            s->outside = 0;
+            s->applied_hz = target[i];
+            s->changes++;
+            changed[n++] = s;
+        }
+    }
+
+    // 3. One update for everything that moved
+    if (n) {
+        c->batches++;
+        if (apply)
+            apply(changed, n, ctx);
+    }
+    return n;
+}
+
+// ================ REPORTING ================
+
+float ar_samples_saved_pct(const ar_stream_t *s) {
+    if (s->samples_fixed <= 0)
+        return 0;
+    return 100.0f * (float)(1.0 - s->samples / s->samples_fixed);
+}
+
+void ar_report(const ar_controller_t *c) {
+    ESP_LOGI(TAG, "📉 Adaptive rate: %lu commits, %lu batched updates, %lu budget-limited (scale %.2f)",
+             c->commits, c->batches, c->budget_limited, c->budget_scale);
+    for (int i = 0; i < c->count; i++) {
+        const ar_stream_t *s = c->streams[i];
+        ESP_LOGI(TAG, "  %-10s %.2f Hz (want %.2f) | %lu changes | %.0f samples, %.1f%% saved vs %.2f Hz fixed",
+                 s->name, s->applied_hz, s->desired_hz, s->changes,
+                 s->samples, ar_samples_saved_pct(s), s->cfg.max_hz);
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef ADAPTIVE_RATE_H
+#define ADAPTIVE_RATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============================= ADAPTIVE RATE =============================
+// Picks a sampling rate per stream from what the signal is doing, within a
+// shared CPU/energy budget.
+//
+//   activity = |slope| / slope_ref + stddev / noise_ref      (clamped to 1)
+//   desired  = min_hz + (max_hz - min_hz) * activity
+//
+// The slope comes from the smoothed mean over at least AR_SLOPE_WINDOW_MS,
+// so sensor noise at high rates does not feed back into a higher rate.
+// ar_commit() then:
+//   1. scales the part above min_hz down, if all streams together would
+//      exceed the budget (sum of rate * cost_us per second)
+//   2. applies hysteresis: a rise beyond the band applies at once; a fall
+//      must stay outside the band for `dwell` commits
+//   3. hands every stream that changed to the apply callback in one call,
+//      so the caller can update its timers or decimation together
+//
+// The controller never reads a clock: callers pass timestamps, so the same
+// code runs live and in trace replay.
+
+#define AR_MAX_STREAMS       10
+#define AR_SLOPE_WINDOW_MS   1000
+
+typedef struct {
+    float min_hz;
+    float max_hz;
+    float slope_ref;        // |units per second| that calls for max_hz
+    float noise_ref;        // standard deviation that calls for max_hz
+    float cost_us;          // CPU (or energy) cost of one sample
+    float hysteresis;       // relative band, e.g. 0.25
+    uint8_t dwell;          // commits outside the band before slowing down
+} ar_config_t;
+
+typedef struct {
+    const char *name;
+    ar_config_t cfg;
+    void *user;             // caller's handle (timer, acquisition, ...)
+    // estimator
+    bool primed;
+    float mean;
+    float var;
+    float slope;
+    float anchor_mean;
+    uint32_t anchor_ms;
+    uint32_t last_ms;
+    // rate
+    float desired_hz;
+    float applied_hz;
+    uint8_t outside;
+    // accounting
+    double samples;         // taken at the applied rate
+    double samples_fixed;   // a fixed max_hz stream would have taken
+    uint32_t changes;
+} ar_stream_t;
+
+typedef struct {
+    ar_stream_t *streams[AR_MAX_STREAMS];
+    int count;
+    float budget_us;        // per second, all streams together
+    float budget_scale;     // 0..1, lets the caller tighten it under load
+    uint32_t commits;
+    uint32_t batches;       // commits that changed at least one stream
+    uint32_t budget_limited;
+} ar_controller_t;
+
+typedef void (*ar_apply_fn)(ar_stream_t *const *changed, int n, void *ctx);
+
+void ar_init(ar_controller_t *c, float budget_us_per_s);
+void ar_stream_init(ar_stream_t *s, const char *name, const ar_config_t *cfg, float start_hz, void *user);
+bool ar_add(ar_controller_t *c, ar_stream_t *s);
+
+// Feed every sample the stream takes
+void ar_observe(ar_stream_t *s, float value, uint32_t t_ms);
+
+void ar_set_budget_scale(ar_controller_t *c, float scale);
+
+// Plan all streams; calls apply once if any rate changed. Returns the count.
+int ar_commit(ar_controller_t *c, ar_apply_fn apply, void *ctx);
+
+float ar_samples_saved_pct(const ar_stream_t *s);
+void ar_report(const ar_controller_t *c);
+
+#endif
@@ -0,0 +1,202 @@
+#include <string.h>
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "cpu_account.h"
+
+static const char *TAG = "CA";
+
+#define CA_RING (CA_WINDOW + 1)
+
+typedef struct {
+    ca_task_info_t info;        // info.handle NULL marks a free slot
+    UBaseType_t task_number;    // xTaskNumber, unique per created task
+    uint32_t run[CA_RING];      // run-time counter at each sample
+    bool seen;
+} ca_slot_t;
+
+// All state is static: sampling never allocates
+static TaskStatus_t status[CA_MAX_TASKS];
+static ca_slot_t slots[CA_MAX_TASKS];
+static uint32_t clock_ring[CA_RING];
+static uint16_t core_last[portNUM_PROCESSORS];
+static uint16_t core_window[portNUM_PROCESSORS];
+static TaskHandle_t idle_task[portNUM_PROCESSORS];
+static ca_stats_t stats;
+static StaticSemaphore_t lock_buf;
+static SemaphoreHandle_t lock;
+
+static uint16_t permille(uint32_t part, uint32_t whole) {
+    if (whole == 0)
+        return 0;
+    uint32_t p = (uint64_t)part * 1000 / whole;
+    return p > 1000 ? 1000 : p;
+}
+
+static ca_slot_t *find_slot(TaskHandle_t handle) {
+    for (int i = 0; i < CA_MAX_TASKS; i++)
+        if (slots[i].info.handle == handle)
+            return &slots[i];
+    return NULL;
+}
+
+bool ca_init(void) {
+    if (lock)
+        return true;
+    lock = xSemaphoreCreateMutexStatic(&lock_buf);
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+        idle_task[c] = xTaskGetIdleTaskHandleForCore(c);
+    ca_sample();
+    return lock != NULL;
+}
+
+void ca_sample(void) {
+    uint32_t now;
+    UBaseType_t n = uxTaskGetSystemState(status, CA_MAX_TASKS, &now);
+    if (n == 0) {
+        stats.failed++;
+        return;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    uint32_t s = stats.samples;
+    uint32_t span = s < CA_WINDOW ? s : CA_WINDOW;
+    int cur = s % CA_RING;
+    int prev = (s + CA_RING - 1) % CA_RING;
+    int base = (s + CA_RING - span) % CA_RING;
+    clock_ring[cur] = now;
+
+    for (int i = 0; i < CA_MAX_TASKS; i++)
+        slots[i].seen = false;
+
+    for (UBaseType_t t = 0; t < n; t++) {
+        const TaskStatus_t *ts = &status[t];
+        ca_slot_t *slot = find_slot(ts->xHandle);
+        // Same handle, different task number: a new task in a recycled TCB.
+        // Counters that wrap are left to modular subtraction.
+        if (slot && slot->task_number != ts->xTaskNumber) {
+            slot->info.handle = NULL;
+            slot = NULL;
+        }
+        if (!slot) {
+            slot = find_slot(NULL);
+            if (!slot)
+                continue;
+            // Tasks present at the first sample have an unknown past; tasks
+            // created since had a zero counter over the whole window
+            uint32_t fill = s == 0 ? ts->ulRunTimeCounter : 0;
+            for (int r = 0; r < CA_RING; r++)
+                slot->run[r] = fill;
+            slot->info.handle = ts->xHandle;
+            slot->task_number = ts->xTaskNumber;
+            strncpy(slot->info.name, ts->pcTaskName, sizeof(slot->info.name) - 1);
+            slot->info.name[sizeof(slot->info.name) - 1] = '\0';
+        }
+        slot->seen = true;
+        slot->run[cur] = ts->ulRunTimeCounter;
+        // Not ts->xCoreID: it only exists with CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+        BaseType_t core = xTaskGetCoreID(ts->xHandle);
+        slot->info.core = core >= 0 && core < portNUM_PROCESSORS ? core : CA_ANY_CORE;
+        slot->info.priority = ts->uxCurrentPriority;
+    }
+
+    // The first sample has no previous one: both spans are empty, so every
+    // load reads 0 instead of a share of the whole uptime
+    uint32_t dt_last = s ? now - clock_ring[prev] : 0;
+    uint32_t dt_window = now - clock_ring[base];
+    for (int i = 0; i < CA_MAX_TASKS; i++) {
+        ca_slot_t *slot = &slots[i];
+        if (!slot->seen) {
+            slot->info.handle = NULL;
+            continue;
+        }
+        slot->info.last = permille(slot->run[cur] - slot->run[prev], dt_last);
+        slot->info.window = permille(slot->run[cur] - slot->run[base], dt_window);
+    }
+
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        ca_slot_t *idle = find_slot(idle_task[c]);
+        core_last[c] = idle && dt_last ? 1000 - idle->info.last : 0;
+        core_window[c] = idle && dt_window ? 1000 - idle->info.window : 0;
+    }
+
+    stats.samples++;
+    stats.interval_us = dt_last;
+    stats.window_us = dt_window;
+    xSemaphoreGive(lock);
+}
+
+static void ca_task(void *arg) {
+    TickType_t period = (TickType_t)(uintptr_t)arg;
+    TickType_t wake = xTaskGetTickCount();
+    while (1) {
+        vTaskDelayUntil(&wake, period);
+        ca_sample();
+    }
+}
+
+bool ca_start(uint32_t period_ms, UBaseType_t priority) {
+    if (!ca_init())
+        return false;
+    TickType_t period = pdMS_TO_TICKS(period_ms);
+    return xTaskCreate(ca_task, "CpuAccount", 2048, (void *)(uintptr_t)(period ? period : 1),
+                       priority, NULL) == pdPASS;
+}
+
+uint16_t ca_core_load(int core, bool window) {
+    if (core < 0 || core >= portNUM_PROCESSORS)
+        return 0;
+    return window ? core_window[core] : core_last[core];
+}
+
+uint16_t ca_system_load(bool window) {
+    uint32_t sum = 0;
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+        sum += ca_core_load(c, window);
+    return sum / portNUM_PROCESSORS;
+}
+
+uint16_t ca_task_load(TaskHandle_t task, bool window) {
+    uint16_t load = 0;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    ca_slot_t *slot = task ? find_slot(task) : NULL;
+    if (slot)
+        load = window ? slot->info.window : slot->info.last;
+    xSemaphoreGive(lock);
+    return load;
+}
+
+int ca_tasks(ca_task_info_t *out, int max) {
+    int n = 0;
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (int i = 0; i < CA_MAX_TASKS && n < max; i++)
+        if (slots[i].info.handle)
+            out[n++] = slots[i].info;
+    xSemaphoreGive(lock);
+    return n;
+}
+
+void ca_get_stats(ca_stats_t *out) {
+    xSemaphoreTake(lock, portMAX_DELAY);
+    *out = stats;
+    xSemaphoreGive(lock);
+}
+
+void ca_report(void) {
+    ca_stats_t st;
+    ca_get_stats(&st);
+    ESP_LOGI(TAG, "📈 CPU over %lu ms (last %lu ms), %lu samples, %lu failed",
+             st.window_us / 1000, st.interval_us / 1000, st.samples, st.failed);
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+        ESP_LOGI(TAG, "  core %d  %3u.%u%%  (last %3u.%u%%)", c,
+                 core_window[c] / 10, core_window[c] % 10, core_last[c] / 10, core_last[c] % 10);
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (int i = 0; i < CA_MAX_TASKS; i++) {
+        const ca_task_info_t *t = &slots[i].info;
+        if (!t->handle)
+            continue;
+        ESP_LOGI(TAG, "  %-16s core %2d prio %2u  %3u.%u%%  (last %3u.%u%%)", t->name, t->core,
+                 t->priority, t->window / 10, t->window % 10, t->last / 10, t->last % 10);
+    }
+    xSemaphoreGive(lock);
+}
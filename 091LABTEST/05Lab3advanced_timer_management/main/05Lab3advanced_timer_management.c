@@ -12,14 +12,16 @@
 #include "esp_system.h"
 #include "esp_random.h"
 #include "driver/gpio.h"
+#include "static_objects.h"
+#include "shard_counter.h"
+#include "metrics.h"
 
 static const char *TAG = "ADV_TIMERS";
 
 // ================ CONFIGURATION ================
-#define TIMER_POOL_SIZE              20
+// TIMER_POOL_SIZE and HEALTH_CHECK_INTERVAL live in static_objects_config.h
 #define DYNAMIC_TIMER_MAX            10
 #define PERFORMANCE_BUFFER_SIZE      100
-#define HEALTH_CHECK_INTERVAL        1000
 
 // LEDs for visual feedback
 #define PERFORMANCE_LED     GPIO_NUM_2
@@ -54,52 +56,50 @@ typedef struct {
     bool accuracy_ok;
 } performance_sample_t;
 
-// System Health Data
+// System Health Data: counters are bumped from app tasks and the timer
+// daemon, gauges are set by the health monitor only (shard_counter.h)
 typedef struct {
-    uint32_t total_timers_created;
-    uint32_t active_timers;
-    uint32_t pool_utilization;
-    uint32_t dynamic_timers;
-    uint32_t failed_creations;
-    uint32_t callback_overruns;
-    uint32_t command_failures;
+    sc_counter_t total_timers_created;
+    sc_counter_t active_timers;         // gauge
+    sc_counter_t pool_utilization;      // gauge
+    sc_counter_t dynamic_timers;        // gauge
+    sc_counter_t failed_creations;
+    sc_counter_t callback_overruns;
+    sc_counter_t command_failures;
     float average_accuracy;
     uint32_t service_task_load_percent;
-    uint32_t free_heap_bytes;
+    sc_counter_t free_heap_bytes;       // gauge
 } timer_health_t;
 
 // ================ GLOBAL VARIABLES ================
+// Kernel objects (mutexes, queue, timers, tasks) are declared in
+// static_objects_config.h and created by static_objects_init().
 
 // Timer Pool Management
 timer_pool_entry_t timer_pool[TIMER_POOL_SIZE];
-SemaphoreHandle_t pool_mutex;
 uint32_t next_timer_id = 1000;
 
 // Performance Monitoring
 performance_sample_t perf_buffer[PERFORMANCE_BUFFER_SIZE];
 uint32_t perf_buffer_index = 0;
-SemaphoreHandle_t perf_mutex;
 
-// Health Monitoring
-timer_health_t health_data = {0};
-TimerHandle_t health_monitor_timer;
-TimerHandle_t performance_timer;
+// Health Monitoring (exported with the rest of the registry, see metrics.h)
+timer_health_t health_data;
+mx_metric_t callback_duration;
+static const uint32_t callback_bounds_us[] = {50, 100, 250, 500, 1000, 2500, 5000};
 
-// Dynamic Timer Tracking
-TimerHandle_t dynamic_timers[DYNAMIC_TIMER_MAX];
+// Dynamic Timer Tracking (pool ids)
+uint32_t dynamic_timers[DYNAMIC_TIMER_MAX];
 uint32_t dynamic_timer_count = 0;
 
-// Test Infrastructure
-QueueHandle_t test_result_queue;
-TaskHandle_t stress_test_task_handle;
-
 // ================ TIMER POOL MANAGEMENT ================
 
+// Pool slots own a static timer for their whole life. Slots are recycled
+// by stopping and re-arming the timer, never by deleting it, so the
+// daemon can't be left holding a delete command for a reused buffer.
 void init_timer_pool(void) {
-    pool_mutex = xSemaphoreCreateMutex();
-    
     for (int i = 0; i < TIMER_POOL_SIZE; i++) {
-        timer_pool[i].handle = NULL;
+        timer_pool[i].handle = pool_timers[i];
         timer_pool[i].in_use = false;
         timer_pool[i].id = 0;
         memset(timer_pool[i].name, 0, sizeof(timer_pool[i].name));
@@ -136,24 +136,18 @@ timer_pool_entry_t* allocate_from_pool(const char* name, TickType_t period,
             entry->start_count = 0;
             entry->callback_count = 0;
             
-            // Create actual timer
-            entry->handle = xTimerCreate(name, period, auto_reload, 
-                                       (void*)entry->id, callback);
-            
-            if (entry->handle == NULL) {
-                entry->in_use = false;
-                entry = NULL;
-                health_data.failed_creations++;
-            } else {
-                health_data.total_timers_created++;
-            }
+            // Re-arm the slot's (stopped) timer without a daemon command;
+            // the period is applied by start_pool_timer()
+            vTimerSetTimerID(entry->handle, (void*)entry->id);
+            vTimerSetReloadMode(entry->handle, auto_reload);
+            sc_inc(&health_data.total_timers_created);
             break;
         }
     }
     
     if (entry == NULL) {
         ESP_LOGW(TAG, "Timer pool exhausted");
-        health_data.failed_creations++;
+        sc_inc(&health_data.failed_creations);
     }
     
     xSemaphoreGive(pool_mutex);
@@ -167,11 +161,11 @@ void release_to_pool(uint32_t timer_id) {
     
     for (int i = 0; i < TIMER_POOL_SIZE; i++) {
         if (timer_pool[i].in_use && timer_pool[i].id == timer_id) {
-            if (timer_pool[i].handle) {
-                xTimerDelete(timer_pool[i].handle, 0);
+            if (xTimerStop(timer_pool[i].handle, 0) != pdPASS) {
+                sc_inc(&health_data.command_failures);
             }
             timer_pool[i].in_use = false;
-            timer_pool[i].handle = NULL;
+            timer_pool[i].callback = NULL;
             ESP_LOGI(TAG, "Released timer %lu from pool", timer_id);
             break;
         }
@@ -180,9 +174,45 @@ void release_to_pool(uint32_t timer_id) {
     xSemaphoreGive(pool_mutex);
 }
 
+// Starts a pool timer with its slot's period. xTimerChangePeriod() both
+// sets the period and starts the timer, so this is one daemon command.
+BaseType_t start_pool_timer(TimerHandle_t handle) {
+    for (int i = 0; i < TIMER_POOL_SIZE; i++) {
+        if (timer_pool[i].handle == handle && timer_pool[i].in_use) {
+            if (xTimerChangePeriod(handle, timer_pool[i].period, 0) != pdPASS) {
+                sc_inc(&health_data.command_failures);
+                return pdFAIL;
+            }
+            timer_pool[i].start_count++;
+            return pdPASS;
+        }
+    }
+    return pdFAIL;
+}
+
+// Shared callback of every pool timer, forwards to the slot's callback
+void pool_timer_dispatch(TimerHandle_t timer) {
+    for (int i = 0; i < TIMER_POOL_SIZE; i++) {
+        if (timer_pool[i].handle == timer) {
+            TimerCallbackFunction_t callback = timer_pool[i].callback;
+            if (timer_pool[i].in_use && callback != NULL) {
+                timer_pool[i].callback_count++;
+                callback(timer);
+            }
+            return;
+        }
+    }
+}
+
 // ================ PERFORMANCE MONITORING ================
 
 void record_performance_sample(uint32_t timer_id, uint32_t duration_us, bool accuracy_ok) {
+    // Counted lock-free, so an overrun is not lost when the sample is
+    mx_observe(&callback_duration, duration_us);
+    if (duration_us > 1000) { // > 1ms is concerning
+        sc_inc(&health_data.callback_overruns);
+    }
+
     if (xSemaphoreTake(perf_mutex, 0) == pdTRUE) { // Non-blocking
         performance_sample_t* sample = &perf_buffer[perf_buffer_index];
         
@@ -195,10 +225,6 @@ void record_performance_sample(uint32_t timer_id, uint32_t duration_us, bool acc
         
         perf_buffer_index = (perf_buffer_index + 1) % PERFORMANCE_BUFFER_SIZE;
         
-        if (duration_us > 1000) { // > 1ms is concerning
-            health_data.callback_overruns++;
-        }
-        
         xSemaphoreGive(perf_mutex);
     }
 }
@@ -243,7 +269,7 @@ void analyze_performance(void) {
                  avg_duration, max_duration, min_duration);
         ESP_LOGI(TAG, "  Timer Accuracy: %.1f%% (%lu/%lu)", 
                  health_data.average_accuracy, accurate_timers, sample_count);
-        ESP_LOGI(TAG, "  Callback Overruns: %lu", health_data.callback_overruns);
+        ESP_LOGI(TAG, "  Callback Overruns: %lu", sc_read(&health_data.callback_overruns));
         
         // Visual feedback
         if (avg_duration > 500) {
@@ -285,14 +311,7 @@ void performance_test_callback(TimerHandle_t timer) {
     last_callback_time = start_time;
     
     record_performance_sample(timer_id, duration_us, accuracy_ok);
-    
-    // Update timer stats
-    for (int i = 0; i < TIMER_POOL_SIZE; i++) {
-        if (timer_pool[i].in_use && timer_pool[i].id == timer_id) {
-            timer_pool[i].callback_count++;
-            break;
-        }
-    }
+    // Pool timers have their callback_count updated by pool_timer_dispatch
 }
 
 void stress_test_callback(TimerHandle_t timer) {
@@ -308,7 +327,7 @@ void stress_test_callback(TimerHandle_t timer) {
 
 void health_monitor_callback(TimerHandle_t timer) {
     // Update health metrics
-    health_data.free_heap_bytes = esp_get_free_heap_size();
+    sc_set(&health_data.free_heap_bytes, esp_get_free_heap_size());
     
     uint32_t active_count = 0;
     uint32_t pool_used = 0;
@@ -325,12 +344,12 @@ void health_monitor_callback(TimerHandle_t timer) {
         xSemaphoreGive(pool_mutex);
     }
     
-    health_data.active_timers = active_count;
-    health_data.pool_utilization = (pool_used * 100) / TIMER_POOL_SIZE;
-    health_data.dynamic_timers = dynamic_timer_count;
+    sc_set(&health_data.active_timers, active_count);
+    sc_set(&health_data.pool_utilization, (pool_used * 100) / TIMER_POOL_SIZE);
+    sc_set(&health_data.dynamic_timers, dynamic_timer_count);
     
     // Health status LED
-    if (health_data.pool_utilization > 80 || health_data.callback_overruns > 10) {
+    if (sc_read(&health_data.pool_utilization) > 80 || sc_read(&health_data.callback_overruns) > 10) {
         gpio_set_level(HEALTH_LED, 1); // Warning
     } else {
         gpio_set_level(HEALTH_LED, 0);
@@ -338,10 +357,10 @@ void health_monitor_callback(TimerHandle_t timer) {
     
     ESP_LOGI(TAG, "🏥 Health Monitor:");
     ESP_LOGI(TAG, "  Active Timers: %lu/%lu", active_count, pool_used);
-    ESP_LOGI(TAG, "  Pool Utilization: %lu%%", health_data.pool_utilization);
-    ESP_LOGI(TAG, "  Dynamic Timers: %lu/%d", health_data.dynamic_timers, DYNAMIC_TIMER_MAX);
-    ESP_LOGI(TAG, "  Free Heap: %lu bytes", health_data.free_heap_bytes);
-    ESP_LOGI(TAG, "  Failed Creations: %lu", health_data.failed_creations);
+    ESP_LOGI(TAG, "  Pool Utilization: %lu%%", sc_read(&health_data.pool_utilization));
+    ESP_LOGI(TAG, "  Dynamic Timers: %lu/%d", sc_read(&health_data.dynamic_timers), DYNAMIC_TIMER_MAX);
+    ESP_LOGI(TAG, "  Free Heap: %lu bytes", sc_read(&health_data.free_heap_bytes));
+    ESP_LOGI(TAG, "  Failed Creations: %lu", sc_read(&health_data.failed_creations));
 }
 
 // ================ DYNAMIC TIMER MANAGEMENT ================
@@ -353,24 +372,24 @@ TimerHandle_t create_dynamic_timer(const char* name, uint32_t period_ms,
         return NULL;
     }
     
-    TimerHandle_t timer = xTimerCreate(name, pdMS_TO_TICKS(period_ms), 
-                                     auto_reload, (void*)next_timer_id++, callback);
-    
-    if (timer != NULL) {
-        dynamic_timers[dynamic_timer_count] = timer;
-        dynamic_timer_count++;
-        ESP_LOGI(TAG, "Created dynamic timer: %s", name);
+    // Served from the static pool, no heap allocation at runtime
+    timer_pool_entry_t* entry = allocate_from_pool(name, pdMS_TO_TICKS(period_ms),
+                                                   auto_reload, callback, NULL);
+    if (entry == NULL) {
+        return NULL;
     }
     
-    return timer;
+    dynamic_timers[dynamic_timer_count] = entry->id;
+    dynamic_timer_count++;
+    ESP_LOGI(TAG, "Created dynamic timer: %s", name);
+    
+    return entry->handle;
 }
 
 void cleanup_dynamic_timers(void) {
     for (uint32_t i = 0; i < dynamic_timer_count; i++) {
-        if (dynamic_timers[i] != NULL) {
-            xTimerDelete(dynamic_timers[i], pdMS_TO_TICKS(100));
-            dynamic_timers[i] = NULL;
-        }
+        release_to_pool(dynamic_timers[i]);
+        dynamic_timers[i] = 0;
     }
     dynamic_timer_count = 0;
     ESP_LOGI(TAG, "Cleaned up all dynamic timers");
@@ -379,6 +398,8 @@ void cleanup_dynamic_timers(void) {
 // ================ STRESS TESTING ================
 
 void stress_test_task(void *parameter) {
+    // Created at boot by static_objects_init(), give the system time to settle
+    vTaskDelay(pdMS_TO_TICKS(5000));
     ESP_LOGI(TAG, "🔥 Starting stress test...");
     
     // Create many timers with different periods
@@ -393,7 +414,7 @@ void stress_test_task(void *parameter) {
                                             true, stress_test_callback, NULL);
         
         if (stress_timers[i] != NULL) {
-            xTimerStart(stress_timers[i]->handle, 0);
+            start_pool_timer(stress_timers[i]->handle);
         }
         
         vTaskDelay(pdMS_TO_TICKS(100)); // Stagger creation
@@ -420,10 +441,12 @@ void stress_test_task(void *parameter) {
         TimerHandle_t dt = create_dynamic_timer(name, 200 + (i * 100), 
                                               true, performance_test_callback);
         if (dt != NULL) {
-            xTimerStart(dt, 0);
+            start_pool_timer(dt);
         }
     }
     
+    static_objects_report();
+    
     vTaskDelete(NULL);
 }
 
@@ -439,17 +462,17 @@ void performance_analysis_task(void *parameter) {
         
         // Generate performance report
         ESP_LOGI(TAG, "\n═══ PERFORMANCE REPORT ═══");
-        ESP_LOGI(TAG, "Total Timers Created: %lu", health_data.total_timers_created);
-        ESP_LOGI(TAG, "Current Active: %lu", health_data.active_timers);
-        ESP_LOGI(TAG, "Pool Utilization: %lu%%", health_data.pool_utilization);
+        ESP_LOGI(TAG, "Total Timers Created: %lu", sc_read(&health_data.total_timers_created));
+        ESP_LOGI(TAG, "Current Active: %lu", sc_read(&health_data.active_timers));
+        ESP_LOGI(TAG, "Pool Utilization: %lu%%", sc_read(&health_data.pool_utilization));
         ESP_LOGI(TAG, "Average Accuracy: %.1f%%", health_data.average_accuracy);
-        ESP_LOGI(TAG, "Callback Overruns: %lu", health_data.callback_overruns);
-        ESP_LOGI(TAG, "Command Failures: %lu", health_data.command_failures);
+        ESP_LOGI(TAG, "Callback Overruns: %lu", sc_read(&health_data.callback_overruns));
+        ESP_LOGI(TAG, "Command Failures: %lu", sc_read(&health_data.command_failures));
         ESP_LOGI(TAG, "═════════════════════════\n");
         
         // Memory usage check
-        if (health_data.free_heap_bytes < 20000) {
-            ESP_LOGW(TAG, "⚠️ Low memory warning: %lu bytes", health_data.free_heap_bytes);
+        if (sc_read(&health_data.free_heap_bytes) < 20000) {
+            ESP_LOGW(TAG, "⚠️ Low memory warning: %lu bytes", sc_read(&health_data.free_heap_bytes));
             gpio_set_level(ERROR_LED, 1);
         } else {
             gpio_set_level(ERROR_LED, 0);
@@ -472,36 +495,30 @@ void init_hardware(void) {
 }
 
 void init_monitoring(void) {
-    perf_mutex = xSemaphoreCreateMutex();
-    test_result_queue = xQueueCreate(20, sizeof(uint32_t));
-    
     // Clear performance buffer
     memset(perf_buffer, 0, sizeof(perf_buffer));
+
+    sc_register(&health_data.total_timers_created, "timers_created", "Pool timers handed out", SC_COUNTER);
+    sc_register(&health_data.failed_creations, "timer_failed_creations", "Pool allocations with no free slot", SC_COUNTER);
+    sc_register(&health_data.command_failures, "timer_command_failures", "Timer commands the daemon queue refused", SC_COUNTER);
+    sc_register(&health_data.callback_overruns, "timer_callback_overruns", "Callbacks that ran longer than 1 ms", SC_COUNTER);
+    sc_register(&health_data.active_timers, "timers_active", "Pool timers currently running", SC_GAUGE);
+    sc_register(&health_data.pool_utilization, "timer_pool_utilization_pct", "Pool slots in use", SC_GAUGE);
+    sc_register(&health_data.dynamic_timers, "timers_dynamic", "Dynamically requested timers", SC_GAUGE);
+    sc_register(&health_data.free_heap_bytes, "free_heap_bytes", "Free heap at the last health check", SC_GAUGE);
+    mx_histogram(&callback_duration, "timer_callback_duration_us", "Measured timer callback duration",
+                 NULL, callback_bounds_us, sizeof(callback_bounds_us) / sizeof(callback_bounds_us[0]));
     
     ESP_LOGI(TAG, "Monitoring systems initialized");
 }
 
-void create_system_timers(void) {
-    // Health monitor timer
-    health_monitor_timer = xTimerCreate("HealthMonitor",
-                                       pdMS_TO_TICKS(HEALTH_CHECK_INTERVAL),
-                                       pdTRUE, // Auto-reload
-                                       (void*)1,
-                                       health_monitor_callback);
-    
-    // Performance test timer
-    performance_timer = xTimerCreate("PerfTest",
-                                    pdMS_TO_TICKS(500),
-                                    pdTRUE, // Auto-reload
-                                    (void*)2,
-                                    performance_test_callback);
-    
-    if (health_monitor_timer && performance_timer) {
-        xTimerStart(health_monitor_timer, 0);
-        xTimerStart(performance_timer, 0);
+void start_system_timers(void) {
+    // HealthMonitor and PerfTest are created by static_objects_init()
+    if (xTimerStart(health_monitor_timer, 0) == pdPASS &&
+        xTimerStart(performance_timer, 0) == pdPASS) {
         ESP_LOGI(TAG, "System timers started");
     } else {
-        ESP_LOGE(TAG, "Failed to create system timers");
+        ESP_LOGE(TAG, "Failed to start system timers");
     }
 }
 
@@ -510,16 +527,14 @@ void app_main(void) {
     
     // Initialize components
     init_hardware();
+    if (!static_objects_init()) {
+        ESP_LOGE(TAG, "Static object init failed");
+        return;
+    }
     init_timer_pool();
     init_monitoring();
-    create_system_timers();
-    
-    // Create analysis task
-    xTaskCreate(performance_analysis_task, "PerfAnalysis", 3072, NULL, 8, NULL);
-    
-    // Wait a bit then start stress test
-    vTaskDelay(pdMS_TO_TICKS(5000));
-    xTaskCreate(stress_test_task, "StressTest", 2048, NULL, 5, &stress_test_task_handle);
+    start_system_timers();
+    static_objects_report();
     
     ESP_LOGI(TAG, "🚀 Advanced Timer Management System Running");
     ESP_LOGI(TAG, "Monitor LEDs for system status:");
@@ -0,0 +1,103 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "shard_counter.h"
+
+// ================================= METRICS ==================================
+// One registry for counters, gauges and histograms, exported on demand.
+//
+// A metric is a caller-owned mx_metric_t, usually static or inside the
+// struct it describes, so registering and updating never allocate. Values
+// are sharded counters (shard_counter.h). Histogram buckets are relaxed
+// atomics. Metrics sharing a name form one family and differ in their label
+// set. The label set is preformatted text such as `task="TaskA"` and must
+// outlive the metric.
+//
+// Every counter registered with sc_register() is exported too, as an
+// unlabelled counter or gauge, so existing shard counters need no changes.
+//
+// Exporters read each value once when called; there is no global lock:
+//   mx_export_text()  Prometheus text format 0.0.4
+//   mx_snapshot()     compact binary, see the layout below
+//   mx_dump_file()    either of them to a file
+//   mx_serve_task()   answers requests on the console UART:
+//                       "metrics"        -> text, between "# BEGIN METRICS" and "# EOF"
+//                       "metrics schema" -> one line "MXS <base64>"
+//                       "metrics bin"    -> one line "MXV <base64>"
+// tools/metrics_scrape.py on the host sends these, decodes the answers and
+// diffs snapshots.
+//
+// Binary records (integers little-endian, varints LEB128, svarint zigzag):
+//   'M' kind hash:u32 body       kind 'S' = schema, 'V' = values
+//   schema: count:varint, then per metric
+//           type:u8 name:str labels:str [histogram: n:varint n*bound:varint]
+//   values: uptime_ms:varint, then per metric in schema order
+//           counter:varint | gauge:svarint | histogram: sum:varint (n+1)*bucket:varint
+//   str:    len:varint bytes
+// hash covers the schema, so a values record only needs a schema that was
+// fetched once. A device sends about two bytes per counter per scrape.
+// mx_dump_file() writes both records, each prefixed with its u16 length.
+
+#define MX_MAX_BUCKETS   10
+#define MX_SNAPSHOT_MAX  1024
+
+typedef enum {
+    MX_COUNTER,
+    MX_GAUGE,
+    MX_HISTOGRAM,
+} mx_type_t;
+
+typedef struct mx_metric {
+    sc_counter_t value;                 // counter/gauge value, histogram sum
+    const char *name;
+    const char *help;
+    const char *labels;                 // NULL for none
+    mx_type_t type;
+    const uint32_t *bounds;             // histogram upper bounds, ascending
+    int n_bounds;
+    uint32_t bucket[MX_MAX_BUCKETS + 1];  // per bucket, last one is +Inf
+    struct mx_metric *next;
+} mx_metric_t;
+
+void mx_counter(mx_metric_t *m, const char *name, const char *help, const char *labels);
+void mx_gauge(mx_metric_t *m, const char *name, const char *help, const char *labels);
+// Up to MX_MAX_BUCKETS bounds; bounds must outlive the metric
+void mx_histogram(mx_metric_t *m, const char *name, const char *help, const char *labels,
+                  const uint32_t *bounds, int n_bounds);
+
+static inline void mx_inc(mx_metric_t *m) {
+    sc_inc(&m->value);
+}
+
+static inline void mx_add(mx_metric_t *m, uint32_t n) {
+    sc_add(&m->value, n);
+}
+
+// Gauges with a single writer (see sc_set)
+static inline void mx_set(mx_metric_t *m, int32_t v) {
+    sc_set(&m->value, v);
+}
+
+void mx_observe(mx_metric_t *m, uint32_t v);
+
+static inline uint32_t mx_read(const mx_metric_t *m) {
+    return sc_read(&m->value);
+}
+
+uint32_t mx_count(const mx_metric_t *m);
+
+typedef void (*mx_write_fn)(const void *data, size_t len, void *ctx);
+
+void mx_export_text(mx_write_fn write, void *ctx);
+// Returns the record length, or 0 if cap is too small
+size_t mx_snapshot(uint8_t *buf, size_t cap, bool schema);
+bool mx_dump_file(const char *path, bool binary);
+
+void mx_serve_task(void *arg);
+bool mx_serve_start(UBaseType_t priority);
+
+#endif
@@ -0,0 +1,63 @@
+#include <string.h>
+#include "esp_log.h"
+#include "shard_counter.h"
+
+static const char *TAG = "SC";
+
+static sc_counter_t *registry_head = NULL;
+
+void sc_register(sc_counter_t *c, const char *name, const char *help, sc_kind_t kind) {
+    memset(c, 0, sizeof(*c));
+    c->name = name;
+    c->help = help;
+    c->kind = kind;
+    c->next = __atomic_load_n(&registry_head, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&registry_head, &c->next, c, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+}
+
+void sc_set(sc_counter_t *c, int32_t v) {
+    __atomic_store_n(&c->shard[0].v, (uint32_t)v, __ATOMIC_RELAXED);
+    for (int i = 1; i < SC_SHARDS; i++)
+        __atomic_store_n(&c->shard[i].v, 0, __ATOMIC_RELAXED);
+}
+
+uint32_t sc_read(const sc_counter_t *c) {
+    uint32_t sum = 0;
+    for (int i = 0; i < SC_SHARDS; i++)
+        sum += __atomic_load_n(&c->shard[i].v, __ATOMIC_RELAXED);
+    return sum;
+}
+
+uint32_t sc_delta(const sc_counter_t *c, uint32_t *last) {
+    uint32_t now = sc_read(c);
+    uint32_t d = now - *last;
+    *last = now;
+    return d;
+}
+
+sc_counter_t *sc_first(void) {
+    return __atomic_load_n(&registry_head, __ATOMIC_ACQUIRE);
+}
+
+sc_counter_t *sc_next(const sc_counter_t *c) {
+    return c->next;
+}
+
+sc_counter_t *sc_find(const char *name) {
+    for (sc_counter_t *c = sc_first(); c; c = c->next)
+        if (strcmp(c->name, name) == 0)
+            return c;
+    return NULL;
+}
+
+void sc_report_all(void) {
+    ESP_LOGI(TAG, "🧮 Counters:");
+    for (sc_counter_t *c = sc_first(); c; c = c->next) {
+        if (c->kind == SC_GAUGE)
+            ESP_LOGI(TAG, "  %-24s %11ld  (gauge)", c->name, (int32_t)sc_read(c));
+        else
+            ESP_LOGI(TAG, "  %-24s %11lu", c->name, sc_read(c));
+    }
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "static_objects.h"
+
+static const char *TAG = "STATIC_OBJ";
+
+#define SOBJ_IGNORE(...)
+
+// ================ STORAGE ================
+
+#define SOBJ_STORAGE_QUEUE(h, len, size) \
+    static StaticQueue_t h##_cb; static uint8_t h##_storage[(len) * (size)]; QueueHandle_t h;
+#define SOBJ_STORAGE_BINARY_SEM(h) \
+    static StaticSemaphore_t h##_cb; SemaphoreHandle_t h;
+#define SOBJ_STORAGE_COUNTING_SEM(h, max, init) \
+    static StaticSemaphore_t h##_cb; SemaphoreHandle_t h;
+#define SOBJ_STORAGE_MUTEX(h) \
+    static StaticSemaphore_t h##_cb; SemaphoreHandle_t h;
+#define SOBJ_STORAGE_EVENT_GROUP(h) \
+    static StaticEventGroup_t h##_cb; EventGroupHandle_t h;
+#define SOBJ_STORAGE_TIMER(h, name, ms, reload, id, cb) \
+    static StaticTimer_t h##_cb; TimerHandle_t h;
+#define SOBJ_STORAGE_TIMER_ARRAY(h, count, name, cb) \
+    static StaticTimer_t h##_cb[count]; TimerHandle_t h[count];
+#define SOBJ_STORAGE_TASK(h, fn, name, stack, prio) \
+    static StaticTask_t h##_cb; static StackType_t h##_stack[stack]; TaskHandle_t h;
+
+STATIC_OBJECTS(SOBJ_STORAGE_QUEUE, SOBJ_STORAGE_BINARY_SEM, SOBJ_STORAGE_COUNTING_SEM,
+               SOBJ_STORAGE_MUTEX, SOBJ_STORAGE_EVENT_GROUP, SOBJ_STORAGE_TIMER,
+               SOBJ_STORAGE_TIMER_ARRAY, SOBJ_STORAGE_TASK)
+
+// ================ OBJECT INFO ================
+
+#define SOBJ_INFO_QUEUE(h, len, size) \
+    { #h, SOBJ_QUEUE, sizeof(StaticQueue_t) + (len) * (size) },
+#define SOBJ_INFO_BINARY_SEM(h) \
+    { #h, SOBJ_BINARY_SEM, sizeof(StaticSemaphore_t) },
+#define SOBJ_INFO_COUNTING_SEM(h, max, init) \
+    { #h, SOBJ_COUNTING_SEM, sizeof(StaticSemaphore_t) },
+#define SOBJ_INFO_MUTEX(h) \
+    { #h, SOBJ_MUTEX, sizeof(StaticSemaphore_t) },
+#define SOBJ_INFO_EVENT_GROUP(h) \
+    { #h, SOBJ_EVENT_GROUP, sizeof(StaticEventGroup_t) },
+#define SOBJ_INFO_TIMER(h, name, ms, reload, id, cb) \
+    { #h, SOBJ_TIMER, sizeof(StaticTimer_t) },
+#define SOBJ_INFO_TIMER_ARRAY(h, count, name, cb) \
+    { #h, SOBJ_TIMER, sizeof(StaticTimer_t) * (count) },
+#define SOBJ_INFO_TASK(h, fn, name, stack, prio) \
+    { #h, SOBJ_TASK, sizeof(StaticTask_t) + (stack) * sizeof(StackType_t) },
+
+static const static_obj_info_t object_info[] = {
+    STATIC_OBJECTS(SOBJ_INFO_QUEUE, SOBJ_INFO_BINARY_SEM, SOBJ_INFO_COUNTING_SEM,
+                   SOBJ_INFO_MUTEX, SOBJ_INFO_EVENT_GROUP, SOBJ_INFO_TIMER,
+                   SOBJ_INFO_TIMER_ARRAY, SOBJ_INFO_TASK)
+};
+
+#define OBJECT_COUNT (sizeof(object_info) / sizeof(object_info[0]))
+
+static const char *kind_names[SOBJ_KIND_COUNT] = {
+    "Queue", "BinarySem", "CountingSem", "Mutex", "EventGroup", "Timer", "Task"
+};
+
+// ================ INIT ================
+
+static uint32_t init_failures = 0;
+static int64_t init_duration_us = 0;
+static size_t heap_free_before_init = 0;
+static size_t heap_free_after_init = 0;
+
+#define SOBJ_CHECK(h) \
+    if ((h) == NULL) { ESP_LOGE(TAG, "Failed to create %s", #h); init_failures++; }
+
+#define SOBJ_INIT_QUEUE(h, len, size) \
+    h = xQueueCreateStatic(len, size, h##_storage, &h##_cb); SOBJ_CHECK(h)
+#define SOBJ_INIT_BINARY_SEM(h) \
+    h = xSemaphoreCreateBinaryStatic(&h##_cb); SOBJ_CHECK(h)
+#define SOBJ_INIT_COUNTING_SEM(h, max, init) \
+    h = xSemaphoreCreateCountingStatic(max, init, &h##_cb); SOBJ_CHECK(h)
+#define SOBJ_INIT_MUTEX(h) \
+    h = xSemaphoreCreateMutexStatic(&h##_cb); SOBJ_CHECK(h)
+#define SOBJ_INIT_EVENT_GROUP(h) \
+    h = xEventGroupCreateStatic(&h##_cb); SOBJ_CHECK(h)
+#define SOBJ_INIT_TIMER(h, name, ms, reload, id, cb) \
+    h = xTimerCreateStatic(name, pdMS_TO_TICKS(ms), reload, (void*)(id), cb, &h##_cb); SOBJ_CHECK(h)
+#define SOBJ_INIT_TIMER_ARRAY(h, count, name, cb) \
+    for (int i = 0; i < (count); i++) { \
+        h[i] = xTimerCreateStatic(name, pdMS_TO_TICKS(1000), pdFALSE, NULL, cb, &h##_cb[i]); \
+        SOBJ_CHECK(h[i]) \
+    }
+#define SOBJ_INIT_TASK(h, fn, name, stack, prio) \
+    h = xTaskCreateStatic(fn, name, stack, NULL, prio, h##_stack, &h##_cb); SOBJ_CHECK(h)
+
+bool static_objects_init(void) {
+    heap_free_before_init = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    int64_t start = esp_timer_get_time();
+
+    STATIC_OBJECTS(SOBJ_INIT_QUEUE, SOBJ_INIT_BINARY_SEM, SOBJ_INIT_COUNTING_SEM,
+                   SOBJ_INIT_MUTEX, SOBJ_INIT_EVENT_GROUP, SOBJ_INIT_TIMER,
+                   SOBJ_INIT_TIMER_ARRAY, SOBJ_IGNORE)
+
+    STATIC_OBJECTS(SOBJ_IGNORE, SOBJ_IGNORE, SOBJ_IGNORE, SOBJ_IGNORE,
+                   SOBJ_IGNORE, SOBJ_IGNORE, SOBJ_IGNORE, SOBJ_INIT_TASK)
+
+    init_duration_us = esp_timer_get_time() - start;
+    heap_free_after_init = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+
+    ESP_LOGI(TAG, "Created %d static objects in %lld μs (%lu failures)",
+             OBJECT_COUNT, init_duration_us, init_failures);
+    return init_failures == 0;
+}
+
+// ================ REPORT ================
+
+size_t static_objects_total_bytes(void) {
+    size_t total = 0;
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        total += object_info[i].bytes;
+    }
+    return total;
+}
+
+void static_objects_report(void) {
+    size_t per_kind[SOBJ_KIND_COUNT] = {0};
+    uint32_t count_kind[SOBJ_KIND_COUNT] = {0};
+
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        per_kind[object_info[i].kind] += object_info[i].bytes;
+        count_kind[object_info[i].kind]++;
+    }
+
+    size_t heap_total = heap_caps_get_total_size(MALLOC_CAP_DEFAULT);
+    size_t heap_free = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+
+    ESP_LOGI(TAG, "📦 Static Object Report:");
+    for (int k = 0; k < SOBJ_KIND_COUNT; k++) {
+        if (count_kind[k] > 0) {
+            ESP_LOGI(TAG, "  %-12s x%-3lu %6d bytes", kind_names[k], count_kind[k], per_kind[k]);
+        }
+    }
+    ESP_LOGI(TAG, "  Static total:     %d bytes", static_objects_total_bytes());
+    ESP_LOGI(TAG, "  Heap used by init: %d bytes", heap_free_before_init - heap_free_after_init);
+    ESP_LOGI(TAG, "  Heap in use:      %d / %d bytes (min free %d)",
+             heap_total - heap_free, heap_total,
+             heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT));
+    ESP_LOGI(TAG, "  Init time:        %lld μs", init_duration_us);
+}
@@ -0,0 +1,73 @@
+#ifndef STATIC_OBJECTS_H
+#define STATIC_OBJECTS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+#include "freertos/event_groups.h"
+
+// ================ STATIC OBJECT REGISTRY ================
+// Every kernel object of the application is listed once in
+// STATIC_OBJECTS() (static_objects_config.h). The registry expands that
+// table into control blocks, buffers, handles, one init routine and a RAM
+// report, so nothing is taken from the heap after boot.
+//
+// Table entries:
+//   QUEUE(handle, length, item_size)
+//   BINARY_SEM(handle)
+//   COUNTING_SEM(handle, max_count, initial_count)
+//   MUTEX(handle)
+//   EVENT_GROUP(handle)
+//   TIMER(handle, name, period_ms, auto_reload, id, callback)
+//   TIMER_ARRAY(handle, count, name, callback)   created dormant, id = NULL
+//   TASK(handle, function, name, stack_bytes, priority)
+//
+// Tasks are created after every other object so they never see a NULL handle.
+
+typedef enum {
+    SOBJ_QUEUE,
+    SOBJ_BINARY_SEM,
+    SOBJ_COUNTING_SEM,
+    SOBJ_MUTEX,
+    SOBJ_EVENT_GROUP,
+    SOBJ_TIMER,
+    SOBJ_TASK,
+    SOBJ_KIND_COUNT
+} static_obj_kind_t;
+
+typedef struct {
+    const char *name;
+    static_obj_kind_t kind;
+    size_t bytes;               // control blocks + buffers / stacks
+} static_obj_info_t;
+
+#include "static_objects_config.h"
+
+#define SOBJ_EXTERN_QUEUE(h, len, size)                  extern QueueHandle_t h;
+#define SOBJ_EXTERN_BINARY_SEM(h)                        extern SemaphoreHandle_t h;
+#define SOBJ_EXTERN_COUNTING_SEM(h, max, init)           extern SemaphoreHandle_t h;
+#define SOBJ_EXTERN_MUTEX(h)                             extern SemaphoreHandle_t h;
+#define SOBJ_EXTERN_EVENT_GROUP(h)                       extern EventGroupHandle_t h;
+#define SOBJ_EXTERN_TIMER(h, name, ms, reload, id, cb)   extern TimerHandle_t h;
+#define SOBJ_EXTERN_TIMER_ARRAY(h, count, name, cb)      extern TimerHandle_t h[count];
+#define SOBJ_EXTERN_TASK(h, fn, name, stack, prio)       extern TaskHandle_t h;
+
+STATIC_OBJECTS(SOBJ_EXTERN_QUEUE, SOBJ_EXTERN_BINARY_SEM, SOBJ_EXTERN_COUNTING_SEM,
+               SOBJ_EXTERN_MUTEX, SOBJ_EXTERN_EVENT_GROUP, SOBJ_EXTERN_TIMER,
+               SOBJ_EXTERN_TIMER_ARRAY, SOBJ_EXTERN_TASK)
+
+// Create every object in the table. Call once from app_main; returns false
+// if any object failed (only possible with a bad table entry).
+bool static_objects_init(void);
+
+// Total bytes reserved at compile time by the table
+size_t static_objects_total_bytes(void);
+
+// Per-kind static RAM, init time and current heap usage
+void static_objects_report(void);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef STATIC_OBJECTS_CONFIG_H
+#define STATIC_OBJECTS_CONFIG_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "metrics.h"
+
+// ================ APPLICATION OBJECT TABLE ================
+
+#define TIMER_POOL_SIZE              20
+#define HEALTH_CHECK_INTERVAL        1000
+
+void health_monitor_callback(TimerHandle_t timer);
+void performance_test_callback(TimerHandle_t timer);
+void pool_timer_dispatch(TimerHandle_t timer);
+void performance_analysis_task(void *parameter);
+void stress_test_task(void *parameter);
+
+#define STATIC_OBJECTS(QUEUE, BINARY_SEM, COUNTING_SEM, MUTEX, EVENT_GROUP, TIMER, TIMER_ARRAY, TASK) \
+    MUTEX(pool_mutex)                                                                          \
+    MUTEX(perf_mutex)                                                                          \
+    QUEUE(test_result_queue, 20, sizeof(uint32_t))                                             \
+    TIMER(health_monitor_timer, "HealthMonitor", HEALTH_CHECK_INTERVAL, pdTRUE, 1,             \
+          health_monitor_callback)                                                             \
+    TIMER(performance_timer, "PerfTest", 500, pdTRUE, 2, performance_test_callback)            \
+    TIMER_ARRAY(pool_timers, TIMER_POOL_SIZE, "PoolTimer", pool_timer_dispatch)                \
+    TASK(perf_analysis_task_handle, performance_analysis_task, "PerfAnalysis", 3072, 8)        \
+    TASK(stress_test_task_handle, stress_test_task, "StressTest", 2048, 5)                     \
+    TASK(metrics_task_handle, mx_serve_task, "MetricsSrv", 3072, 2)
+
+#endif
@@ -3,7 +3,12 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "init_graph.h"
+#include "barrier.h"
+#include "sensor_snapshot.h"
 
 static const char *TAG = "EVENT_EXERCISES";
 EventGroupHandle_t event_group;
@@ -14,54 +19,52 @@ static void random_delay(int min_ms, int max_ms) {
 }
 
 // ============================ EXERCISE 1 ============================
-#define HW_INIT_BIT   BIT0
-#define NET_INIT_BIT  BIT1
-#define CFG_INIT_BIT  BIT2
-#define ALL_INIT_BITS (HW_INIT_BIT | NET_INIT_BIT | CFG_INIT_BIT)
+enum { STEP_HW, STEP_NET, STEP_CFG, EX1_STEPS };
 
-void hw_init_task(void *p) {
+void hw_init_step(void *p) {
     ESP_LOGI(TAG, "Hardware init started");
     random_delay(1000, 5000);
     ESP_LOGI(TAG, "Hardware init done");
-    xEventGroupSetBits(event_group, HW_INIT_BIT);
-    vTaskDelete(NULL);
 }
 
-void net_init_task(void *p) {
+void net_init_step(void *p) {
     ESP_LOGI(TAG, "Network init started");
     random_delay(2000, 6000);
     ESP_LOGI(TAG, "Network init done");
-    xEventGroupSetBits(event_group, NET_INIT_BIT);
-    vTaskDelete(NULL);
 }
 
-void cfg_init_task(void *p) {
+void cfg_init_step(void *p) {
     ESP_LOGI(TAG, "Config init started");
     random_delay(1000, 4000);
     ESP_LOGI(TAG, "Config init done");
-    xEventGroupSetBits(event_group, CFG_INIT_BIT);
-    vTaskDelete(NULL);
 }
 
+static const init_step_t ex1_steps[EX1_STEPS] = {
+    [STEP_HW]  = { "HW",  hw_init_step,  NULL, 0 },
+    [STEP_NET] = { "NET", net_init_step, NULL, 0 },
+    [STEP_CFG] = { "CFG", cfg_init_step, NULL, 0 },
+};
+static init_graph_t ex1_graph;
+
 void main_task_ex1(void *p) {
     ESP_LOGI(TAG, "Waiting for all initialization...");
-    EventBits_t bits = xEventGroupWaitBits(event_group, ALL_INIT_BITS,
-                                           pdFALSE, pdTRUE, pdMS_TO_TICKS(10000));
 
-    if ((bits & ALL_INIT_BITS) == ALL_INIT_BITS)
+    if (init_graph_wait(&ex1_graph, pdMS_TO_TICKS(10000))) {
         ESP_LOGI(TAG, "✅ All systems initialized successfully!");
-    else
-        ESP_LOGW(TAG, "⚠️ Initialization timeout! Received bits=0x%02x", bits);
+        init_graph_report(&ex1_graph);
+    } else {
+        ESP_LOGW(TAG, "⚠️ Initialization timeout! Received bits=0x%02lx",
+                 xEventGroupGetBits(ex1_graph.done_bits));
+    }
 
     vTaskDelete(NULL);
 }
 
 void start_exercise1(void) {
     ESP_LOGI(TAG, "===== EXERCISE 1: Basic Event Coordination =====");
-    xTaskCreate(hw_init_task, "HW", 2048, NULL, 5, NULL);
-    xTaskCreate(net_init_task, "NET", 2048, NULL, 5, NULL);
-    xTaskCreate(cfg_init_task, "CFG", 2048, NULL, 5, NULL);
-    xTaskCreate(main_task_ex1, "MAIN1", 2048, NULL, 4, NULL);
+    if (init_graph_run(&ex1_graph, ex1_steps, EX1_STEPS, 3, 5) != ESP_OK)
+        return;
+    xTaskCreate(main_task_ex1, "MAIN1", 3072, NULL, 4, NULL);
 }
 
 // ============================ EXERCISE 2 ============================
@@ -72,16 +75,20 @@ void start_exercise1(void) {
 #define BASIC_ENV (TEMP_BIT | HUM_BIT)
 #define FULL_ENV  (BASIC_ENV | PRES_BIT)
 
-typedef struct {
-    float temp, hum, pres;
-} sensor_data_t;
+// Readings older than twice their publish period count as stale
+static const uint32_t sensor_max_age_ms[SENSOR_FIELD_COUNT] = {
+    [SENSOR_TEMP] = 2000,
+    [SENSOR_HUM]  = 2400,
+    [SENSOR_PRES] = 4000,
+};
 
-sensor_data_t sensor_data;
+sensor_store_t sensor_store;
 
 void temp_task(void *p) {
     while (1) {
-        sensor_data.temp = 20 + (rand() % 100) / 5.0;
-        ESP_LOGI(TAG, "Temp = %.1f", sensor_data.temp);
+        sensor_value_t temp = SV_FROM_RATIO(100 + rand() % 100, 5); // 20 + r/5
+        sensor_store_publish(&sensor_store, SENSOR_TEMP, temp);
+        ESP_LOGI(TAG, "Temp = %.1f", SV_TO_FLOAT(temp));
         xEventGroupSetBits(event_group, TEMP_BIT);
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
@@ -89,8 +96,9 @@ void temp_task(void *p) {
 
 void hum_task(void *p) {
     while (1) {
-        sensor_data.hum = 40 + (rand() % 200) / 5.0;
-        ESP_LOGI(TAG, "Hum  = %.1f%%", sensor_data.hum);
+        sensor_value_t hum = SV_FROM_RATIO(200 + rand() % 200, 5); // 40 + r/5
+        sensor_store_publish(&sensor_store, SENSOR_HUM, hum);
+        ESP_LOGI(TAG, "Hum  = %.1f%%", SV_TO_FLOAT(hum));
         xEventGroupSetBits(event_group, HUM_BIT);
         vTaskDelay(pdMS_TO_TICKS(1200));
     }
@@ -98,26 +106,50 @@ void hum_task(void *p) {
 
 void pres_task(void *p) {
     while (1) {
-        sensor_data.pres = 1000 + (rand() % 40);
-        ESP_LOGI(TAG, "Pres = %.1f hPa", sensor_data.pres);
+        sensor_value_t pres = SV_FROM_RATIO(1000 + rand() % 40, 1);
+        sensor_store_publish(&sensor_store, SENSOR_PRES, pres);
+        ESP_LOGI(TAG, "Pres = %.1f hPa", SV_TO_FLOAT(pres));
         xEventGroupSetBits(event_group, PRES_BIT);
         vTaskDelay(pdMS_TO_TICKS(2000));
     }
 }
 
+// 100 - |temp - 25| * 2 - |hum - 50| / 2
+static sensor_value_t comfort_index(sensor_value_t temp, sensor_value_t hum) {
+    sensor_value_t t_off = SV_MUL(SV_ABS(SV_SUB(temp, SV_CONST(25))), SV_CONST(2));
+    sensor_value_t h_off = SV_DIV_INT(SV_ABS(SV_SUB(hum, SV_CONST(50))), 2);
+    return SV_SUB(SV_SUB(SV_CONST(100), t_off), h_off);
+}
+
+// (temp + hum + pres / 10) / 3
+static sensor_value_t env_index_of(sensor_value_t temp, sensor_value_t hum, sensor_value_t pres) {
+    return SV_DIV_INT(SV_ADD(SV_ADD(temp, hum), SV_DIV_INT(pres, 10)), 3);
+}
+
 void fusion_task(void *p) {
+    sensor_snapshot_t snap;
+
     while (1) {
         EventBits_t bits = xEventGroupWaitBits(event_group, BASIC_ENV,
                                                pdTRUE, pdTRUE, pdMS_TO_TICKS(4000));
+        uint32_t gen = sensor_store_read(&sensor_store, &snap);
+        uint32_t stale = sensor_snapshot_stale_mask(&snap, sensor_max_age_ms, esp_timer_get_time());
+        if (stale)
+            ESP_LOGW(TAG, "Snapshot #%lu has stale fields 0x%lx", gen, stale);
+
+        sensor_value_t temp = snap.value[SENSOR_TEMP];
+        sensor_value_t hum = snap.value[SENSOR_HUM];
+        sensor_value_t pres = snap.value[SENSOR_PRES];
+
         if ((bits & BASIC_ENV) == BASIC_ENV) {
-            float comfort = 100 - abs(sensor_data.temp - 25) * 2 - abs(sensor_data.hum - 50) * 0.5;
-            ESP_LOGI(TAG, "Basic Fusion: Comfort=%.1f", comfort);
+            sensor_value_t comfort = comfort_index(temp, hum);
+            ESP_LOGI(TAG, "Basic Fusion #%lu: Comfort=%.1f", gen, SV_TO_FLOAT(comfort));
         }
         bits = xEventGroupGetBits(event_group);
-        if ((bits & FULL_ENV) == FULL_ENV) {
-            float env_index = (sensor_data.temp + sensor_data.hum + sensor_data.pres / 10) / 3.0;
-            ESP_LOGI(TAG, "Full Fusion: EnvIndex=%.1f", env_index);
-            if (env_index > 200 || env_index < 60)
+        if ((bits & FULL_ENV) == FULL_ENV && !(stale & (1u << SENSOR_PRES))) {
+            sensor_value_t env_index = env_index_of(temp, hum, pres);
+            ESP_LOGI(TAG, "Full Fusion: EnvIndex=%.1f", SV_TO_FLOAT(env_index));
+            if (env_index > SV_CONST(200) || env_index < SV_CONST(60))
                 xEventGroupSetBits(event_group, ALERT_BIT);
             xEventGroupClearBits(event_group, PRES_BIT);
         }
@@ -134,7 +166,8 @@ void alert_task(void *p) {
 }
 
 void start_exercise2(void) {
-    ESP_LOGI(TAG, "===== EXERCISE 2: Sensor Data Fusion =====");
+    ESP_LOGI(TAG, "===== EXERCISE 2: Sensor Data Fusion (%s path) =====", SV_PATH_NAME);
+    sensor_store_init(&sensor_store);
     xTaskCreate(temp_task, "Temp", 2048, NULL, 5, NULL);
     xTaskCreate(hum_task, "Hum", 2048, NULL, 5, NULL);
     xTaskCreate(pres_task, "Pres", 2048, NULL, 5, NULL);
@@ -143,46 +176,48 @@ void start_exercise2(void) {
 }
 
 // ============================ EXERCISE 3 ============================
-#define PHASE1 (BIT0)
-#define PHASE2 (BIT1)
-#define PHASE3 (BIT2)
-#define PHASE4 (BIT3)
-#define PHASE5 (BIT4)
+enum { PHASE1, PHASE2, PHASE3, PHASE4, PHASE5, PHASE_COUNT };
 
-void phase_task(void *param) {
+void phase_step(void *param) {
     int id = (int)param;
-    EventBits_t prereq = (id == 0) ? 0 : (1 << (id - 1));
-
-    if (prereq)
-        xEventGroupWaitBits(event_group, prereq, pdFALSE, pdTRUE, portMAX_DELAY);
-
     ESP_LOGI(TAG, "Phase %d starting...", id + 1);
     vTaskDelay(pdMS_TO_TICKS(1000 + rand() % 2000));
     ESP_LOGI(TAG, "Phase %d complete", id + 1);
-    xEventGroupSetBits(event_group, (1 << id));
-    vTaskDelete(NULL);
 }
 
+// Phases 2 and 3 only need phase 1, so they run side by side
+static const init_step_t phase_steps[PHASE_COUNT] = {
+    [PHASE1] = { "Phase1", phase_step, (void *)PHASE1, 0 },
+    [PHASE2] = { "Phase2", phase_step, (void *)PHASE2, INIT_DEP(PHASE1) },
+    [PHASE3] = { "Phase3", phase_step, (void *)PHASE3, INIT_DEP(PHASE1) },
+    [PHASE4] = { "Phase4", phase_step, (void *)PHASE4, INIT_DEP(PHASE2) },
+    [PHASE5] = { "Phase5", phase_step, (void *)PHASE5, INIT_DEP(PHASE3) | INIT_DEP(PHASE4) },
+};
+static init_graph_t phase_graph;
+
 void orchestrator_task(void *p) {
     ESP_LOGI(TAG, "Orchestrator monitoring startup...");
-    xEventGroupWaitBits(event_group, PHASE5, pdFALSE, pdTRUE, pdMS_TO_TICKS(15000));
-    ESP_LOGI(TAG, "🎉 System startup complete!");
+    if (init_graph_wait(&phase_graph, pdMS_TO_TICKS(15000))) {
+        ESP_LOGI(TAG, "🎉 System startup complete!");
+        init_graph_report(&phase_graph);
+    } else {
+        ESP_LOGW(TAG, "⚠️ Startup timeout! Phases done=0x%02lx",
+                 xEventGroupGetBits(phase_graph.done_bits));
+    }
     vTaskDelete(NULL);
 }
 
 void start_exercise3(void) {
     ESP_LOGI(TAG, "===== EXERCISE 3: Multi-Phase Startup =====");
-    for (int i = 0; i < 5; i++)
-        xTaskCreate(phase_task, "Phase", 2048, (void *)i, 5 - i, NULL);
-    xTaskCreate(orchestrator_task, "Orchestrator", 2048, NULL, 3, NULL);
+    if (init_graph_run(&phase_graph, phase_steps, PHASE_COUNT, 2, 5) != ESP_OK)
+        return;
+    xTaskCreate(orchestrator_task, "Orchestrator", 3072, NULL, 3, NULL);
 }
 
 // ============================ EXERCISE 4 ============================
-#define T1_READY BIT0
-#define T2_READY BIT1
-#define T3_READY BIT2
-#define T4_READY BIT3
-#define ALL_READY (T1_READY | T2_READY | T3_READY | T4_READY)
+// Set-bit + wait-with-clear lets the first worker out clear the bits before
+// the others see them. The generation-counted barrier cannot lose a round.
+static barrier_t worker_barrier;
 
 void worker_task(void *param) {
     int id = (int)param;
@@ -190,16 +225,104 @@ void worker_task(void *param) {
         ESP_LOGI(TAG, "Worker %d: working...", id);
         vTaskDelay(pdMS_TO_TICKS(500 + (rand() % 2000)));
         ESP_LOGI(TAG, "Worker %d: waiting at barrier", id);
-        xEventGroupSetBits(event_group, (1 << (id - 1)));
-        xEventGroupWaitBits(event_group, ALL_READY, pdTRUE, pdTRUE, portMAX_DELAY);
-        ESP_LOGI(TAG, "Worker %d: synchronized, continuing", id);
+        uint32_t round = barrier_wait(&worker_barrier, portMAX_DELAY);
+        ESP_LOGI(TAG, "Worker %d: synchronized (round %lu), continuing", id, round);
     }
 }
 
 void start_exercise4(void) {
     ESP_LOGI(TAG, "===== EXERCISE 4: Barrier Synchronization =====");
-    for (int i = 1; i <= 4; i++)
+    barrier_init(&worker_barrier, BARRIER_DEFAULT_SPIN);
+    for (int i = 1; i <= 4; i++) {
+        barrier_register(&worker_barrier); // before the task exists, so no early trip
         xTaskCreate(worker_task, "Worker", 2048, (void *)i, 5, NULL);
+    }
+}
+
+// ============================ EXERCISE 5 ============================
+// Barrier round-trip latency: barrier_t vs xEventGroupSync for 2..32 tasks
+#define BENCH_ROUNDS 1000
+
+typedef struct {
+    barrier_t *barrier;              // NULL -> xEventGroupSync
+    EventGroupHandle_t sync_group;
+    EventBits_t all_bits;
+    int id;
+    int64_t *elapsed_us;
+    SemaphoreHandle_t done;
+} barrier_bench_arg_t;
+
+static void bench_sync(barrier_bench_arg_t *a) {
+    if (a->barrier)
+        barrier_wait(a->barrier, portMAX_DELAY);
+    else
+        xEventGroupSync(a->sync_group, 1 << a->id, a->all_bits, portMAX_DELAY);
+}
+
+void barrier_bench_task(void *param) {
+    barrier_bench_arg_t *a = (barrier_bench_arg_t *)param;
+
+    bench_sync(a); // line everyone up before timing
+    int64_t start = esp_timer_get_time();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        bench_sync(a);
+    if (a->id == 0)
+        *a->elapsed_us = esp_timer_get_time() - start;
+
+    xSemaphoreGive(a->done);
+    vTaskDelete(NULL);
+}
+
+// Returns nanoseconds per round
+static int64_t run_barrier_bench(barrier_t *barrier, int n) {
+    static barrier_bench_arg_t args[BARRIER_MAX_PARTIES];
+    int64_t elapsed_us = 0;
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(n, 0);
+    EventGroupHandle_t group = barrier ? NULL : xEventGroupCreate();
+
+    if (barrier) {
+        barrier_init(barrier, BARRIER_DEFAULT_SPIN);
+        for (int i = 0; i < n; i++)
+            barrier_register(barrier);
+    }
+
+    for (int i = 0; i < n; i++) {
+        args[i] = (barrier_bench_arg_t){
+            .barrier = barrier,
+            .sync_group = group,
+            .all_bits = barrier ? 0 : (1 << n) - 1, // n <= 24 here
+            .id = i,
+            .elapsed_us = &elapsed_us,
+            .done = done,
+        };
+        xTaskCreate(barrier_bench_task, "Bench", 2048, &args[i], 5, NULL);
+    }
+    for (int i = 0; i < n; i++)
+        xSemaphoreTake(done, portMAX_DELAY);
+
+    vSemaphoreDelete(done);
+    if (group)
+        vEventGroupDelete(group);
+    vTaskDelay(pdMS_TO_TICKS(100)); // let idle reclaim the benchmark tasks
+    return elapsed_us * 1000 / BENCH_ROUNDS;
+}
+
+void start_exercise5(void) {
+    static barrier_t bench_barrier;
+
+    ESP_LOGI(TAG, "===== EXERCISE 5: Barrier Benchmark (%d rounds) =====", BENCH_ROUNDS);
+    ESP_LOGI(TAG, "tasks | barrier ns/round | spin/block wakeups | event group ns/round");
+    for (int n = 2; n <= BARRIER_MAX_PARTIES; n *= 2) {
+        int64_t barrier_ns = run_barrier_bench(&bench_barrier, n);
+        if (n <= 24) {
+            int64_t group_ns = run_barrier_bench(NULL, n);
+            ESP_LOGI(TAG, "%5d | %16lld | %8lu/%-8lu | %lld", n, barrier_ns,
+                     bench_barrier.spin_wakeups, bench_barrier.block_wakeups, group_ns);
+        } else {
+            ESP_LOGI(TAG, "%5d | %16lld | %8lu/%-8lu | n/a (24-bit limit)", n, barrier_ns,
+                     bench_barrier.spin_wakeups, bench_barrier.block_wakeups);
+        }
+    }
 }
 
 // ============================ MAIN APP ============================
@@ -208,13 +331,14 @@ void app_main(void) {
     event_group = xEventGroupCreate();
     ESP_LOGI(TAG, "===== FreeRTOS Event Groups Exercises =====");
 
-    int mode = 4;  // 🔧 เปลี่ยนโหมดได้ 1–4 เพื่อรัน Exercise ที่ต้องการ
+    int mode = 4;  // 🔧 เปลี่ยนโหมดได้ 1–5 เพื่อรัน Exercise ที่ต้องการ
 
     switch (mode) {
         case 1: start_exercise1(); break;
         case 2: start_exercise2(); break;
         case 3: start_exercise3(); break;
         case 4: start_exercise4(); break;
-        default: ESP_LOGW(TAG, "Invalid mode! Set mode=1–4"); break;
+        case 5: start_exercise5(); break;
+        default: ESP_LOGW(TAG, "Invalid mode! Set mode=1–5"); break;
     }
 }
@@ -0,0 +1,117 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "barrier.h"
+
+void barrier_init(barrier_t *b, uint32_t spin_limit) {
+    memset(b, 0, sizeof(*b));
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    b->lock = unlocked;
+#if portNUM_PROCESSORS > 1
+    b->spin_limit = spin_limit;
+#else
+    b->spin_limit = 0; // nobody can arrive while we spin on one core
+#endif
+}
+
+// Caller holds b->lock. Starts the next generation and hands back the
+// tasks that blocked in this one so they can be woken outside the lock.
+static uint32_t trip_locked(barrier_t *b, TaskHandle_t *wake) {
+    uint32_t count = b->waiter_count;
+    memcpy(wake, b->waiters, count * sizeof(TaskHandle_t));
+    b->waiter_count = 0;
+    b->arrived = 0;
+    b->trips++;
+    b->generation++;
+    return count;
+}
+
+static void wake_all(TaskHandle_t *wake, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++)
+        xTaskNotifyGive(wake[i]);
+}
+
+uint32_t barrier_register(barrier_t *b) {
+    taskENTER_CRITICAL(&b->lock);
+    if (b->parties < BARRIER_MAX_PARTIES)
+        b->parties++;
+    uint32_t parties = b->parties;
+    taskEXIT_CRITICAL(&b->lock);
+    return parties;
+}
+
+uint32_t barrier_deregister(barrier_t *b) {
+    TaskHandle_t wake[BARRIER_MAX_PARTIES];
+    uint32_t count = 0;
+
+    taskENTER_CRITICAL(&b->lock);
+    if (b->parties > 0)
+        b->parties--;
+    if (b->arrived > 0 && b->arrived >= b->parties)
+        count = trip_locked(b, wake);
+    uint32_t parties = b->parties;
+    taskEXIT_CRITICAL(&b->lock);
+
+    wake_all(wake, count);
+    return parties;
+}
+
+uint32_t barrier_wait(barrier_t *b, TickType_t timeout) {
+    TaskHandle_t wake[BARRIER_MAX_PARTIES];
+
+    taskENTER_CRITICAL(&b->lock);
+    uint32_t gen = b->generation;
+    if (++b->arrived >= b->parties) {
+        uint32_t count = trip_locked(b, wake);
+        taskEXIT_CRITICAL(&b->lock);
+        wake_all(wake, count);
+        return gen;
+    }
+    taskEXIT_CRITICAL(&b->lock);
+
+    // Spin phase: the others may be only a few instructions away
+    for (uint32_t i = 0; i < b->spin_limit; i++) {
+        if (b->generation != gen) {
+            b->spin_wakeups++;
+            return gen;
+        }
+    }
+
+    // Block phase
+    taskENTER_CRITICAL(&b->lock);
+    if (b->generation != gen) {
+        taskEXIT_CRITICAL(&b->lock);
+        b->spin_wakeups++;
+        return gen;
+    }
+    b->waiters[b->waiter_count++] = xTaskGetCurrentTaskHandle();
+    taskEXIT_CRITICAL(&b->lock);
+
+    TickType_t start = xTaskGetTickCount();
+    while (b->generation == gen) {
+        TickType_t waited = xTaskGetTickCount() - start;
+        if (timeout != portMAX_DELAY && waited >= timeout)
+            break;
+        TickType_t remaining = (timeout == portMAX_DELAY) ? portMAX_DELAY : timeout - waited;
+        // A stale notification from a round we timed out of only costs one extra loop
+        ulTaskNotifyTake(pdTRUE, remaining);
+    }
+
+    taskENTER_CRITICAL(&b->lock);
+    if (b->generation == gen) {
+        // Timed out: withdraw so the round still needs a full set of parties
+        for (uint32_t i = 0; i < b->waiter_count; i++) {
+            if (b->waiters[i] == xTaskGetCurrentTaskHandle()) {
+                b->waiters[i] = b->waiters[--b->waiter_count];
+                break;
+            }
+        }
+        b->arrived--;
+        b->timeouts++;
+        taskEXIT_CRITICAL(&b->lock);
+        return BARRIER_TIMEOUT;
+    }
+    b->block_wakeups++;
+    taskEXIT_CRITICAL(&b->lock);
+    return gen;
+}
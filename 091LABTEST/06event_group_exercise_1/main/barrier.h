@@ -0,0 +1,47 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ============================ BARRIER ============================
+// Reusable N-party barrier. Every release bumps a generation counter, so a
+// fast task that re-enters the barrier can never be confused with the round
+// it just left. Waiters spin briefly on the generation (cheap when the
+// others are about to arrive on another core) and then block on a task
+// notification. Parties can register and leave at any time.
+
+#define BARRIER_MAX_PARTIES 32
+#define BARRIER_DEFAULT_SPIN 200
+#define BARRIER_TIMEOUT UINT32_MAX
+
+typedef struct {
+    portMUX_TYPE lock;
+    volatile uint32_t generation;
+    uint32_t parties;
+    uint32_t arrived;
+    uint32_t spin_limit;
+    TaskHandle_t waiters[BARRIER_MAX_PARTIES];
+    uint32_t waiter_count;
+    // statistics, the spin path updates them without the lock
+    uint32_t trips;
+    uint32_t spin_wakeups;
+    uint32_t block_wakeups;
+    uint32_t timeouts;
+} barrier_t;
+
+// spin_limit = 0 always blocks; it is forced to 0 on single-core builds
+void barrier_init(barrier_t *b, uint32_t spin_limit);
+
+// Add/remove a participant. Leaving can complete the current round.
+// Both return the new party count.
+uint32_t barrier_register(barrier_t *b);
+uint32_t barrier_deregister(barrier_t *b);
+
+// Wait for all parties. Returns the generation that was completed,
+// or BARRIER_TIMEOUT if the round did not finish in time.
+uint32_t barrier_wait(barrier_t *b, TickType_t timeout);
+
+#endif
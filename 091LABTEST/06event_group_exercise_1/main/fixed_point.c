@@ -0,0 +1,34 @@
+#include "fixed_point.h"
+
+void fx_ema_init(fx_ema_t *f, fx_t alpha) {
+    f->alpha = alpha;
+    f->y = 0;
+    f->primed = false;
+}
+
+fx_t fx_ema_update(fx_ema_t *f, fx_t x) {
+    if (!f->primed) {
+        f->y = x;
+        f->primed = true;
+    } else {
+        f->y = fx_add(f->y, fx_mul(f->alpha, fx_sub(x, f->y)));
+    }
+    return f->y;
+}
+
+void fx_avg_reset(fx_avg_t *a) {
+    a->sum = 0;
+    a->count = 0;
+}
+
+void fx_avg_add(fx_avg_t *a, fx_t x) {
+    a->sum += x;
+    a->count++;
+}
+
+fx_t fx_avg_mean(const fx_avg_t *a) {
+    if (a->count == 0)
+        return 0;
+    int64_t half = (a->sum >= 0 ? 1 : -1) * (int64_t)(a->count / 2);
+    return fx_saturate((a->sum + half) / a->count);
+}
@@ -0,0 +1,79 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ================ Q16.16 FIXED POINT ================
+// Signed 32-bit values with 16 fraction bits: range about ±32768 with a
+// resolution of 1.5e-5. All arithmetic saturates instead of wrapping and
+// needs no FPU, so it is safe in ISRs and on cores without hardware float.
+
+typedef int32_t fx_t;
+
+#define FX_FRAC_BITS 16
+#define FX_ONE       ((fx_t)1 << FX_FRAC_BITS)
+#define FX_MAX       INT32_MAX
+#define FX_MIN       INT32_MIN
+
+// Compile-time constant from a literal, e.g. FX_CONST(40.0)
+#define FX_CONST(x)  ((fx_t)((x) * FX_ONE + ((x) >= 0 ? 0.5 : -0.5)))
+
+static inline fx_t fx_saturate(int64_t v) {
+    if (v > FX_MAX) return FX_MAX;
+    if (v < FX_MIN) return FX_MIN;
+    return (fx_t)v;
+}
+
+static inline fx_t fx_from_int(int32_t i)        { return fx_saturate((int64_t)i << FX_FRAC_BITS); }
+static inline int32_t fx_to_int(fx_t a)          { return a >> FX_FRAC_BITS; } // floor
+static inline float fx_to_float(fx_t a)          { return (float)a / FX_ONE; }
+static inline fx_t fx_from_float(float f)        { return fx_saturate((int64_t)(f * FX_ONE + (f >= 0 ? 0.5f : -0.5f))); }
+
+// num/den as Q16.16 with round-to-nearest, e.g. millivolts to volts
+static inline fx_t fx_from_ratio(int32_t num, int32_t den) {
+    int64_t n = (int64_t)num << FX_FRAC_BITS;
+    int64_t half = (den > 0) == (n >= 0) ? den / 2 : -den / 2;
+    return fx_saturate((n + half) / den);
+}
+
+static inline fx_t fx_add(fx_t a, fx_t b)        { return fx_saturate((int64_t)a + b); }
+static inline fx_t fx_sub(fx_t a, fx_t b)        { return fx_saturate((int64_t)a - b); }
+static inline fx_t fx_abs(fx_t a)                { return a == FX_MIN ? FX_MAX : (a < 0 ? -a : a); }
+
+static inline fx_t fx_mul(fx_t a, fx_t b) {
+    int64_t p = (int64_t)a * b;
+    return fx_saturate((p + (1 << (FX_FRAC_BITS - 1))) >> FX_FRAC_BITS);
+}
+
+static inline fx_t fx_div(fx_t a, fx_t b) {
+    if (b == 0)
+        return a >= 0 ? FX_MAX : FX_MIN;
+    return fx_saturate(((int64_t)a << FX_FRAC_BITS) / b);
+}
+
+static inline fx_t fx_div_int(fx_t a, int32_t d) { return d ? a / d : (a >= 0 ? FX_MAX : FX_MIN); }
+
+// ================ FILTERS ================
+
+// Exponential moving average, y += alpha * (x - y)
+typedef struct {
+    fx_t alpha;
+    fx_t y;
+    bool primed;
+} fx_ema_t;
+
+// Block average with a 64-bit accumulator, never overflows for < 2^31 samples
+typedef struct {
+    int64_t sum;
+    uint32_t count;
+} fx_avg_t;
+
+void fx_ema_init(fx_ema_t *f, fx_t alpha);
+fx_t fx_ema_update(fx_ema_t *f, fx_t x);
+
+void fx_avg_reset(fx_avg_t *a);
+void fx_avg_add(fx_avg_t *a, fx_t x);
+fx_t fx_avg_mean(const fx_avg_t *a);
+
+#endif
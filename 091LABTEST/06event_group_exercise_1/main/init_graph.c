@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "init_graph.h"
+
+static const char *TAG = "INIT_GRAPH";
+
+#define STOP_WORKER (-1)
+
+static uint32_t all_steps_mask(const init_graph_t *g) {
+    return (g->count == 32) ? 0xFFFFFFFFu : ((1u << g->count) - 1);
+}
+
+// Kahn's algorithm: fills g->order, fails on a cycle
+static bool topological_sort(init_graph_t *g) {
+    uint32_t placed = 0;
+    int n = 0;
+
+    while (n < g->count) {
+        bool progress = false;
+        for (int i = 0; i < g->count; i++) {
+            uint32_t bit = INIT_DEP(i);
+            if ((placed & bit) == 0 && (g->steps[i].deps & ~placed) == 0) {
+                g->order[n++] = i;
+                placed |= bit;
+                progress = true;
+            }
+        }
+        if (!progress)
+            return false;
+    }
+    return true;
+}
+
+// Caller holds g->lock
+static void enqueue_ready(init_graph_t *g) {
+    for (int i = 0; i < g->count; i++) {
+        uint32_t bit = INIT_DEP(i);
+        if ((g->queued & bit) == 0 && (g->steps[i].deps & ~g->completed) == 0) {
+            g->queued |= bit;
+            g->ready_us[i] = esp_timer_get_time() - g->t0;
+            xQueueSend(g->ready_queue, &i, 0); // sized for every step, never full
+        }
+    }
+}
+
+static void init_worker_task(void *param) {
+    init_graph_t *g = (init_graph_t *)param;
+    int index;
+
+    while (xQueueReceive(g->ready_queue, &index, portMAX_DELAY) == pdTRUE) {
+        if (index == STOP_WORKER)
+            break;
+
+        const init_step_t *step = &g->steps[index];
+        g->start_us[index] = esp_timer_get_time() - g->t0;
+        step->fn(step->arg);
+        g->end_us[index] = esp_timer_get_time() - g->t0;
+
+        xSemaphoreTake(g->lock, portMAX_DELAY);
+        g->completed |= INIT_DEP(index);
+        enqueue_ready(g);
+        bool all_done = (g->completed == all_steps_mask(g));
+        xSemaphoreGive(g->lock);
+
+        xEventGroupSetBits(g->done_bits, INIT_DEP(index));
+
+        if (all_done) {
+            int stop = STOP_WORKER;
+            for (int i = 0; i < g->workers; i++)
+                xQueueSend(g->ready_queue, &stop, 0);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+// Frees whatever init_graph_run() created before it failed
+static void teardown(init_graph_t *g) {
+    if (g->done_bits)
+        vEventGroupDelete(g->done_bits);
+    if (g->ready_queue)
+        vQueueDelete(g->ready_queue);
+    if (g->lock)
+        vSemaphoreDelete(g->lock);
+    g->done_bits = NULL;
+    g->ready_queue = NULL;
+    g->lock = NULL;
+}
+
+esp_err_t init_graph_run(init_graph_t *g, const init_step_t *steps, int count,
+                         int workers, UBaseType_t priority) {
+    if (count <= 0 || count > INIT_GRAPH_MAX_STEPS || workers <= 0)
+        return ESP_ERR_INVALID_ARG;
+    if (workers > INIT_GRAPH_MAX_WORKERS)
+        workers = INIT_GRAPH_MAX_WORKERS;
+
+    memset(g, 0, sizeof(*g));
+    g->steps = steps;
+    g->count = count;
+    g->workers = workers;
+
+    for (int i = 0; i < count; i++) {
+        if (steps[i].deps & ~all_steps_mask(g) || steps[i].deps & INIT_DEP(i)) {
+            ESP_LOGE(TAG, "Step %s has invalid dependencies 0x%06lx", steps[i].name, steps[i].deps);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (!topological_sort(g)) {
+        ESP_LOGE(TAG, "Dependency cycle in init graph");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    g->done_bits = xEventGroupCreate();
+    g->ready_queue = xQueueCreate(count + workers, sizeof(int));
+    g->lock = xSemaphoreCreateMutex();
+    if (!g->done_bits || !g->ready_queue || !g->lock) {
+        teardown(g);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Workers first, while the queue is empty: if one cannot be created,
+    // the others are still blocked on the queue and can be deleted safely
+    TaskHandle_t started[INIT_GRAPH_MAX_WORKERS];
+    for (int i = 0; i < workers; i++) {
+        if (xTaskCreate(init_worker_task, "InitWorker", INIT_GRAPH_WORKER_STACK, g, priority,
+                        &started[i]) != pdPASS) {
+            ESP_LOGE(TAG, "Could not create init worker %d of %d", i + 1, workers);
+            while (i-- > 0)
+                vTaskDelete(started[i]);
+            teardown(g);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    g->t0 = esp_timer_get_time();
+    xSemaphoreTake(g->lock, portMAX_DELAY);
+    enqueue_ready(g);
+    xSemaphoreGive(g->lock);
+
+    ESP_LOGI(TAG, "Running %d init steps on %d workers", count, workers);
+    return ESP_OK;
+}
+
+bool init_graph_wait(init_graph_t *g, TickType_t timeout) {
+    uint32_t all = all_steps_mask(g);
+    EventBits_t bits = xEventGroupWaitBits(g->done_bits, all, pdFALSE, pdTRUE, timeout);
+    return (bits & all) == all;
+}
+
+void init_graph_report(const init_graph_t *g) {
+    int64_t finish[INIT_GRAPH_MAX_STEPS];
+    int prev[INIT_GRAPH_MAX_STEPS];
+    int64_t serial_us = 0;
+    int64_t ready_us = 0;
+
+    ESP_LOGI(TAG, "---- Init step timing (ms) ----");
+    for (int i = 0; i < g->count; i++) {
+        int64_t duration = g->end_us[i] - g->start_us[i];
+        serial_us += duration;
+        if (g->end_us[i] > ready_us)
+            ready_us = g->end_us[i];
+        ESP_LOGI(TAG, "%-10s start=%5lld dur=%5lld queued=%4lld",
+                 g->steps[i].name, g->start_us[i] / 1000, duration / 1000,
+                 (g->start_us[i] - g->ready_us[i]) / 1000);
+    }
+
+    // Longest chain of measured durations through the dependency graph
+    int last = g->order[0];
+    for (int n = 0; n < g->count; n++) {
+        int i = g->order[n];
+        int64_t best = 0;
+        prev[i] = -1;
+        for (int d = 0; d < g->count; d++) {
+            if ((g->steps[i].deps & INIT_DEP(d)) && finish[d] > best) {
+                best = finish[d];
+                prev[i] = d;
+            }
+        }
+        finish[i] = best + (g->end_us[i] - g->start_us[i]);
+        if (finish[i] > finish[last])
+            last = i;
+    }
+
+    int chain[INIT_GRAPH_MAX_STEPS];
+    int hops = 0;
+    int slowest = last;
+    for (int i = last; i >= 0; i = prev[i]) {
+        chain[hops++] = i;
+        if (g->end_us[i] - g->start_us[i] > g->end_us[slowest] - g->start_us[slowest])
+            slowest = i;
+    }
+
+    char path[160] = "";
+    size_t len = 0;
+    for (int h = hops - 1; h >= 0 && len < sizeof(path); h--) {
+        len += snprintf(path + len, sizeof(path) - len, (h > 0) ? "%s -> " : "%s",
+                        g->steps[chain[h]].name);
+    }
+
+    ESP_LOGI(TAG, "Critical path: %s (%lld ms)", path, finish[last] / 1000);
+    ESP_LOGI(TAG, "Boot-to-ready: %lld ms, serial sum: %lld ms, speedup x%.2f",
+             ready_us / 1000, serial_us / 1000,
+             ready_us > 0 ? (float)serial_us / ready_us : 0.0f);
+    ESP_LOGI(TAG, "Optimize first: %s", g->steps[slowest].name);
+}
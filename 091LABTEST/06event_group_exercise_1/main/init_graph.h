@@ -0,0 +1,60 @@
+#ifndef INIT_GRAPH_H
+#define INIT_GRAPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+
+// ============================ INIT GRAPH ============================
+// Declarative startup: each step lists the steps it depends on as a bitmask
+// of step indices. Steps whose dependencies are complete are handed to a
+// bounded pool of worker tasks, so independent steps run concurrently.
+// Each finished step also sets its bit in done_bits, so other tasks can keep
+// waiting on startup progress with xEventGroupWaitBits.
+
+#define INIT_GRAPH_MAX_STEPS   24   // one event-group bit per step
+#define INIT_GRAPH_MAX_WORKERS 4
+#define INIT_GRAPH_WORKER_STACK 3072
+#define INIT_DEP(i) (1u << (i))
+
+typedef void (*init_step_fn_t)(void *arg);
+
+typedef struct {
+    const char *name;
+    init_step_fn_t fn;
+    void *arg;
+    uint32_t deps;          // INIT_DEP(a) | INIT_DEP(b) ...
+} init_step_t;
+
+typedef struct {
+    const init_step_t *steps;
+    int count;
+    int workers;
+    EventGroupHandle_t done_bits;
+    QueueHandle_t ready_queue;
+    SemaphoreHandle_t lock;
+    uint32_t queued;
+    uint32_t completed;
+    int order[INIT_GRAPH_MAX_STEPS];        // topological order
+    int64_t t0;
+    int64_t ready_us[INIT_GRAPH_MAX_STEPS]; // relative to t0
+    int64_t start_us[INIT_GRAPH_MAX_STEPS];
+    int64_t end_us[INIT_GRAPH_MAX_STEPS];
+} init_graph_t;
+
+// Validate the graph (bad indices, cycles) and start running it.
+// Returns immediately; use init_graph_wait() to block until done.
+esp_err_t init_graph_run(init_graph_t *g, const init_step_t *steps, int count,
+                         int workers, UBaseType_t priority);
+
+// Wait until every step has finished
+bool init_graph_wait(init_graph_t *g, TickType_t timeout);
+
+// Per-step timing, critical path and the step worth optimizing
+void init_graph_report(const init_graph_t *g);
+
+#endif
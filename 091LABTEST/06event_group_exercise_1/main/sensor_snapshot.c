@@ -0,0 +1,43 @@
+#include <string.h>
+#include "esp_timer.h"
+#include "sensor_snapshot.h"
+
+void sensor_store_init(sensor_store_t *store) {
+    memset(store, 0, sizeof(*store));
+    seqlock_init(&store->lock);
+}
+
+void sensor_store_publish(sensor_store_t *store, sensor_field_t field, sensor_value_t value) {
+    int64_t now = esp_timer_get_time(); // outside the critical section
+
+    seqlock_write_begin(&store->lock);
+    store->data.value[field] = value;
+    store->data.field_gen[field]++;
+    store->data.updated_us[field] = now;
+    store->data.generation++;
+    seqlock_write_end(&store->lock);
+}
+
+uint32_t sensor_store_read(sensor_store_t *store, sensor_snapshot_t *out) {
+    uint32_t seq;
+    do {
+        seq = seqlock_read_begin(&store->lock);
+        memcpy(out, &store->data, sizeof(*out));
+        if (!seqlock_read_retry(&store->lock, seq))
+            break;
+        store->read_retries++;
+    } while (1);
+    return out->generation;
+}
+
+uint32_t sensor_snapshot_stale_mask(const sensor_snapshot_t *snap,
+                                    const uint32_t max_age_ms[SENSOR_FIELD_COUNT],
+                                    int64_t now_us) {
+    uint32_t mask = 0;
+    for (int i = 0; i < SENSOR_FIELD_COUNT; i++) {
+        if (snap->field_gen[i] == 0 ||
+            now_us - snap->updated_us[i] > (int64_t)max_age_ms[i] * 1000)
+            mask |= 1u << i;
+    }
+    return mask;
+}
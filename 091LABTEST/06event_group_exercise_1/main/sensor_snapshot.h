@@ -0,0 +1,47 @@
+#ifndef SENSOR_SNAPSHOT_H
+#define SENSOR_SNAPSHOT_H
+
+#include <stdint.h>
+#include "seqlock.h"
+#include "sensor_value.h"
+
+// ============================ SENSOR SNAPSHOT ============================
+// Shared sensor readings behind a seqlock. Each sensor task publishes its
+// own field. Readers get every field from the same instant, plus a global
+// generation and per-field update time for staleness checks. Values are
+// float or Q16.16, as selected by SENSOR_FIXED_POINT (sensor_value.h).
+
+typedef enum {
+    SENSOR_TEMP,
+    SENSOR_HUM,
+    SENSOR_PRES,
+    SENSOR_FIELD_COUNT
+} sensor_field_t;
+
+typedef struct {
+    uint32_t generation;                      // publishes since boot
+    sensor_value_t value[SENSOR_FIELD_COUNT];
+    uint32_t field_gen[SENSOR_FIELD_COUNT];   // publishes of each field
+    int64_t updated_us[SENSOR_FIELD_COUNT];   // esp_timer time of last publish
+} sensor_snapshot_t;
+
+typedef struct {
+    seqlock_t lock;
+    sensor_snapshot_t data;
+    volatile uint32_t read_retries;
+} sensor_store_t;
+
+void sensor_store_init(sensor_store_t *store);
+
+// Writer side: never blocks readers
+void sensor_store_publish(sensor_store_t *store, sensor_field_t field, sensor_value_t value);
+
+// Reader side: consistent copy of all fields, returns its generation
+uint32_t sensor_store_read(sensor_store_t *store, sensor_snapshot_t *out);
+
+// Bit i set if field i was never published or is older than max_age_ms[i]
+uint32_t sensor_snapshot_stale_mask(const sensor_snapshot_t *snap,
+                                    const uint32_t max_age_ms[SENSOR_FIELD_COUNT],
+                                    int64_t now_us);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ============================ SEQLOCK ============================
+// Sequence lock: the counter is odd while a write is in progress. Readers
+// never block; they copy the data and retry if the counter moved. Writers
+// are serialized by a spinlock and run inside a critical section, so a
+// write can't be preempted halfway and leave readers retrying.
+
+typedef struct {
+    volatile uint32_t seq;
+    portMUX_TYPE writer;
+} seqlock_t;
+
+static inline void seqlock_init(seqlock_t *s) {
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    s->seq = 0;
+    s->writer = unlocked;
+}
+
+static inline void seqlock_write_begin(seqlock_t *s) {
+    taskENTER_CRITICAL(&s->writer);
+    __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void seqlock_write_end(seqlock_t *s) {
+    __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELEASE);
+    taskEXIT_CRITICAL(&s->writer);
+}
+
+// Spin until no write is in progress, return the sequence to validate against
+static inline uint32_t seqlock_read_begin(const seqlock_t *s) {
+    uint32_t seq;
+    while ((seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE)) & 1) {
+    }
+    return seq;
+}
+
+// True if a writer ran since seqlock_read_begin() and the copy must be redone
+static inline bool seqlock_read_retry(const seqlock_t *s, uint32_t seq) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&s->seq, __ATOMIC_RELAXED) != seq;
+}
+
+#endif
@@ -7,9 +7,14 @@
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
+#include "isr_latency.h"
+#include "fast_signal.h"
+#include "task_supervisor.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "esp_task_wdt.h"
 #include "driver/gpio.h"
 #include "driver/gptimer.h"
+#endif
 
 static const char *TAG = "ESP32_ADVANCED";
 
@@ -73,20 +78,21 @@ void exercise2(void) {
 
 // ============================= EXERCISE 3 =============================
 // Peripheral Integration (Timer + GPIO)
+#if !CONFIG_IDF_TARGET_LINUX
 #define LED_GPIO GPIO_NUM_2
 
-SemaphoreHandle_t timer_sem;
+fsig_t timer_sig;  // only led_task waits, so this is a task notification
 
 bool IRAM_ATTR timer_callback(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_data) {
     BaseType_t hpTaskWoken = pdFALSE;
-    xSemaphoreGiveFromISR(timer_sem, &hpTaskWoken);
+    fsig_give_from_isr(user_data, &hpTaskWoken);
     return hpTaskWoken == pdTRUE;
 }
 
 void led_task(void *p) {
     bool state = false;
     while (1) {
-        if (xSemaphoreTake(timer_sem, portMAX_DELAY)) {
+        if (fsig_wait(&timer_sig, portMAX_DELAY)) {
             state = !state;
             gpio_set_level(LED_GPIO, state);
             ESP_LOGI(TAG, "LED %s (Core %d)", state ? "ON" : "OFF", xPortGetCoreID());
@@ -99,7 +105,7 @@ void exercise3(void) {
     gpio_reset_pin(LED_GPIO);
     gpio_set_direction(LED_GPIO, GPIO_MODE_OUTPUT);
 
-    timer_sem = xSemaphoreCreateBinary();
+    fsig_create(&timer_sig, 1, 0);
     gptimer_handle_t gptimer;
     gptimer_config_t cfg = {
         .clk_src = GPTIMER_CLK_SRC_DEFAULT,
@@ -116,13 +122,18 @@ void exercise3(void) {
     gptimer_set_alarm_action(gptimer, &alarm);
 
     gptimer_event_callbacks_t cb = {.on_alarm = timer_callback};
-    gptimer_register_event_callbacks(gptimer, &cb, timer_sem);
+    gptimer_register_event_callbacks(gptimer, &cb, &timer_sig);
     gptimer_enable(gptimer);
     gptimer_start(gptimer);
 
     xTaskCreatePinnedToCore(led_task, "LEDTask", 2048, NULL, 10, NULL, 0);
     print_system_info("Hardware timer active");
 }
+#else
+void exercise3(void) {
+    ESP_LOGW(TAG, "Exercise 3 needs the gptimer and GPIO drivers (not on the Linux host)");
+}
+#endif
 
 // ============================= EXERCISE 4 =============================
 // Performance Optimization and Monitoring
@@ -158,18 +169,176 @@ void exercise4(void) {
     print_system_info("Performance monitoring active");
 }
 
+// ============================= EXERCISE 5 =============================
+// ISR-to-Task Wake Latency (semaphore vs notification vs stream buffer vs queue)
+void exercise5(void) {
+    ESP_LOGI(TAG, "===== Exercise 5: ISR-to-Task Latency =====");
+    lat_run_all();
+    print_system_info("Latency harness running");
+}
+
+// ============================= EXERCISE 6 =============================
+// Signal Cost: task notification vs binary semaphore behind the same fsig API
+#define SIG_ROUNDS    2000
+#define SIG_RAM_COUNT 16
+
+typedef struct {
+    fsig_t ping;
+    fsig_t pong;
+} sig_pair_t;
+
+void sig_echo_task(void *p) {
+    sig_pair_t *pair = p;
+    for (int i = 0; i < SIG_ROUNDS; i++) {
+        fsig_wait(&pair->ping, portMAX_DELAY);
+        fsig_give(&pair->pong);
+    }
+    vTaskDelete(NULL);
+}
+
+// One-way wake time: this task and a higher-priority echo task on the same
+// core bounce a signal back and forth, so every give is a direct switch
+static uint32_t sig_handoff_ns(int waiters) {
+    sig_pair_t pair;
+    fsig_create(&pair.ping, waiters, 0);
+    fsig_create(&pair.pong, waiters, 0);
+    xTaskCreatePinnedToCore(sig_echo_task, "SigEcho", 2048, &pair,
+                            uxTaskPriorityGet(NULL) + 1, NULL, xPortGetCoreID());
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < SIG_ROUNDS; i++) {
+        fsig_give(&pair.ping);
+        fsig_wait(&pair.pong, portMAX_DELAY);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    fsig_delete(&pair.ping);
+    fsig_delete(&pair.pong);
+    return (uint32_t)(elapsed * 1000 / (2 * SIG_ROUNDS));
+}
+
+// Heap actually consumed per signal, allocator overhead included
+static int sig_heap_bytes(int waiters) {
+    static fsig_t sigs[SIG_RAM_COUNT];
+    int before = esp_get_free_heap_size();
+    for (int i = 0; i < SIG_RAM_COUNT; i++)
+        fsig_create(&sigs[i], waiters, 0);
+    int used = before - (int)esp_get_free_heap_size();
+    for (int i = 0; i < SIG_RAM_COUNT; i++)
+        fsig_delete(&sigs[i]);
+    return used / SIG_RAM_COUNT;
+}
+
+void sig_bench_task(void *p) {
+    const int waiters[] = {1, 2};  // 1 -> notification, 2 -> semaphore fallback
+
+    ESP_LOGI(TAG, "%-10s %12s %12s %12s", "mode", "handoff ns", "kernel B", "heap B");
+    for (int i = 0; i < 2; i++) {
+        fsig_t probe;
+        fsig_create(&probe, waiters[i], 0);
+        ESP_LOGI(TAG, "%-10s %12lu %12u %12d", fsig_mode_name(&probe),
+                 sig_handoff_ns(waiters[i]), (unsigned)fsig_kernel_bytes(&probe), sig_heap_bytes(waiters[i]));
+        fsig_delete(&probe);
+    }
+    ESP_LOGI(TAG, "fsig_t itself: %u bytes in either mode", (unsigned)sizeof(fsig_t));
+    vTaskDelete(NULL);
+}
+
+void exercise6(void) {
+    ESP_LOGI(TAG, "===== Exercise 6: Notification vs Semaphore Signal =====");
+    xTaskCreatePinnedToCore(sig_bench_task, "SigBench", 3072, NULL, 10, NULL, 0);
+    print_system_info("Signal benchmark running");
+}
+
+// ============================= EXERCISE 7 =============================
+// Task Supervision: per-task check-ins, one supervisor, escalation chain.
+// Worker1 hangs once (a task restart fixes it); Worker2 is stalled by a
+// pipeline fault that only a subsystem restart clears.
+#define SUP_WORKERS       3
+#define SUP_CHECKIN_MS    200
+#define SUP_DEADLINE_MS   500
+
+static const char *worker_names[SUP_WORKERS] = {"Worker0", "Worker1", "Worker2"};
+static int worker_slots[SUP_WORKERS];
+static volatile bool pipeline_fault = false;
+
+void supervised_worker(void *p) {
+    int id = (int)p;
+    int rounds = 0;
+    while (1) {
+        if (id == 1 && ++rounds == 25) {
+            static bool hung = false;
+            if (!hung) {
+                hung = true;
+                ESP_LOGW(TAG, "🐛 Worker1 hangs");
+                vTaskDelay(portMAX_DELAY);
+            }
+        }
+        if (!(id == 2 && pipeline_fault))
+            sup_checkin(worker_slots[id]);
+        vTaskDelay(pdMS_TO_TICKS(SUP_CHECKIN_MS));
+    }
+}
+
+TaskHandle_t spawn_worker(int slot, void *arg) {
+    int id = (int)arg;
+    TaskHandle_t task = NULL;
+    xTaskCreatePinnedToCore(supervised_worker, worker_names[id], 2048, arg, 5, &task, id % 2);
+    return task;
+}
+
+void pipeline_reinit(void *arg) {
+    pipeline_fault = false;
+}
+
+void supervision_report_task(void *p) {
+    vTaskDelay(pdMS_TO_TICKS(8000));
+    ESP_LOGW(TAG, "🐛 Pipeline fault injected");
+    pipeline_fault = true;
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(5000));
+        sup_report();
+    }
+}
+
+void exercise7(void) {
+    ESP_LOGI(TAG, "===== Exercise 7: Task Supervision =====");
+#if !CONFIG_IDF_TARGET_LINUX
+    // The hardware task WDT watches the supervisor itself
+    esp_task_wdt_config_t wdt = {
+        .timeout_ms = 3000,
+        .idle_core_mask = 0,
+        .trigger_panic = false,
+    };
+    if (esp_task_wdt_init(&wdt) != ESP_OK)
+        esp_task_wdt_reconfigure(&wdt);  // already running from sdkconfig
+#endif
+    int pipeline = sup_add_subsystem("pipeline", pipeline_reinit, NULL);
+    for (int i = 0; i < SUP_WORKERS; i++) {
+        worker_slots[i] = sup_register(worker_names[i], NULL,
+                                       SUP_DEADLINE_MS, i == 2 ? pipeline : -1, spawn_worker, (void*)i);
+        sup_attach(worker_slots[i], spawn_worker(worker_slots[i], (void*)i));
+    }
+    sup_init(SUP_CHECKIN_MS, 15, false);
+    xTaskCreate(supervision_report_task, "SupReport", 3072, NULL, 4, NULL);
+    print_system_info("Supervisor running");
+}
+
 // ============================= MAIN =============================
 void app_main(void) {
     ESP_LOGI(TAG, "===== ESP32 FreeRTOS Advanced Exercises =====");
     print_system_info("System Boot");
 
-    int mode = 4; // 🔧 1–4: เปลี่ยนโหมดได้ตามต้องการ
+    int mode = 4; // 🔧 1–7: เปลี่ยนโหมดได้ตามต้องการ
 
     switch (mode) {
         case 1: exercise1(); break;
         case 2: exercise2(); break;
         case 3: exercise3(); break;
         case 4: exercise4(); break;
+        case 5: exercise5(); break;
+        case 6: exercise6(); break;
+        case 7: exercise7(); break;
         default: ESP_LOGW(TAG, "Invalid mode");
     }
 }
@@ -0,0 +1,398 @@
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/stream_buffer.h"
+#include "esp_log.h"
+#include "isr_latency.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#define IRAM_ATTR
+#define LAT_RUN_SAMPLES 200         // 1 alarm per tick on the host
+#define LAT_SOURCE_NAME "simulated timer, 1 alarm per tick"
+#else
+#include "esp_attr.h"
+#include "esp_rom_sys.h"
+#include "driver/gptimer.h"
+#define LAT_RUN_SAMPLES LAT_SAMPLES
+#define LAT_SOURCE_NAME "gptimer"
+#endif
+
+static const char *TAG = "ISR_LATENCY";
+
+#define LAT_PERIOD_TICKS   (LAT_PERIOD_US * (LAT_TICK_HZ / 1000000))
+#define LAT_WAITER_PRIO    (configMAX_PRIORITIES - 2)
+#define LAT_HARNESS_PRIO   (configMAX_PRIORITIES - 3)
+#define LAT_CRIT_HOLD_US   20
+
+// State shared between the alarm ISR and the waiter
+static struct {
+    volatile bool armed;
+    lat_mechanism_t mech;
+    TaskHandle_t waiter;
+    TaskHandle_t controller;
+    SemaphoreHandle_t sem;
+    StreamBufferHandle_t stream;
+    QueueHandle_t queue;
+    volatile uint32_t entry;
+    volatile uint32_t give;
+    volatile bool pending;
+    volatile uint32_t overruns;
+} lat;
+
+static volatile bool load_running;
+
+// ============================= TIME SOURCE =============================
+
+#if CONFIG_IDF_TARGET_LINUX
+
+static volatile bool sim_running;
+static volatile uint64_t sim_alarm_ticks;
+
+static uint64_t mono_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * LAT_TICK_HZ + ts.tv_nsec / (1000000000 / LAT_TICK_HZ);
+}
+
+static inline uint32_t lat_now(void) {
+    return (uint32_t)(mono_ticks() - sim_alarm_ticks);
+}
+
+static void spin_us(uint32_t us) {
+    uint64_t end = mono_ticks() + (uint64_t)us * (LAT_TICK_HZ / 1000000);
+    while (mono_ticks() < end) {
+    }
+}
+
+#else
+
+static gptimer_handle_t lat_timer;
+
+// Counter reloads to 0 on every alarm, so this is "ticks since the alarm"
+static inline uint32_t IRAM_ATTR lat_now(void) {
+    uint64_t v = 0;
+    gptimer_get_raw_count(lat_timer, &v);
+    return (uint32_t)v;
+}
+
+static void spin_us(uint32_t us) {
+    esp_rom_delay_us(us);
+}
+
+#endif
+
+// ============================= ALARM PATH =============================
+
+static bool IRAM_ATTR lat_on_alarm(void) {
+    uint32_t entry = lat_now();
+    BaseType_t woken = pdFALSE;
+
+    if (!lat.armed)
+        return false;
+    if (lat.pending)
+        lat.overruns++;
+
+    switch (lat.mech) {
+        case LAT_SEMAPHORE:
+            xSemaphoreGiveFromISR(lat.sem, &woken);
+            break;
+        case LAT_NOTIFY:
+            vTaskNotifyGiveFromISR(lat.waiter, &woken);
+            break;
+        case LAT_STREAM_BUFFER:
+            xStreamBufferSendFromISR(lat.stream, &entry, sizeof(entry), &woken);
+            break;
+        default:
+            xQueueSendFromISR(lat.queue, &entry, &woken);
+            break;
+    }
+
+    // Same core as the waiter, so these land before it can resume
+    lat.give = lat_now();
+    lat.entry = entry;
+    lat.pending = true;
+    return woken == pdTRUE;
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+
+// Stands in for the timer interrupt: top priority, released every tick
+static void sim_timer_task(void *pv) {
+    TickType_t last = xTaskGetTickCount();
+    while (sim_running) {
+        vTaskDelayUntil(&last, 1);
+        sim_alarm_ticks = mono_ticks();
+        if (lat_on_alarm())
+            taskYIELD();
+    }
+    vTaskDelete(NULL);
+}
+
+static bool lat_timer_start(void) {
+    sim_running = true;
+    return xTaskCreatePinnedToCore(sim_timer_task, "LatSimTimer", 2048, NULL,
+                                   configMAX_PRIORITIES - 1, NULL, xPortGetCoreID()) == pdPASS;
+}
+
+static void lat_timer_stop(void) {
+    sim_running = false;
+    vTaskDelay(2);
+}
+
+#else
+
+static bool IRAM_ATTR lat_gptimer_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    return lat_on_alarm();
+}
+
+// The interrupt is allocated on the calling core
+static bool lat_timer_start(void) {
+    gptimer_config_t cfg = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = LAT_TICK_HZ,
+    };
+    if (gptimer_new_timer(&cfg, &lat_timer) != ESP_OK)
+        return false;
+
+    gptimer_alarm_config_t alarm = {
+        .reload_count = 0,
+        .alarm_count = LAT_PERIOD_TICKS,
+        .flags.auto_reload_on_alarm = true,
+    };
+    gptimer_set_alarm_action(lat_timer, &alarm);
+
+    gptimer_event_callbacks_t cb = {.on_alarm = lat_gptimer_cb};
+    gptimer_register_event_callbacks(lat_timer, &cb, NULL);
+    gptimer_enable(lat_timer);
+    return gptimer_start(lat_timer) == ESP_OK;
+}
+
+static void lat_timer_stop(void) {
+    gptimer_stop(lat_timer);
+    gptimer_disable(lat_timer);
+    gptimer_del_timer(lat_timer);
+    lat_timer = NULL;
+}
+
+#endif
+
+// ============================= DISTRIBUTIONS =============================
+
+static void dist_add(lat_dist_t *d, uint32_t ticks) {
+    int b = ticks ? 32 - __builtin_clz(ticks) : 0;
+    d->count++;
+    if (ticks > d->max)
+        d->max = ticks;
+    d->hist[b < LAT_HIST_BUCKETS ? b : LAT_HIST_BUCKETS - 1]++;
+}
+
+float lat_dist_percentile_us(const lat_dist_t *d, uint32_t permille) {
+    if (d->count == 0)
+        return 0;
+    uint32_t target = (uint32_t)(((uint64_t)d->count * permille + 999) / 1000);
+    uint32_t seen = 0;
+    for (int i = 0; i < LAT_HIST_BUCKETS; i++) {
+        seen += d->hist[i];
+        if (seen >= target)
+            return (float)(1u << i) * 1000000.0f / LAT_TICK_HZ;
+    }
+    return (float)(1u << (LAT_HIST_BUCKETS - 1)) * 1000000.0f / LAT_TICK_HZ;
+}
+
+static float ticks_us(uint32_t t) {
+    return (float)t * 1000000.0f / LAT_TICK_HZ;
+}
+
+// ============================= WAITER / LOAD =============================
+
+static void lat_waiter_task(void *pv) {
+    lat_result_t *r = pv;
+    uint32_t payload;
+
+    while (r->samples < LAT_RUN_SAMPLES) {
+        bool got;
+        switch (lat.mech) {
+            case LAT_SEMAPHORE:
+                got = xSemaphoreTake(lat.sem, portMAX_DELAY) == pdTRUE;
+                break;
+            case LAT_NOTIFY:
+                got = ulTaskNotifyTake(pdTRUE, portMAX_DELAY) > 0;
+                break;
+            case LAT_STREAM_BUFFER:
+                got = xStreamBufferReceive(lat.stream, &payload, sizeof(payload), portMAX_DELAY) == sizeof(payload);
+                break;
+            default:
+                got = xQueueReceive(lat.queue, &payload, portMAX_DELAY) == pdTRUE;
+                break;
+        }
+        uint32_t resume = lat_now();
+        if (!got)
+            continue;
+
+        uint32_t entry = lat.entry, give = lat.give;
+        lat.pending = false;
+#if !CONFIG_IDF_TARGET_LINUX
+        if (resume < give)
+            resume += LAT_PERIOD_TICKS;  // counter reloaded before we ran
+#endif
+        dist_add(&r->entry, entry);
+        dist_add(&r->isr, give - entry);
+        dist_add(&r->wake, resume - give);
+        dist_add(&r->total, resume);
+        r->samples++;
+    }
+
+    lat.armed = false;
+    xTaskNotifyGive(lat.controller);
+    vTaskSuspend(NULL);
+}
+
+static void load_task(void *pv) {
+    static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    lat_load_t kind = (lat_load_t)(intptr_t)pv;
+    int iter = 0;
+
+    while (load_running) {
+        if (kind == LAT_LOAD_CRITICAL) {
+            taskENTER_CRITICAL(&mux);
+            spin_us(LAT_CRIT_HOLD_US);
+            taskEXIT_CRITICAL(&mux);
+        } else {
+            volatile float x = 0;
+            for (int i = 0; i < 200; i++)
+                x += sqrtf(i * 3.14f);
+        }
+        // Let IDLE run now and then so the task watchdog stays quiet
+        if (++iter % 256 == 0)
+            vTaskDelay(1);
+    }
+    vTaskDelete(NULL);
+}
+
+static void load_start(lat_load_t load) {
+    if (load == LAT_LOAD_NONE)
+        return;
+    load_running = true;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+        xTaskCreatePinnedToCore(load_task, "LatLoad", 2048, (void *)(intptr_t)load, 1, NULL, core);
+}
+
+static void load_stop(void) {
+    load_running = false;
+    vTaskDelay(pdMS_TO_TICKS(20));
+}
+
+// ============================= HARNESS =============================
+
+const char *lat_mechanism_name(lat_mechanism_t m) {
+    switch (m) {
+        case LAT_SEMAPHORE:     return "semaphore";
+        case LAT_NOTIFY:        return "notify";
+        case LAT_STREAM_BUFFER: return "stream-buf";
+        case LAT_QUEUE:         return "queue";
+        default:                return "?";
+    }
+}
+
+const char *lat_load_name(lat_load_t l) {
+    switch (l) {
+        case LAT_LOAD_NONE:     return "idle";
+        case LAT_LOAD_CPU:      return "cpu";
+        case LAT_LOAD_CRITICAL: return "critical";
+        default:                return "?";
+    }
+}
+
+bool lat_measure(lat_mechanism_t mech, lat_load_t load, lat_result_t *out) {
+    bool ok = false;
+
+    memset(out, 0, sizeof(*out));
+    out->mech = mech;
+    out->load = load;
+
+    memset((void *)&lat, 0, sizeof(lat));
+    lat.mech = mech;
+    lat.controller = xTaskGetCurrentTaskHandle();
+    switch (mech) {
+        case LAT_SEMAPHORE:     lat.sem = xSemaphoreCreateBinary(); break;
+        case LAT_STREAM_BUFFER: lat.stream = xStreamBufferCreate(8 * sizeof(uint32_t), sizeof(uint32_t)); break;
+        case LAT_QUEUE:         lat.queue = xQueueCreate(8, sizeof(uint32_t)); break;
+        default:                break;
+    }
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    if (xTaskCreatePinnedToCore(lat_waiter_task, "LatWaiter", 3072, out, LAT_WAITER_PRIO,
+                                &lat.waiter, xPortGetCoreID()) != pdPASS)
+        goto cleanup;
+
+    load_start(load);
+    lat.armed = true;
+    if (lat_timer_start()) {
+        TickType_t budget = pdMS_TO_TICKS(LAT_RUN_SAMPLES * LAT_PERIOD_US / 1000 * 20 + 1000);
+        ok = ulTaskNotifyTake(pdTRUE, budget) > 0;
+        lat.armed = false;
+        lat_timer_stop();
+    }
+    lat.armed = false;
+    load_stop();
+    vTaskDelete(lat.waiter);
+    out->overruns = lat.overruns;
+
+cleanup:
+    if (lat.sem)
+        vSemaphoreDelete(lat.sem);
+    if (lat.stream)
+        vStreamBufferDelete(lat.stream);
+    if (lat.queue)
+        vQueueDelete(lat.queue);
+    return ok;
+}
+
+static void print_histogram(const lat_dist_t *d) {
+    for (int i = 0; i < LAT_HIST_BUCKETS; i++) {
+        if (d->hist[i] == 0)
+            continue;
+        int bar = (int)(d->hist[i] * 40 / d->count);
+        char bars[41];
+        memset(bars, '#', bar);
+        bars[bar] = '\0';
+        ESP_LOGI(TAG, "      < %8.1f us %5lu %s", ticks_us(1u << i), d->hist[i], bars);
+    }
+}
+
+static void lat_harness_task(void *pv) {
+    static lat_result_t r;
+
+    ESP_LOGI(TAG, "ISR->task latency, %d samples per cell, %d us alarm period (%s), core %d",
+             LAT_RUN_SAMPLES, LAT_PERIOD_US, LAT_SOURCE_NAME, xPortGetCoreID());
+    ESP_LOGI(TAG, "%-10s %-8s | entry p50/p99 | wake p50/p99 | total p50/p99/max (us) | overruns",
+             "mechanism", "load");
+
+    for (int load = 0; load < LAT_LOAD_COUNT; load++) {
+        for (int mech = 0; mech < LAT_MECH_COUNT; mech++) {
+            if (!lat_measure(mech, load, &r)) {
+                ESP_LOGW(TAG, "%-10s %-8s | incomplete (%lu samples)",
+                         lat_mechanism_name(mech), lat_load_name(load), r.samples);
+                continue;
+            }
+            ESP_LOGI(TAG, "%-10s %-8s | %5.1f / %5.1f | %5.1f / %5.1f | %5.1f / %5.1f / %6.1f | %lu",
+                     lat_mechanism_name(mech), lat_load_name(load),
+                     lat_dist_percentile_us(&r.entry, 500), lat_dist_percentile_us(&r.entry, 990),
+                     lat_dist_percentile_us(&r.wake, 500), lat_dist_percentile_us(&r.wake, 990),
+                     lat_dist_percentile_us(&r.total, 500), lat_dist_percentile_us(&r.total, 990),
+                     ticks_us(r.total.max), r.overruns);
+            print_histogram(&r.total);
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+// Harness runs on core 0 so the timer interrupt and waiter share it
+void lat_run_all(void) {
+    xTaskCreatePinnedToCore(lat_harness_task, "LatHarness", 4096, NULL, LAT_HARNESS_PRIO, NULL, 0);
+}
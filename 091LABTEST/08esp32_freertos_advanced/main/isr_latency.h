@@ -0,0 +1,70 @@
+#ifndef ISR_LATENCY_H
+#define ISR_LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+// ============================= ISR LATENCY =============================
+// Measures how long it takes from a timer alarm until the task it wakes is
+// running, split into:
+//   alarm -> ISR entry -> wake call returned -> task resumed
+// All stamps come from the timer counter itself (10 MHz gptimer, reloaded
+// to 0 on every alarm, so a stamp *is* the time since the alarm). The
+// waiter is pinned to the ISR's core, so the ISR always finishes stamping
+// before the task can run.
+//
+// On the Linux host port (CONFIG_IDF_TARGET_LINUX) the alarm comes from a
+// top-priority task on a monotonic clock instead; those numbers cover the
+// RTOS wake path only.
+
+#define LAT_TICK_HZ     10000000   // 0.1 us per tick
+#define LAT_PERIOD_US   1000
+#define LAT_SAMPLES     1000
+#define LAT_HIST_BUCKETS 20        // log2 of ticks, up to ~52 ms
+
+typedef enum {
+    LAT_SEMAPHORE,
+    LAT_NOTIFY,
+    LAT_STREAM_BUFFER,
+    LAT_QUEUE,
+    LAT_MECH_COUNT,
+} lat_mechanism_t;
+
+typedef enum {
+    LAT_LOAD_NONE,       // idle system
+    LAT_LOAD_CPU,        // busy low-priority task on every core
+    LAT_LOAD_CRITICAL,   // low-priority tasks holding 20 us critical sections
+    LAT_LOAD_COUNT,
+} lat_load_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t max;
+    uint32_t hist[LAT_HIST_BUCKETS];
+} lat_dist_t;
+
+typedef struct {
+    lat_mechanism_t mech;
+    lat_load_t load;
+    uint32_t samples;
+    uint32_t overruns;     // alarm fired before the previous wake was consumed
+    lat_dist_t entry;      // alarm -> ISR entry
+    lat_dist_t isr;        // ISR entry -> wake call returned
+    lat_dist_t wake;       // wake call -> task resumed
+    lat_dist_t total;      // alarm -> task resumed
+} lat_result_t;
+
+const char *lat_mechanism_name(lat_mechanism_t m);
+const char *lat_load_name(lat_load_t l);
+
+// Percentile upper bound in microseconds
+float lat_dist_percentile_us(const lat_dist_t *d, uint32_t permille);
+
+// One mechanism under one load; blocks for about LAT_SAMPLES periods
+bool lat_measure(lat_mechanism_t mech, lat_load_t load, lat_result_t *out);
+
+// Full matrix with a table and the total-latency histogram per cell
+void lat_run_all(void);
+
+#endif
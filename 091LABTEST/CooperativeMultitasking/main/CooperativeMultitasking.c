@@ -4,11 +4,15 @@
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "gpio_events.h"
 
 #define LED1_PIN GPIO_NUM_2   // Task 1 indicator
 #define LED2_PIN GPIO_NUM_4   // Task 2 indicator
 #define LED3_PIN GPIO_NUM_5   // Task 3 indicator
 #define BUTTON_PIN GPIO_NUM_0 // Emergency button
+#define BUTTON_DEBOUNCE_MS 50
+
+static int button_slot = -1;  // gpio_events slot for BUTTON_PIN
 
 // ============================================================================
 // PART 1: COOPERATIVE MULTITASKING (15 นาที)
@@ -99,6 +103,17 @@ void cooperative_task3_emergency(void)
     }
 }
 
+// Runs in the GPIO event handler the moment the button goes down; the
+// cooperative tasks only notice at their next yield point
+static void coop_emergency_cb(const gev_event_t *ev, void *ctx)
+{
+    if (!emergency_flag) {
+        task_start_time = ev->isr_us;
+        emergency_flag = true;
+        ESP_LOGW(COOP_TAG, "Emergency button pressed!");
+    }
+}
+
 // Cooperative Scheduler
 void cooperative_scheduler(void)
 {
@@ -112,13 +127,6 @@ void cooperative_scheduler(void)
     int current_task = 0;
 
     while (1) {
-        // Check for emergency button
-        if (gpio_get_level(BUTTON_PIN) == 0 && !emergency_flag) {
-            emergency_flag = true;
-            task_start_time = esp_timer_get_time();
-            ESP_LOGW(COOP_TAG, "Emergency button pressed!");
-        }
-
         // Run current task
         if (tasks[current_task].ready) {
             tasks[current_task].task_function();
@@ -136,6 +144,7 @@ void test_cooperative_multitasking(void)
     ESP_LOGI(COOP_TAG, "=== Cooperative Multitasking Demo ===");
     ESP_LOGI(COOP_TAG, "Tasks will yield voluntarily");
     ESP_LOGI(COOP_TAG, "Press button to test emergency response");
+    gev_subscribe_cb(button_slot, GEV_PRESS, coop_emergency_cb, NULL);
     cooperative_scheduler();
 }
 
@@ -144,7 +153,6 @@ void test_cooperative_multitasking(void)
 // ============================================================================
 static const char *PREEMPT_TAG = "PREEMPTIVE";
 static volatile bool preempt_emergency = false;
-static uint64_t preempt_start_time = 0;
 static uint32_t preempt_max_response = 0;
 
 void preemptive_task1(void *pvParameters)
@@ -185,31 +193,31 @@ void preemptive_task2(void *pvParameters)
     }
 }
 
+// Blocks until the GPIO event handler notifies it; response is measured
+// from the edge timestamp taken in the ISR
 void preemptive_emergency_task(void *pvParameters)
 {
-    while (1) {
-        if (gpio_get_level(BUTTON_PIN) == 0 && !preempt_emergency) {
-            preempt_emergency = true;
-            preempt_start_time = esp_timer_get_time();
-
-            uint64_t response_time = esp_timer_get_time() - preempt_start_time;
-            uint32_t response_ms = (uint32_t)(response_time / 1000);
+    gev_event_t ev;
 
-            if (response_ms > preempt_max_response) {
-                preempt_max_response = response_ms;
-            }
+    while (1) {
+        if (!(gev_wait(0, portMAX_DELAY) & GEV_BIT(button_slot)) || !gev_last(button_slot, &ev)) {
+            continue;
+        }
+        preempt_emergency = true;
 
-            ESP_LOGW(PREEMPT_TAG, "IMMEDIATE EMERGENCY! Response: %d ms (Max: %d ms)",
-                     response_ms, preempt_max_response);
+        uint32_t response_us = (uint32_t)(esp_timer_get_time() - ev.isr_us);
+        if (response_us > preempt_max_response) {
+            preempt_max_response = response_us;
+        }
 
-            gpio_set_level(LED3_PIN, 1);
-            vTaskDelay(pdMS_TO_TICKS(200));
-            gpio_set_level(LED3_PIN, 0);
+        ESP_LOGW(PREEMPT_TAG, "IMMEDIATE EMERGENCY! Response: %lu us (Max: %lu us)",
+                 response_us, preempt_max_response);
 
-            preempt_emergency = false;
-        }
+        gpio_set_level(LED3_PIN, 1);
+        vTaskDelay(pdMS_TO_TICKS(200));
+        gpio_set_level(LED3_PIN, 0);
 
-        vTaskDelay(pdMS_TO_TICKS(5));
+        preempt_emergency = false;
     }
 }
 
@@ -221,7 +229,9 @@ void test_preemptive_multitasking(void)
 
     xTaskCreate(preemptive_task1, "PreTask1", 2048, NULL, 2, NULL);      // Normal priority
     xTaskCreate(preemptive_task2, "PreTask2", 2048, NULL, 1, NULL);      // Low priority
-    xTaskCreate(preemptive_emergency_task, "Emergency", 2048, NULL, 5, NULL); // High priority
+    TaskHandle_t emergency_handle = NULL;
+    xTaskCreate(preemptive_emergency_task, "Emergency", 2048, NULL, 5, &emergency_handle); // High priority
+    gev_subscribe_task(button_slot, GEV_PRESS, emergency_handle, 0);
 
     vTaskDelete(NULL); // Delete main task
 }
@@ -247,6 +257,10 @@ void app_main(void)
     io_conf.pull_up_en = 1;
     gpio_config(&io_conf);
 
+    // Button edges arrive by interrupt; the handler outranks every demo task
+    gev_init(10);
+    button_slot = gev_add_pin(BUTTON_PIN, true, BUTTON_DEBOUNCE_MS);
+
     ESP_LOGI("MAIN", "Multitasking Comparison Demo");
     ESP_LOGI("MAIN", "Choose test mode:");
     ESP_LOGI("MAIN", "1. Cooperative (comment out preemptive call)");
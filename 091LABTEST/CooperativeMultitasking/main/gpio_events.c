@@ -0,0 +1,368 @@
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "gpio_events.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#define IRAM_ATTR
+#else
+#include "esp_attr.h"
+#include "driver/gpio.h"
+#endif
+
+static const char *TAG = "GPIO_EVT";
+
+#define GEV_RING_MASK (GEV_RING_SIZE - 1)
+#define GEV_SIM_PIN   (-1)
+
+typedef struct {
+    uint8_t slot;
+    uint8_t level;
+    int64_t t_us;
+} gev_raw_t;
+
+typedef struct {
+    uint32_t seq;
+    gev_raw_t raw;
+} gev_cell_t;
+
+typedef struct {
+    uint32_t edges;
+    TaskHandle_t task;
+    UBaseType_t channel;
+    gev_callback_t cb;
+    void *ctx;
+} gev_sub_t;
+
+typedef struct {
+    int pin;
+    bool active_low;
+    uint32_t debounce_us;
+    int sim_level;
+    // handler task only
+    int stable;
+    int64_t lockout_until;      // 0 = not in a debounce window
+    // under lock
+    gev_event_t last;
+    bool has_last;
+    gev_sub_t subs[GEV_MAX_SUBSCRIBERS];
+    int sub_count;
+} gev_pin_t;
+
+static gev_cell_t ring[GEV_RING_SIZE];
+static uint32_t ring_head;      // next cell a producer claims
+static uint32_t ring_tail;      // handler task only
+
+static gev_pin_t pins[GEV_MAX_PINS];
+static int pin_count;
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t handler;
+static gev_stats_t stats;
+
+// ================ RING (multi-producer, single consumer) ================
+// Each cell carries a sequence number: seq == pos means free for the
+// producer that claims pos, seq == pos + 1 means filled. Producers claim a
+// position with one CAS, so the ISR and simulator tasks on either core can
+// push without a lock.
+
+static void ring_init(void) {
+    for (uint32_t i = 0; i < GEV_RING_SIZE; i++)
+        ring[i].seq = i;
+    ring_head = 0;
+    ring_tail = 0;
+}
+
+static bool IRAM_ATTR ring_push(const gev_raw_t *raw) {
+    uint32_t pos = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+    gev_cell_t *cell;
+
+    for (;;) {
+        cell = &ring[pos & GEV_RING_MASK];
+        int32_t dif = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&ring_head, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (dif < 0) {
+            return false;
+        } else {
+            pos = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+        }
+    }
+    cell->raw = *raw;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool ring_pop(gev_raw_t *raw) {
+    gev_cell_t *cell = &ring[ring_tail & GEV_RING_MASK];
+
+    if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != ring_tail + 1)
+        return false;
+    *raw = cell->raw;
+    __atomic_store_n(&cell->seq, ring_tail + GEV_RING_SIZE, __ATOMIC_RELEASE);
+    ring_tail++;
+    return true;
+}
+
+static bool IRAM_ATTR push_edge(int slot, int level, int64_t t_us) {
+    gev_raw_t raw = {.slot = slot, .level = level, .t_us = t_us};
+
+    __atomic_fetch_add(&stats.raw_edges, 1, __ATOMIC_RELAXED);
+    if (ring_push(&raw))
+        return true;
+    __atomic_fetch_add(&stats.ring_drops, 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+static void IRAM_ATTR gev_isr(void *arg) {
+    int slot = (int)(intptr_t)arg;
+    BaseType_t woken = pdFALSE;
+
+    push_edge(slot, gpio_get_level(pins[slot].pin), esp_timer_get_time());
+    vTaskNotifyGiveFromISR(handler, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+#endif
+
+// ================ HANDLER TASK ================
+
+static int read_level(const gev_pin_t *p) {
+#if !CONFIG_IDF_TARGET_LINUX
+    if (p->pin != GEV_SIM_PIN)
+        return gpio_get_level(p->pin);
+#endif
+    return __atomic_load_n(&p->sim_level, __ATOMIC_RELAXED);
+}
+
+static void dispatch(int slot, int level, int64_t t_us) {
+    gev_pin_t *p = &pins[slot];
+    gev_sub_t subs[GEV_MAX_SUBSCRIBERS];
+    gev_event_t ev = {
+        .slot = slot,
+        .pin = p->pin,
+        .edge = (level == (p->active_low ? 0 : 1)) ? GEV_PRESS : GEV_RELEASE,
+        .isr_us = t_us,
+        .dispatch_us = esp_timer_get_time(),
+    };
+
+    taskENTER_CRITICAL(&lock);
+    p->last = ev;
+    p->has_last = true;
+    int n = p->sub_count;
+    memcpy(subs, p->subs, n * sizeof(gev_sub_t));
+    taskEXIT_CRITICAL(&lock);
+
+    uint32_t took = (uint32_t)(ev.dispatch_us - ev.isr_us);
+    stats.events++;
+    if (took > stats.max_dispatch_us)
+        stats.max_dispatch_us = took;
+
+    for (int i = 0; i < n; i++) {
+        if (!(subs[i].edges & ev.edge))
+            continue;
+        if (subs[i].cb)
+            subs[i].cb(&ev, subs[i].ctx);
+        else
+            xTaskNotifyIndexed(subs[i].task, subs[i].channel, GEV_BIT(slot), eSetBits);
+    }
+}
+
+// Leading-edge debounce: report the first change, then hold off
+static void on_raw(const gev_raw_t *raw) {
+    gev_pin_t *p = &pins[raw->slot];
+
+    if (p->lockout_until || raw->level == p->stable) {
+        stats.absorbed++;
+        return;
+    }
+    p->stable = raw->level;
+    p->lockout_until = raw->t_us + p->debounce_us;
+    dispatch(raw->slot, raw->level, raw->t_us);
+}
+
+// Closes finished debounce windows; returns how long until the next one
+static TickType_t close_windows(void) {
+    int64_t now = esp_timer_get_time();
+    int64_t next = 0;
+    int n = __atomic_load_n(&pin_count, __ATOMIC_ACQUIRE);
+
+    for (int i = 0; i < n; i++) {
+        gev_pin_t *p = &pins[i];
+        if (!p->lockout_until)
+            continue;
+        if (now >= p->lockout_until) {
+            p->lockout_until = 0;
+            int level = read_level(p);
+            if (level != p->stable) {
+                // Changed back inside the window (short tap, or an edge the
+                // ring dropped): deliver it and debounce this edge too
+                p->stable = level;
+                p->lockout_until = now + p->debounce_us;
+                dispatch(i, level, now);
+            }
+        }
+        if (p->lockout_until && (!next || p->lockout_until < next))
+            next = p->lockout_until;
+    }
+    if (!next)
+        return portMAX_DELAY;
+    TickType_t ticks = pdMS_TO_TICKS((next - now + 999) / 1000);
+    return ticks ? ticks : 1;
+}
+
+static void handler_task(void *pv) {
+    gev_raw_t raw;
+
+    while (1) {
+        while (ring_pop(&raw))
+            on_raw(&raw);
+        ulTaskNotifyTake(pdTRUE, close_windows());
+    }
+}
+
+// ================ PUBLIC API ================
+
+bool gev_init(UBaseType_t handler_priority) {
+    if (handler)
+        return true;
+    ring_init();
+#if !CONFIG_IDF_TARGET_LINUX
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "ISR service install failed: %s", esp_err_to_name(err));
+        return false;
+    }
+#endif
+    return xTaskCreate(handler_task, "GpioEvt", 3072, NULL, handler_priority, &handler) == pdPASS;
+}
+
+static int add_slot(int pin, bool active_low, uint32_t debounce_ms) {
+    taskENTER_CRITICAL(&lock);
+    int slot = pin_count < GEV_MAX_PINS ? pin_count : -1;
+    if (slot >= 0) {
+        gev_pin_t *p = &pins[slot];
+        memset(p, 0, sizeof(*p));
+        p->pin = pin;
+        p->active_low = active_low;
+        p->debounce_us = debounce_ms * 1000;
+        p->sim_level = active_low ? 1 : 0;
+        p->stable = read_level(p);
+        __atomic_store_n(&pin_count, slot + 1, __ATOMIC_RELEASE);
+    }
+    taskEXIT_CRITICAL(&lock);
+    return slot;
+}
+
+int gev_add_pin(int pin, bool active_low, uint32_t debounce_ms) {
+#if CONFIG_IDF_TARGET_LINUX
+    (void)pin;
+    return gev_add_sim_pin(active_low, debounce_ms);
+#else
+    int slot = add_slot(pin, active_low, debounce_ms);
+    if (slot < 0)
+        return -1;
+    gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+    if (gpio_isr_handler_add(pin, gev_isr, (void *)(intptr_t)slot) != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot attach ISR to GPIO %d", pin);
+        return -1;
+    }
+    return slot;
+#endif
+}
+
+int gev_add_sim_pin(bool active_low, uint32_t debounce_ms) {
+    return add_slot(GEV_SIM_PIN, active_low, debounce_ms);
+}
+
+static bool add_sub(int slot, const gev_sub_t *sub) {
+    bool ok = false;
+
+    if (slot < 0 || slot >= pin_count)
+        return false;
+    taskENTER_CRITICAL(&lock);
+    gev_pin_t *p = &pins[slot];
+    if (p->sub_count < GEV_MAX_SUBSCRIBERS) {
+        p->subs[p->sub_count++] = *sub;
+        ok = true;
+    }
+    taskEXIT_CRITICAL(&lock);
+    return ok;
+}
+
+bool gev_subscribe_task(int slot, uint32_t edges, TaskHandle_t task, UBaseType_t channel) {
+    gev_sub_t sub = {.edges = edges, .task = task, .channel = channel};
+    return add_sub(slot, &sub);
+}
+
+bool gev_subscribe_cb(int slot, uint32_t edges, gev_callback_t cb, void *ctx) {
+    gev_sub_t sub = {.edges = edges, .cb = cb, .ctx = ctx};
+    return add_sub(slot, &sub);
+}
+
+uint32_t gev_wait(UBaseType_t channel, TickType_t timeout) {
+    uint32_t bits = 0;
+
+    if (xTaskNotifyWaitIndexed(channel, 0, UINT32_MAX, &bits, timeout) != pdTRUE)
+        return 0;
+    return bits;
+}
+
+bool gev_last(int slot, gev_event_t *out) {
+    bool ok;
+
+    if (slot < 0 || slot >= pin_count)
+        return false;
+    taskENTER_CRITICAL(&lock);
+    ok = pins[slot].has_last;
+    *out = pins[slot].last;
+    taskEXIT_CRITICAL(&lock);
+    return ok;
+}
+
+bool gev_is_active(int slot) {
+    gev_event_t ev;
+    return gev_last(slot, &ev) && ev.edge == GEV_PRESS;
+}
+
+// ================ SIMULATED SOURCE ================
+
+void gev_sim_write(int slot, int level) {
+    if (slot < 0 || slot >= pin_count)
+        return;
+    __atomic_store_n(&pins[slot].sim_level, level, __ATOMIC_RELAXED);
+    push_edge(slot, level, esp_timer_get_time());
+    xTaskNotifyGive(handler);
+}
+
+void gev_sim_pulse(int slot, bool press, int bounce_edges) {
+    if (slot < 0 || slot >= pin_count)
+        return;
+    int active = pins[slot].active_low ? 0 : 1;
+    int level = press ? active : !active;
+
+    gev_sim_write(slot, level);
+    for (int i = 0; i < bounce_edges; i++) {
+        gev_sim_write(slot, !level);
+        gev_sim_write(slot, level);
+    }
+}
+
+// ================ STATS ================
+
+void gev_get_stats(gev_stats_t *out) {
+    out->raw_edges = __atomic_load_n(&stats.raw_edges, __ATOMIC_RELAXED);
+    out->ring_drops = __atomic_load_n(&stats.ring_drops, __ATOMIC_RELAXED);
+    out->absorbed = stats.absorbed;
+    out->events = stats.events;
+    out->max_dispatch_us = stats.max_dispatch_us;
+}
+
+void gev_report(void) {
+    gev_stats_t s;
+
+    gev_get_stats(&s);
+    ESP_LOGI(TAG, "edges %lu -> events %lu (debounced %lu, ring drops %lu), max ISR->dispatch %lu us",
+             s.raw_edges, s.events, s.absorbed, s.ring_drops, s.max_dispatch_us);
+}
@@ -5,6 +5,7 @@
 #include "esp_log.h"
 #include "esp_system.h"
 #include "freertos/semphr.h"
+#include "cpu_account.h"
 
 #define LED1_PIN GPIO_NUM_2
 #define LED2_PIN GPIO_NUM_4
@@ -137,31 +138,29 @@ void low_priority_task(void *pvParameters)
     }
 }
 
+// Samples run-time counters every second; loads cover the last second and
+// a window of CA_WINDOW seconds (cpu_account.h)
 void runtime_stats_task(void *pvParameters)
 {
-    char *buffer = malloc(1024);
-    if (!buffer)
+    if (!ca_init())
     {
-        ESP_LOGE(TAG, "Failed to allocate buffer");
+        ESP_LOGE(TAG, "Failed to start CPU accounting");
         vTaskDelete(NULL);
     }
 
+    TickType_t wake = xTaskGetTickCount();
+    uint32_t seconds = 0;
     while (1)
     {
-        ESP_LOGI(TAG, "\n=== Runtime Statistics ===");
-        vTaskGetRunTimeStats(buffer);
-        ESP_LOGI(TAG, "Task\tAbs Time\tPercent Time");
-        ESP_LOGI(TAG, "%s", buffer);
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(1000));
+        ca_sample();
 
-        ESP_LOGI(TAG, "\n=== Task List ===");
-        vTaskList(buffer);
-        ESP_LOGI(TAG, "Name\tState\tPrio\tStack\tNum");
-        ESP_LOGI(TAG, "%s", buffer);
-
-        vTaskDelay(pdMS_TO_TICKS(10000));
+        if (++seconds % 10 == 0)
+        {
+            ESP_LOGI(TAG, "=== Runtime Statistics ===");
+            ca_report();
+        }
     }
-
-    free(buffer);
 }
 
 // ================= Exercise 1: Task Self-Deletion ==================
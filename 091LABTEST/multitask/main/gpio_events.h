@@ -0,0 +1,81 @@
+#ifndef GPIO_EVENTS_H
+#define GPIO_EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ============================= GPIO EVENTS =============================
+// Interrupt-driven replacement for gpio_get_level() polling loops.
+//
+//   edge ISR --(lock-free ring)--> handler task --(notify / callback)--> subscribers
+//
+// The ISR only timestamps the edge and pushes it into a multi-producer ring,
+// then wakes the handler. The handler debounces on the leading edge: the
+// first edge that changes the reported level is delivered at once, and
+// further edges inside the debounce window are absorbed. When the window
+// closes the pin is read again, and a change that happened inside the
+// window is delivered then. So a press reaches its subscriber within
+// microseconds, and contact bounce never does.
+//
+// Subscribers are tasks or callbacks. A task gets GEV_BIT(slot) OR-ed into
+// one of its notification channels, so several events that arrive before
+// it wakes coalesce into a single wake-up; gev_last() returns the newest
+// event. Callbacks run in the handler task and must not block.
+//
+// Simulated pins (and every pin on the Linux host, CONFIG_IDF_TARGET_LINUX)
+// take their edges from gev_sim_write()/gev_sim_pulse() instead of the ISR.
+
+#define GEV_MAX_PINS        8
+#define GEV_MAX_SUBSCRIBERS 4     // per pin
+#define GEV_RING_SIZE       32    // raw edges in flight, power of two
+
+#define GEV_BIT(slot)       (1UL << (slot))
+
+typedef enum {
+    GEV_PRESS   = 1 << 0,   // pin went to its active level
+    GEV_RELEASE = 1 << 1,
+} gev_edge_t;
+
+typedef struct {
+    int slot;
+    int pin;
+    gev_edge_t edge;
+    int64_t isr_us;         // when the edge was seen (ISR or simulator)
+    int64_t dispatch_us;    // when subscribers were told
+} gev_event_t;
+
+typedef void (*gev_callback_t)(const gev_event_t *ev, void *ctx);
+
+typedef struct {
+    uint32_t raw_edges;
+    uint32_t ring_drops;    // ring full, edge lost (pin is re-read after the window)
+    uint32_t absorbed;      // edges swallowed by debounce
+    uint32_t events;
+    uint32_t max_dispatch_us;
+} gev_stats_t;
+
+// Installs the GPIO ISR service and starts the handler task
+bool gev_init(UBaseType_t handler_priority);
+
+// Returns the slot for the pin, or -1. The pin must already be an input.
+int gev_add_pin(int pin, bool active_low, uint32_t debounce_ms);
+int gev_add_sim_pin(bool active_low, uint32_t debounce_ms);
+
+bool gev_subscribe_task(int slot, uint32_t edges, TaskHandle_t task, UBaseType_t channel);
+bool gev_subscribe_cb(int slot, uint32_t edges, gev_callback_t cb, void *ctx);
+
+// For subscribed tasks: slot bits that fired, 0 on timeout
+uint32_t gev_wait(UBaseType_t channel, TickType_t timeout);
+bool gev_last(int slot, gev_event_t *out);
+bool gev_is_active(int slot);
+
+// Simulated source: a raw edge, or a full press/release with contact bounce
+void gev_sim_write(int slot, int level);
+void gev_sim_pulse(int slot, bool press, int bounce_edges);
+
+void gev_get_stats(gev_stats_t *out);
+void gev_report(void);
+
+#endif
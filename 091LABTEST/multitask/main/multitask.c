@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "rt_bench.h"
 
 #define LED1_PIN GPIO_NUM_2
 #define LED2_PIN GPIO_NUM_4
@@ -10,62 +12,85 @@
 
 static const char *TAG = "MULTITASK";
 
+#define MODEL_TASKS 4
+
+static const rb_params_t *params;
+static SemaphoreHandle_t tasks_done;
+
 // Task 1: Sensor Reading
 void sensor_task(void *pvParameters)
 {
-    while (1) {
-        ESP_LOGI(TAG, "Reading sensor...");
+    TickType_t wake = xTaskGetTickCount();
+    while (rb_running()) {
         gpio_set_level(LED1_PIN, 1);
-        vTaskDelay(pdMS_TO_TICKS(100));
+        vTaskDelay(pdMS_TO_TICKS(RB_SENSOR_ON_MS));
         gpio_set_level(LED1_PIN, 0);
-        vTaskDelay(pdMS_TO_TICKS(900)); // 1 second total
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(RB_PERIOD_MS));
     }
+    xSemaphoreGive(tasks_done);
+    vTaskDelete(NULL);
 }
 
 // Task 2: Data Processing
 void processing_task(void *pvParameters)
 {
-    while (1) {
-        ESP_LOGI(TAG, "Processing data...");
-        for (int i = 0; i < 500000; i++) {
-            volatile int dummy = i * i;
-            if (i % 100000 == 0) {
-                vTaskDelay(1); // Yield to other tasks
-            }
-        }
-        vTaskDelay(pdMS_TO_TICKS(500));
+    TickType_t wake = xTaskGetTickCount();
+    while (rb_process_job(params, NULL)) {
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(RB_PERIOD_MS));
     }
+    xSemaphoreGive(tasks_done);
+    vTaskDelete(NULL);
 }
 
 // Task 3: Actuator Control
 void actuator_task(void *pvParameters)
 {
-    while (1) {
-        ESP_LOGI(TAG, "Controlling actuator...");
+    TickType_t wake = xTaskGetTickCount();
+    while (rb_running()) {
         gpio_set_level(LED2_PIN, 1);
-        vTaskDelay(pdMS_TO_TICKS(200));
+        vTaskDelay(pdMS_TO_TICKS(RB_ACTUATOR_ON_MS));
         gpio_set_level(LED2_PIN, 0);
-        vTaskDelay(pdMS_TO_TICKS(800)); // 1 second total
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(RB_PERIOD_MS));
     }
+    xSemaphoreGive(tasks_done);
+    vTaskDelete(NULL);
 }
 
 // Task 4: Emergency Response (High Priority)
+// Blocks on the press instead of polling every 10 ms, and preempts the
+// processing wherever it is
 void emergency_task(void *pvParameters)
 {
-    while (1) {
-        if (gpio_get_level(BUTTON_PIN) == 0) {
-            ESP_LOGW(TAG, "EMERGENCY! Button pressed - Immediate response!");
-            // Immediate response because this task has high priority
-            gpio_set_level(LED1_PIN, 1);
-            gpio_set_level(LED2_PIN, 1);
-            vTaskDelay(pdMS_TO_TICKS(100));
-            gpio_set_level(LED1_PIN, 0);
-            gpio_set_level(LED2_PIN, 0);
+    while (rb_running()) {
+        if (rb_emergency_wait(pdMS_TO_TICKS(100))) {
+            rb_respond();
         }
-        vTaskDelay(pdMS_TO_TICKS(10)); // Check every 10ms
+    }
+    xSemaphoreGive(tasks_done);
+    vTaskDelete(NULL);
+}
+
+// The workload as four tasks on one core (see rt_bench.h)
+static void multitask_run(const rb_params_t *p)
+{
+    params = p;
+    // Create tasks with different priorities
+    int started = 0;
+    started += rb_spawn(sensor_task, "sensor", 2, NULL) == pdPASS;
+    started += rb_spawn(processing_task, "processing", 1, NULL) == pdPASS;
+    started += rb_spawn(actuator_task, "actuator", 2, NULL) == pdPASS;
+    started += rb_spawn(emergency_task, "emergency", 5, NULL) == pdPASS; // Highest priority
+    if (started < MODEL_TASKS) {
+        ESP_LOGE(TAG, "Only %d of %d tasks started", started, MODEL_TASKS);
+    }
+
+    for (int i = 0; i < started; i++) {
+        xSemaphoreTake(tasks_done, portMAX_DELAY);
     }
 }
 
+static const rb_model_t multitask = {.name = "rtos", .run = multitask_run};
+
 void app_main(void)
 {
     // GPIO Configuration
@@ -90,9 +115,9 @@ void app_main(void)
 
     ESP_LOGI(TAG, "Multitasking System Started");
 
-    // Create tasks with different priorities
-    xTaskCreate(sensor_task, "sensor", 2048, NULL, 2, NULL);
-    xTaskCreate(processing_task, "processing", 2048, NULL, 1, NULL);
-    xTaskCreate(actuator_task, "actuator", 2048, NULL, 2, NULL);
-    xTaskCreate(emergency_task, "emergency", 2048, NULL, 5, NULL); // Highest priority
-}
\ No newline at end of file
+    tasks_done = xSemaphoreCreateCounting(MODEL_TASKS, 0);
+    // Button presses come from the harness's simulated GPIO
+    if (!tasks_done || !rb_sweep_start(&multitask)) {
+        ESP_LOGE(TAG, "Failed to start the benchmark");
+    }
+}
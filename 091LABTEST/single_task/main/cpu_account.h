@@ -0,0 +1,68 @@
+#ifndef CPU_ACCOUNT_H
+#define CPU_ACCOUNT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// =============================== CPU ACCOUNTING ==============================
+// Per-task and per-core CPU utilization from the FreeRTOS run-time counters.
+//
+// ca_sample() copies uxTaskGetSystemState() into a static array and keeps,
+// per task, the run-time counter of the last CA_WINDOW + 1 samples. Loads
+// are deltas between samples divided by the elapsed run-time clock, so both
+// sides are in the same unit (microseconds with the esp_timer run-time
+// clock). Each load comes in two spans:
+//   last    the interval since the previous sample
+//   window  the last CA_WINDOW intervals, sliding by one sample each time
+//
+// A core's load is 1000 minus the share of its idle task. Task loads are
+// shares of one core, so a task that floats between cores still sums up
+// correctly. Everything is permille and read without formatting, so a
+// controller can poll it as often as it likes. Nothing allocates after
+// ca_init().
+//
+// Needs CONFIG_FREERTOS_USE_TRACE_FACILITY and
+// CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS. The 32-bit counters wrap after
+// about 71 minutes; deltas are modular, so a window shorter than that is
+// measured correctly across a wrap.
+
+#define CA_MAX_TASKS  32        // tasks beyond this make a sample fail
+#define CA_WINDOW     10        // intervals in the sliding window
+#define CA_ANY_CORE   -1
+
+typedef struct {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+    int8_t core;                // pinned core or CA_ANY_CORE
+    uint8_t priority;
+    uint16_t last;              // permille of one core
+    uint16_t window;
+} ca_task_info_t;
+
+typedef struct {
+    uint32_t samples;
+    uint32_t failed;            // more than CA_MAX_TASKS tasks alive
+    uint32_t interval_us;       // span of the last interval
+    uint32_t window_us;         // span of the current window
+} ca_stats_t;
+
+// Call once before anything else; takes the first sample
+bool ca_init(void);
+// Samples every period_ms from its own task; or call ca_sample() yourself
+bool ca_start(uint32_t period_ms, UBaseType_t priority);
+void ca_sample(void);
+
+// Permille; 0 for an unknown core or task, or before the second sample
+uint16_t ca_core_load(int core, bool window);
+uint16_t ca_system_load(bool window);   // mean over all cores
+uint16_t ca_task_load(TaskHandle_t task, bool window);
+
+// Copies up to max tasks, returns how many
+int ca_tasks(ca_task_info_t *out, int max);
+void ca_get_stats(ca_stats_t *out);
+
+void ca_report(void);
+
+#endif
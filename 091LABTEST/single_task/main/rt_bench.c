@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "gpio_events.h"
+#include "cpu_account.h"
+#include "rt_bench.h"
+
+static const char *TAG = "RT_BENCH";
+
+#define RB_DEBOUNCE_MS 5
+
+static const uint32_t sweep_chunks[] = {1000, 10000, 100000, RB_JOB_ITERS};
+static const uint32_t sweep_yields[] = {0, 1, 10};
+#define RB_SWEEP_RUNS (sizeof(sweep_chunks) / sizeof(sweep_chunks[0]) * \
+                       sizeof(sweep_yields) / sizeof(sweep_yields[0]))
+
+static int press_slot = -1;
+static SemaphoreHandle_t model_done;
+static uint32_t job_us;             // one job alone, calibrated by rb_init()
+
+// Current run
+static bool running;
+static rb_params_t run_params;
+static uint32_t pending_us;         // press edge time | 1, 0 = none
+static TaskHandle_t waiter;
+static uint32_t missed;
+static uint32_t responded;          // rb_respond() only
+static uint32_t lat_us[RB_PRESSES];
+static uint32_t jobs;               // processing only
+static uint64_t iters;
+
+// ================ MODEL SIDE ================
+
+bool rb_running(void) {
+    return __atomic_load_n(&running, __ATOMIC_ACQUIRE);
+}
+
+BaseType_t rb_spawn(TaskFunction_t fn, const char *name, UBaseType_t priority, TaskHandle_t *out) {
+    return xTaskCreatePinnedToCore(fn, name, 3072, NULL, priority, out, RB_MODEL_CORE);
+}
+
+static void work(uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        volatile int dummy = i * i;
+        (void)dummy;
+    }
+}
+
+bool rb_process_job(const rb_params_t *p, void (*checkpoint)(void)) {
+    uint32_t chunk = p->chunk_iters ? p->chunk_iters : RB_JOB_ITERS;
+    uint32_t done = 0, chunks = 0;
+
+    while (done < RB_JOB_ITERS) {
+        uint32_t n = RB_JOB_ITERS - done < chunk ? RB_JOB_ITERS - done : chunk;
+        work(n);
+        done += n;
+        iters += n;
+        if (checkpoint)
+            checkpoint();
+        if (!rb_running())
+            return false;
+        if (p->yield_every && ++chunks % p->yield_every == 0)
+            vTaskDelay(1);
+    }
+    jobs++;
+    return true;
+}
+
+bool rb_emergency_pending(void) {
+    return __atomic_load_n(&pending_us, __ATOMIC_ACQUIRE) != 0;
+}
+
+bool rb_emergency_wait(TickType_t timeout) {
+    __atomic_store_n(&waiter, xTaskGetCurrentTaskHandle(), __ATOMIC_RELEASE);
+    if (rb_emergency_pending())
+        return true;
+    ulTaskNotifyTake(pdTRUE, timeout);
+    return rb_emergency_pending();
+}
+
+// One responding task at a time, as in both models
+void rb_respond(void) {
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    uint32_t t = __atomic_exchange_n(&pending_us, 0, __ATOMIC_ACQ_REL);
+    if (!t)
+        return;
+    if (responded < RB_PRESSES)
+        lat_us[responded] = now - t;
+    responded++;
+}
+
+// ================ INJECTION ================
+
+// GPIO event task: latch the press like an interrupt flag would
+static void on_press(const gev_event_t *ev, void *ctx) {
+    uint32_t none = 0;
+    uint32_t t = (uint32_t)ev->isr_us | 1;
+
+    if (!__atomic_compare_exchange_n(&pending_us, &none, t, false,
+                                     __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&missed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    TaskHandle_t w = __atomic_load_n(&waiter, __ATOMIC_ACQUIRE);
+    if (w)
+        xTaskNotifyGive(w);
+}
+
+static void model_task(void *arg) {
+    const rb_model_t *m = arg;
+    m->run(&run_params);
+    xSemaphoreGive(model_done);
+    vTaskDelete(NULL);
+}
+
+bool rb_init(void) {
+    if (model_done)
+        return true;
+    model_done = xSemaphoreCreateBinary();
+    if (!model_done || !gev_init(configMAX_PRIORITIES - 2) || !ca_init())
+        return false;
+    press_slot = gev_add_sim_pin(true, RB_DEBOUNCE_MS);
+    if (press_slot < 0 || !gev_subscribe_cb(press_slot, GEV_PRESS, on_press, NULL))
+        return false;
+
+    // Best of three, so the overhead baseline is the loop alone
+    job_us = UINT32_MAX;
+    for (int i = 0; i < 3; i++) {
+        int64_t start = esp_timer_get_time();
+        work(RB_JOB_ITERS);
+        uint32_t t = esp_timer_get_time() - start;
+        if (t < job_us)
+            job_us = t;
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+static uint32_t percentile(const uint32_t *sorted, uint32_t n, uint32_t pct) {
+    return n ? sorted[(n - 1) * pct / 100] : 0;
+}
+
+bool rb_run(const rb_model_t *m, const rb_params_t *p, rb_result_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->params = *p;
+    run_params = *p;
+    pending_us = 0;
+    waiter = NULL;
+    missed = 0;
+    responded = 0;
+    jobs = 0;
+    iters = 0;
+    __atomic_store_n(&running, true, __ATOMIC_RELEASE);
+
+    ca_sample();
+    int64_t start = esp_timer_get_time();
+    if (xTaskCreatePinnedToCore(model_task, "RbModel", 4096, (void *)m, RB_MODEL_PRIO, NULL,
+                                RB_MODEL_CORE) != pdPASS) {
+        running = false;
+        return false;
+    }
+
+    // Same schedule every run: the seed restarts
+    uint32_t seed = RB_SEED;
+    TickType_t wake = xTaskGetTickCount();
+    for (int i = 0; i < RB_PRESSES; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(RB_GAP_MIN_MS + (seed >> 8) % RB_GAP_SPREAD_MS));
+        gev_sim_pulse(press_slot, true, 0);
+        vTaskDelay(pdMS_TO_TICKS(RB_HOLD_MS));
+        gev_sim_pulse(press_slot, false, 0);
+    }
+    vTaskDelay(pdMS_TO_TICKS(RB_DRAIN_MS));
+
+    __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+    xSemaphoreTake(model_done, portMAX_DELAY);
+    uint32_t run_us = esp_timer_get_time() - start;
+    ca_sample();
+    __atomic_store_n(&waiter, NULL, __ATOMIC_RELEASE);
+
+    // Still pending at the end: never answered
+    if (__atomic_exchange_n(&pending_us, 0, __ATOMIC_ACQ_REL))
+        missed++;
+
+    uint32_t n = responded < RB_PRESSES ? responded : RB_PRESSES;
+    for (uint32_t i = 1; i < n; i++) {
+        uint32_t v = lat_us[i];
+        uint32_t j = i;
+        for (; j > 0 && lat_us[j - 1] > v; j--)
+            lat_us[j] = lat_us[j - 1];
+        lat_us[j] = v;
+    }
+    out->presses = RB_PRESSES;
+    out->responded = responded;
+    out->missed = missed;
+    out->lat_min_us = percentile(lat_us, n, 0);
+    out->lat_p50_us = percentile(lat_us, n, 50);
+    out->lat_p90_us = percentile(lat_us, n, 90);
+    out->lat_max_us = percentile(lat_us, n, 100);
+    out->jobs = jobs;
+    out->run_ms = run_us / 1000;
+
+    // Overhead: busy time the processing iterations do not explain
+    out->busy = ca_core_load(RB_MODEL_CORE, false);
+    uint64_t busy_us = (uint64_t)out->busy * run_us / 1000;
+    uint64_t useful_us = iters * job_us / RB_JOB_ITERS;
+    out->overhead = busy_us > useful_us && run_us ? (busy_us - useful_us) * 1000 / run_us : 0;
+    return true;
+}
+
+// ================ SWEEP ================
+
+static void print_row(const rb_result_t *r) {
+    uint32_t jobs_x10 = r->run_ms ? r->jobs * 10000 / r->run_ms : 0;
+
+    ESP_LOGI(TAG, "%7lu %5lu  %4lu %4lu %7lu %7lu %7lu %7lu  %3lu.%lu  %3u.%u%% %3u.%u%%",
+             r->params.chunk_iters, r->params.yield_every, r->responded, r->missed,
+             r->lat_min_us, r->lat_p50_us, r->lat_p90_us, r->lat_max_us, jobs_x10 / 10, jobs_x10 % 10,
+             r->busy / 10, r->busy % 10, r->overhead / 10, r->overhead % 10);
+}
+
+// For tools/rt_bench_compare.py
+static void print_record(const char *model, const rb_result_t *r) {
+    printf("RB model=%s chunk=%lu yield=%lu presses=%lu resp=%lu miss=%lu min=%lu p50=%lu p90=%lu "
+           "max=%lu jobs=%lu run_ms=%lu busy=%u ovh=%u\n",
+           model, (unsigned long)r->params.chunk_iters, (unsigned long)r->params.yield_every,
+           (unsigned long)r->presses, (unsigned long)r->responded, (unsigned long)r->missed,
+           (unsigned long)r->lat_min_us, (unsigned long)r->lat_p50_us, (unsigned long)r->lat_p90_us,
+           (unsigned long)r->lat_max_us, (unsigned long)r->jobs, (unsigned long)r->run_ms,
+           r->busy, r->overhead);
+}
+
+static void sweep_task(void *arg) {
+    const rb_model_t *m = arg;
+    static rb_result_t results[RB_SWEEP_RUNS];
+    int n = 0;
+
+    if (!rb_init()) {
+        ESP_LOGE(TAG, "Harness setup failed");
+        vTaskDelete(NULL);
+    }
+    ESP_LOGI(TAG, "🏁 %s: %d presses per run, %d runs, one job alone takes %lu us",
+             m->name, RB_PRESSES, (int)RB_SWEEP_RUNS, job_us);
+
+    for (int c = 0; c < sizeof(sweep_chunks) / sizeof(sweep_chunks[0]); c++) {
+        for (int y = 0; y < sizeof(sweep_yields) / sizeof(sweep_yields[0]); y++) {
+            rb_params_t p = {.chunk_iters = sweep_chunks[c], .yield_every = sweep_yields[y]};
+            ESP_LOGI(TAG, "▶️ chunk %lu, yield every %lu", p.chunk_iters, p.yield_every);
+            if (rb_run(m, &p, &results[n]))
+                n++;
+            else
+                ESP_LOGE(TAG, "Run failed to start");
+        }
+    }
+
+    ESP_LOGI(TAG, "📊 %s response time (us), throughput and CPU on core %d", m->name, RB_MODEL_CORE);
+    ESP_LOGI(TAG, "%7s %5s  %4s %4s %7s %7s %7s %7s  %5s  %6s %6s", "chunk", "yield", "resp", "miss",
+             "min", "p50", "p90", "max", "job/s", "busy", "ovh");
+    for (int i = 0; i < n; i++)
+        print_row(&results[i]);
+    for (int i = 0; i < n; i++)
+        print_record(m->name, &results[i]);
+    fflush(stdout);
+    gev_report();
+    vTaskDelete(NULL);
+}
+
+bool rb_sweep_start(const rb_model_t *m) {
+    return xTaskCreatePinnedToCore(sweep_task, "RtBench", 4096, (void *)m, configMAX_PRIORITIES - 3,
+                                   NULL, RB_INJECT_CORE) == pdPASS;
+}
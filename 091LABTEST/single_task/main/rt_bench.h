@@ -0,0 +1,100 @@
+#ifndef RT_BENCH_H
+#define RT_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ============================ RESPONSE-TIME BENCH ============================
+// Harness shared by single_task (one superloop) and multitask (four
+// FreeRTOS tasks). Both models run the same workload:
+//   sensor      LED1 on for RB_SENSOR_ON_MS every RB_PERIOD_MS
+//   processing  RB_JOB_ITERS of the multiply loop every RB_PERIOD_MS
+//   actuator    LED2 on for RB_ACTUATOR_ON_MS every RB_PERIOD_MS
+//   emergency   a button press that must be acknowledged
+//
+// The processing job is split into chunks of chunk_iters with a checkpoint
+// after each, and blocks for one tick every yield_every chunks (0 = never).
+// rb_sweep() runs the model once per chunk size and yield granularity.
+//
+// The injector presses a simulated button (gpio_events.h) at seeded
+// pseudo-random times, so presses land at every phase of the workload and
+// every run sees the same schedule. The press is latched like an interrupt
+// flag. A model polls rb_emergency_pending() or blocks in
+// rb_emergency_wait(), and calls rb_respond() once it has reacted. Latency
+// is press edge to rb_respond(). A press that arrives while the previous
+// one is still pending is counted as missed.
+//
+// The model runs pinned to RB_MODEL_CORE and the injector on RB_INJECT_CORE,
+// the other core when there is one. CPU overhead is the model core's busy
+// time (cpu_account.h) minus what the processing iterations cost on their
+// own, as a share of the run.
+//
+// Results are printed as one table per model. Each row is also printed as
+// an "RB " line, which tools/rt_bench_compare.py joins across the logs of
+// both labs into a single comparison table.
+
+#define RB_JOB_ITERS         1000000
+#define RB_PERIOD_MS         500
+#define RB_SENSOR_ON_MS      100
+#define RB_ACTUATOR_ON_MS    100
+
+#define RB_PRESSES           10      // per run
+#define RB_GAP_MIN_MS        1000    // between presses, plus up to RB_GAP_SPREAD_MS
+#define RB_GAP_SPREAD_MS     1000
+#define RB_HOLD_MS           20
+#define RB_DRAIN_MS          2000    // after the last press
+#define RB_SEED              0x2545F491u
+
+#define RB_MODEL_CORE        0
+#define RB_INJECT_CORE       (portNUM_PROCESSORS - 1)
+#define RB_MODEL_PRIO        1
+
+typedef struct {
+    uint32_t chunk_iters;       // work between checkpoints
+    uint32_t yield_every;       // chunks between one-tick yields, 0 = never
+} rb_params_t;
+
+typedef struct {
+    const char *name;
+    // Runs the workload until rb_running() turns false, then returns. Called
+    // in a task pinned to RB_MODEL_CORE at RB_MODEL_PRIO.
+    void (*run)(const rb_params_t *p);
+} rb_model_t;
+
+typedef struct {
+    rb_params_t params;
+    uint32_t presses;
+    uint32_t responded;
+    uint32_t missed;
+    uint32_t lat_min_us;
+    uint32_t lat_p50_us;
+    uint32_t lat_p90_us;
+    uint32_t lat_max_us;
+    uint32_t jobs;              // processing jobs completed
+    uint32_t run_ms;
+    uint16_t busy;              // permille of RB_MODEL_CORE
+    uint16_t overhead;          // permille of RB_MODEL_CORE
+} rb_result_t;
+
+// ---- for models ----
+bool rb_running(void);
+// Same task, same core and priority as the caller's model
+BaseType_t rb_spawn(TaskFunction_t fn, const char *name, UBaseType_t priority, TaskHandle_t *out);
+// One processing job; checkpoint (may be NULL) runs after every chunk.
+// Returns false if the run stopped part way.
+bool rb_process_job(const rb_params_t *p, void (*checkpoint)(void));
+bool rb_emergency_pending(void);
+// Blocks the calling task until a press is pending or the timeout expires
+bool rb_emergency_wait(TickType_t timeout);
+// Records the latency of the pending press; call from one task only
+void rb_respond(void);
+
+// ---- for app_main ----
+bool rb_init(void);
+bool rb_run(const rb_model_t *m, const rb_params_t *p, rb_result_t *out);
+// Runs the full sweep from a task on RB_INJECT_CORE and prints the table
+bool rb_sweep_start(const rb_model_t *m);
+
+#endif
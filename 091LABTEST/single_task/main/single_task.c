@@ -3,12 +3,65 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "rt_bench.h"
 
 #define LED1_PIN GPIO_NUM_2
 #define LED2_PIN GPIO_NUM_4
 
 static const char *TAG = "SINGLE_TASK";
 
+// Emergency check: the only place a superloop can react
+static void check_emergency(void)
+{
+    if (rb_emergency_pending()) {
+        rb_respond();
+    }
+}
+
+// Waits tick by tick, checking the emergency between ticks
+static void wait_ms(uint32_t ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    while (xTaskGetTickCount() - start < pdMS_TO_TICKS(ms) && rb_running()) {
+        check_emergency();
+        vTaskDelay(1);
+    }
+}
+
+// The whole workload as one loop (see rt_bench.h). Processing checks the
+// emergency after every chunk, so the chunk size bounds the response time.
+static void superloop_run(const rb_params_t *p)
+{
+    TickType_t cycle_start = xTaskGetTickCount();
+
+    while (rb_running()) {
+        // Task 1: Blink LED1 (simulated sensor reading)
+        gpio_set_level(LED1_PIN, 1);
+        wait_ms(RB_SENSOR_ON_MS);
+        gpio_set_level(LED1_PIN, 0);
+
+        // Task 2: Process data (heavy computation)
+        rb_process_job(p, check_emergency);
+
+        // Task 3: Control LED2 (actuator)
+        gpio_set_level(LED2_PIN, 1);
+        wait_ms(RB_ACTUATOR_ON_MS);
+        gpio_set_level(LED2_PIN, 0);
+
+        // Task 4: Check button (emergency response)
+        check_emergency();
+
+        // Rest of the period; an overrun starts the next cycle at once
+        TickType_t elapsed = xTaskGetTickCount() - cycle_start;
+        if (elapsed < pdMS_TO_TICKS(RB_PERIOD_MS)) {
+            wait_ms((pdMS_TO_TICKS(RB_PERIOD_MS) - elapsed) * portTICK_PERIOD_MS);
+        }
+        cycle_start = xTaskGetTickCount();
+    }
+}
+
+static const rb_model_t superloop = {.name = "superloop", .run = superloop_run};
+
 void app_main(void)
 {
     // GPIO Configuration
@@ -33,32 +86,8 @@ void app_main(void)
 
     ESP_LOGI(TAG, "Single Task System Started");
 
-    while (1) {
-        // Task 1: Blink LED1 (simulated sensor reading)
-        ESP_LOGI(TAG, "Reading sensor...");
-        gpio_set_level(LED1_PIN, 1);
-        vTaskDelay(pdMS_TO_TICKS(500)); // Simulate slow sensor
-        gpio_set_level(LED1_PIN, 0);
-        vTaskDelay(pdMS_TO_TICKS(500));
-
-        // Task 2: Process data (heavy computation)
-        ESP_LOGI(TAG, "Processing data...");
-        for (int i = 0; i < 1000000; i++) {
-            // Simulate heavy computation
-            volatile int dummy = i * i;
-        }
-
-        // Task 3: Control LED2 (actuator)
-        ESP_LOGI(TAG, "Controlling actuator...");
-        gpio_set_level(LED2_PIN, 1);
-        vTaskDelay(pdMS_TO_TICKS(300));
-        gpio_set_level(LED2_PIN, 0);
-        vTaskDelay(pdMS_TO_TICKS(300));
-
-        // Task 4: Check button (emergency response)
-        if (gpio_get_level(GPIO_NUM_0) == 0) {
-            ESP_LOGW(TAG, "Button pressed! (Delayed response)");
-            // Response is delayed because other tasks run first
-        }
+    // Button presses come from the harness's simulated GPIO
+    if (!rb_sweep_start(&superloop)) {
+        ESP_LOGE(TAG, "Failed to start the benchmark");
     }
-}
\ No newline at end of file
+}
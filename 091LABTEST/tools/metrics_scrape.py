@@ -0,0 +1,297 @@
+#!/usr/bin/env python3
+"""Scrape, decode and diff metrics from labs that use metrics.h.
+
+A device answers on its console UART (see metrics.h):
+    metrics          Prometheus text between "# BEGIN METRICS" and "# EOF"
+    metrics schema   "MXS <base64>"  names, types, labels, bucket bounds
+    metrics bin      "MXV <base64>"  values only, ~2 bytes per counter
+
+Snapshots are saved as JSON so two of them can be diffed later:
+
+    metrics_scrape.py scrape --port /dev/ttyUSB0 -o before.json
+    metrics_scrape.py scrape --port /dev/ttyUSB0 --text -o after.json
+    metrics_scrape.py scrape --log monitor.log -o snap.json   # captured console log
+    metrics_scrape.py scrape --file metrics.bin -o snap.json  # mx_dump_file() output
+    metrics_scrape.py diff before.json after.json
+    metrics_scrape.py show snap.json
+
+--port needs pyserial. Everything else uses the standard library only.
+"""
+
+import argparse
+import base64
+import json
+import re
+import struct
+import sys
+import time
+
+TYPES = {0: "counter", 1: "gauge", 2: "histogram"}
+SAMPLE_RE = re.compile(r'^([a-zA-Z_:][a-zA-Z0-9_:]*)(\{(.*)\})?\s+(-?[0-9.eE+]+|[+-]Inf|NaN)$')
+LE_RE = re.compile(r',?le="([^"]*)"')
+
+
+# ---------------------------------------------------------------- binary ----
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise ValueError("truncated record")
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def varint(self):
+        v, shift = 0, 0
+        while True:
+            b = self.byte()
+            v |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return v
+            shift += 7
+
+    def svarint(self):
+        z = self.varint()
+        return (z >> 1) ^ -(z & 1)
+
+    def string(self):
+        n = self.varint()
+        s = self.data[self.pos:self.pos + n]
+        if len(s) != n:
+            raise ValueError("truncated string")
+        self.pos += n
+        return s.decode()
+
+
+def record_header(data):
+    if len(data) < 6 or data[0:1] != b"M" or data[1:2] not in (b"S", b"V"):
+        raise ValueError("not a metrics record")
+    return data[1:2].decode(), struct.unpack_from("<I", data, 2)[0]
+
+
+def decode_schema(data):
+    kind, digest = record_header(data)
+    if kind != "S":
+        raise ValueError("expected a schema record")
+    r = Reader(data[6:])
+    metrics = []
+    for _ in range(r.varint()):
+        m = {"type": TYPES[r.byte()], "name": r.string(), "labels": r.string()}
+        if m["type"] == "histogram":
+            m["bounds"] = [r.varint() for _ in range(r.varint())]
+        metrics.append(m)
+    return {"hash": digest, "metrics": metrics}
+
+
+def decode_values(data, schema):
+    kind, digest = record_header(data)
+    if kind != "V":
+        raise ValueError("expected a values record")
+    if digest != schema["hash"]:
+        raise ValueError("schema hash %08x does not match values %08x; fetch the schema again"
+                         % (schema["hash"], digest))
+    r = Reader(data[6:])
+    snap = {"uptime_ms": r.varint(), "taken_at": time.time(), "series": {}}
+    for m in schema["metrics"]:
+        key = series_key(m["name"], m["labels"])
+        if m["type"] == "gauge":
+            snap["series"][key] = {"type": "gauge", "value": r.svarint()}
+        elif m["type"] == "counter":
+            snap["series"][key] = {"type": "counter", "value": r.varint()}
+        else:
+            total = r.varint()
+            cum, buckets = 0, []
+            for le in m["bounds"] + ["+Inf"]:
+                cum += r.varint()
+                buckets.append([str(le), cum])
+            snap["series"][key] = {"type": "histogram", "sum": total, "count": cum, "buckets": buckets}
+    return snap
+
+
+# ------------------------------------------------------------------ text ----
+
+def series_key(name, labels):
+    return "%s{%s}" % (name, labels) if labels else name
+
+
+def parse_text(lines):
+    types, series = {}, {}
+    for line in lines:
+        line = line.strip()
+        if line.startswith("# TYPE "):
+            _, _, name, kind = line.split(None, 3)
+            types[name] = kind
+            continue
+        m = SAMPLE_RE.match(line)
+        if not m:
+            continue    # a log line from another task
+        name, labels, value = m.group(1), m.group(3) or "", float(m.group(4))
+        for suffix in ("_bucket", "_sum", "_count"):
+            base = name[:-len(suffix)]
+            if name.endswith(suffix) and types.get(base) == "histogram":
+                le = LE_RE.search(labels)
+                key = series_key(base, LE_RE.sub("", labels).strip(","))
+                h = series.setdefault(key, {"type": "histogram", "sum": 0, "count": 0, "buckets": []})
+                if suffix == "_bucket":
+                    h["buckets"].append([le.group(1) if le else "+Inf", int(value)])
+                else:
+                    h[suffix[1:]] = int(value)
+                break
+        else:
+            series[series_key(name, labels)] = {"type": types.get(name, "untyped"), "value": int(value)}
+    return {"uptime_ms": None, "taken_at": time.time(), "series": series}
+
+
+# --------------------------------------------------------------- sources ----
+
+def from_log(lines):
+    """Latest text block, or latest MXS + MXV pair, in a captured console log."""
+    schema = values = text = None
+    block = None
+    for line in lines:
+        line = line.rstrip("\r\n")
+        if line == "# BEGIN METRICS":
+            block = []
+        elif line == "# EOF" and block is not None:
+            text, block = block, None
+        elif block is not None:
+            block.append(line)
+        elif line.startswith("MXS "):
+            schema = decode_schema(base64.b64decode(line[4:]))
+        elif line.startswith("MXV "):
+            values = base64.b64decode(line[4:])
+    if values is not None and schema is not None:
+        return decode_values(values, schema)
+    if text is not None:
+        return parse_text(text)
+    raise SystemExit("no metrics found in the log")
+
+
+def from_file(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if not data.startswith(b"#") and len(data) > 2:
+        records = []
+        pos = 0
+        while pos + 2 <= len(data):
+            n = struct.unpack_from("<H", data, pos)[0]
+            records.append(data[pos + 2:pos + 2 + n])
+            pos += 2 + n
+        if len(records) == 2:
+            return decode_values(records[1], decode_schema(records[0]))
+    return parse_text(data.decode(errors="replace").splitlines())
+
+
+def from_port(port, baud, text, timeout):
+    try:
+        import serial
+    except ImportError:
+        raise SystemExit("--port needs pyserial (pip install pyserial)")
+    with serial.Serial(port, baud, timeout=0.2) as ser:
+        def request(cmd, done):
+            ser.reset_input_buffer()
+            ser.write((cmd + "\n").encode())
+            lines, deadline = [], time.time() + timeout
+            while time.time() < deadline:
+                line = ser.readline().decode(errors="replace")
+                if line:
+                    lines.append(line)
+                    if done(line.rstrip("\r\n")):
+                        return lines
+            raise SystemExit("no answer to %r within %.1f s" % (cmd, timeout))
+
+        if text:
+            return from_log(request("metrics", lambda l: l == "# EOF"))
+        lines = request("metrics schema", lambda l: l.startswith("MXS "))
+        lines += request("metrics bin", lambda l: l.startswith("MXV "))
+        return from_log(lines)
+
+
+# ------------------------------------------------------------------ diff ----
+
+def show(snap):
+    for key in sorted(snap["series"]):
+        s = snap["series"][key]
+        if s["type"] == "histogram":
+            avg = s["sum"] / s["count"] if s["count"] else 0
+            print("%-56s count %-8d sum %-10d avg %.1f" % (key, s["count"], s["sum"], avg))
+        else:
+            print("%-56s %d" % (key, s["value"]))
+
+
+def diff(a, b):
+    if a.get("uptime_ms") is not None and b.get("uptime_ms") is not None:
+        dt = (b["uptime_ms"] - a["uptime_ms"]) / 1000.0
+        if dt < 0:
+            print("device restarted between the snapshots; counters start again from zero")
+            dt = b["uptime_ms"] / 1000.0
+    else:
+        dt = b["taken_at"] - a["taken_at"]
+    print("interval %.1f s" % dt)
+    print("%-56s %12s %12s %12s %10s" % ("series", "before", "after", "delta", "per s"))
+    for key in sorted(set(a["series"]) | set(b["series"])):
+        sa, sb = a["series"].get(key), b["series"].get(key)
+        if sa is None or sb is None:
+            print("%-56s %s" % (key, "added" if sa is None else "removed"))
+            continue
+        if sb["type"] == "histogram":
+            dc, ds = sb["count"] - sa["count"], sb["sum"] - sa["sum"] & 0xFFFFFFFF
+            print("%-56s %12d %12d %12d %10.2f  avg %.1f in window" % (
+                key + " count", sa["count"], sb["count"], dc, dc / dt if dt > 0 else 0,
+                ds / dc if dc else 0))
+            continue
+        va, vb = sa["value"], sb["value"]
+        # Counters are 32-bit on the device
+        d = (vb - va) & 0xFFFFFFFF if sb["type"] == "counter" else vb - va
+        if d == 0:
+            continue
+        rate = "%10.2f" % (d / dt) if sb["type"] == "counter" and dt > 0 else ""
+        print("%-56s %12d %12d %+12d %s" % (key, va, vb, d, rate))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    sc = sub.add_parser("scrape", help="take a snapshot")
+    src = sc.add_mutually_exclusive_group(required=True)
+    src.add_argument("--port", help="serial port of the device console")
+    src.add_argument("--log", help="captured console log")
+    src.add_argument("--file", help="file written by mx_dump_file()")
+    sc.add_argument("--baud", type=int, default=115200)
+    sc.add_argument("--text", action="store_true", help="request Prometheus text instead of binary")
+    sc.add_argument("--timeout", type=float, default=5.0)
+    sc.add_argument("-o", "--output", help="JSON snapshot to write (default: print)")
+    sh = sub.add_parser("show", help="print a snapshot")
+    sh.add_argument("snapshot")
+    df = sub.add_parser("diff", help="compare two snapshots")
+    df.add_argument("before")
+    df.add_argument("after")
+    args = ap.parse_args()
+
+    if args.cmd == "scrape":
+        if args.port:
+            snap = from_port(args.port, args.baud, args.text, args.timeout)
+        elif args.log:
+            with open(args.log, errors="replace") as f:
+                snap = from_log(f)
+        else:
+            snap = from_file(args.file)
+        if args.output:
+            with open(args.output, "w") as f:
+                json.dump(snap, f, indent=1)
+        else:
+            show(snap)
+    elif args.cmd == "show":
+        with open(args.snapshot) as f:
+            show(json.load(f))
+    else:
+        with open(args.before) as f, open(args.after) as g:
+            diff(json.load(f), json.load(g))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
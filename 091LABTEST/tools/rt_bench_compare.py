@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Join response-time benchmark logs into one comparison table.
+
+single_task (superloop) and multitask (FreeRTOS tasks) both run the sweep in
+rt_bench.h and print one "RB key=value ..." line per run. Capture each
+console and pass all logs here:
+
+    rt_bench_compare.py single_task.log multitask.log
+    rt_bench_compare.py --csv single_task.log multitask.log > table.csv
+
+Rows are sweep points (chunk size, yield granularity). Every metric has one
+column per model, in the order the logs were given:
+    p50/p90/max  press-to-response latency, us
+    miss         presses never answered or overrun by the next one
+    job/s        processing jobs completed per second
+    ovh%         model core busy time not spent in processing, % of the run
+"""
+
+import argparse
+import csv
+import re
+import sys
+
+RECORD_RE = re.compile(r"\bRB (model=\S+.*)$")
+FIELD_RE = re.compile(r"(\w+)=(\S+)")
+
+METRICS = [
+    ("p50", lambda r: r["p50"]),
+    ("p90", lambda r: r["p90"]),
+    ("max", lambda r: r["max"]),
+    ("miss", lambda r: r["miss"]),
+    ("job/s", lambda r: r["jobs"] * 1000.0 / r["run_ms"] if r["run_ms"] else 0.0),
+    ("ovh%", lambda r: r["ovh"] / 10.0),
+]
+
+
+def parse(paths):
+    models, rows = [], {}
+    for path in paths:
+        with open(path, errors="replace") as f:
+            for line in f:
+                m = RECORD_RE.search(line.rstrip("\r\n"))
+                if not m:
+                    continue    # log line from anything else
+                rec = dict(FIELD_RE.findall(m.group(1)))
+                model = rec.pop("model")
+                rec = {k: int(v) for k, v in rec.items()}
+                if model not in models:
+                    models.append(model)
+                # A later run of the same point replaces the earlier one
+                rows.setdefault((rec["chunk"], rec["yield"]), {})[model] = rec
+    return models, rows
+
+
+def cell(value):
+    if value is None:
+        return "-"
+    return "%.1f" % value if isinstance(value, float) else str(value)
+
+
+def table(models, rows):
+    header = ["chunk", "yield"]
+    for name, _ in METRICS:
+        header += ["%s %s" % (name, model) for model in models]
+    out = [header]
+    for key in sorted(rows):
+        line = [str(key[0]), str(key[1])]
+        for _, fn in METRICS:
+            for model in models:
+                rec = rows[key].get(model)
+                line.append(cell(fn(rec) if rec else None))
+        out.append(line)
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("logs", nargs="+", help="captured console logs")
+    ap.add_argument("--csv", action="store_true", help="write CSV instead of an aligned table")
+    args = ap.parse_args()
+
+    models, rows = parse(args.logs)
+    if not rows:
+        raise SystemExit("no RB records found")
+    out = table(models, rows)
+    if args.csv:
+        csv.writer(sys.stdout).writerows(out)
+        return
+    widths = [max(len(r[i]) for r in out) for i in range(len(out[0]))]
+    for r in out:
+        print("  ".join(v.rjust(w) for v, w in zip(r, widths)))
+
+
+if __name__ == "__main__":
+    sys.exit(main())